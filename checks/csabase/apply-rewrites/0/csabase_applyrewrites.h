@@ -0,0 +1,37 @@
+// csabase_applyrewrites.h                                            -*-C++-*-
+
+#ifndef INCLUDED_CSABASE_APPLYREWRITES
+#define INCLUDED_CSABASE_APPLYREWRITES
+
+// Both translation units here include this header and make the same rewrites
+// of it: the 'mid-return' check inserts a '// RETURN' comment and the
+// 'whitespace' check replaces the tab.  Each must be applied once.
+
+namespace bde_verify
+{
+inline int f(int x)
+{
+    if (x) {
+        return 1;
+    }
+	return 0;
+}
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
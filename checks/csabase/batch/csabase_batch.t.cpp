@@ -0,0 +1,31 @@
+// csabase_batch.t.cpp                                                -*-C++-*-
+
+// This file is checked twice in one batch, with 'FIRST' and then 'SECOND'
+// defined, and each check must see only its own macro.
+
+#if defined(FIRST)
+#warning checked with FIRST
+#elif defined(SECOND)
+#warning checked with SECOND
+#else
+#warning checked with neither
+#endif
+
+int main()
+{
+}
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
@@ -0,0 +1,142 @@
+// utils_event.t.cpp                                                  -*-C++-*-
+
+// With no arguments, test that a subscriber added to a 'utils::event' while
+// it is being raised is called in that same raise, and in every later one.
+// With arguments 'subscribers raises', time adding that many subscribers to
+// an event and raising it that many times, and show the times in the form
+// used by 'TIMER' in 'checks/Makefile.inc', and the time per call of a
+// subscriber.
+
+#include <utils/event.hpp>
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+typedef std::vector<std::pair<int, int> > Seen;
+
+struct seen
+    // Callback object recording the raises seen by one added subscriber.
+{
+    Seen *d_seen;
+    int   d_number;  // Which subscriber this is, counting from 1.
+
+    void operator()(int raise)
+        // Record that this subscriber saw the specified 'raise'.
+    {
+        d_seen->push_back(std::make_pair(raise, d_number));
+    }
+};
+
+struct adder
+    // Callback object adding a 'seen' subscriber on each even raise.
+{
+    utils::event<void(int)> *d_event;
+    Seen                    *d_seen;
+    int                     *d_added;
+
+    void operator()(int raise)
+        // Add a subscriber to the event if the specified 'raise' is even.
+    {
+        if (raise % 2 == 0) {
+            seen s = { d_seen, ++*d_added };
+            *d_event += s;
+        }
+    }
+};
+
+int test()
+    // Raise an event four times, adding a subscriber while it is raised the
+    // first and third times, and return 0 if each added subscriber was
+    // called for the raise that added it and for every later one, and 1
+    // otherwise.
+{
+    utils::event<void(int)> event;
+    Seen                    seen;
+    int                     added = 0;
+    adder                   a = { &event, &seen, &added };
+    event += a;
+    for (int raise = 0; raise < 4; ++raise) {
+        event(raise);
+    }
+
+    const std::pair<int, int> expected[] = {
+        { 0, 1 }, { 1, 1 }, { 2, 1 }, { 2, 2 }, { 3, 1 }, { 3, 2 }
+    };
+    const size_t n = sizeof expected / sizeof *expected;
+    if (seen.size() != n || !std::equal(seen.begin(), seen.end(), expected)) {
+        printf("subscribers added while raising were not called in order:");
+        for (const auto& s : seen) {
+            printf(" %d:%d", s.first, s.second);
+        }
+        printf("\n");
+        return 1;                                                     // RETURN
+    }
+    return 0;
+}
+
+double seconds(std::chrono::steady_clock::time_point start)
+    // Return the seconds elapsed since the specified 'start'.
+{
+    return std::chrono::duration<double>(
+               std::chrono::steady_clock::now() - start).count();
+}
+
+int bench(int subscribers, int raises)
+    // Time adding the specified number of 'subscribers' to an event, and
+    // raising it the specified number of 'raises' times, and return 0.
+{
+    utils::event<void(int)> event;
+    long                    sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < subscribers; ++i) {
+        event += [&sum, i](int raise) { sum += raise ^ i; };
+    }
+    printf("%-24s %7.2fs\n", "subscribe", seconds(start));
+
+    start = std::chrono::steady_clock::now();
+    for (int raise = 0; raise < raises; ++raise) {
+        event(raise);
+    }
+    double elapsed = seconds(start);
+    printf("%-24s %7.2fs\n", "raise", elapsed);
+    if (subscribers > 0 && raises > 0) {
+        printf("%-24s %7.2fns\n",
+               "per subscriber call",
+               elapsed * 1e9 / subscribers / raises);
+    }
+
+    // Use the result, so that the calls are not optimized away.
+    volatile long result = sum;
+    (void) result;
+    return 0;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    return argc > 2 ? bench(atoi(argv[1]), atoi(argv[2])) : test();
+}
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
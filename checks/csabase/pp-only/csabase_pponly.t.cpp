@@ -0,0 +1,33 @@
+// csabase_pponly.t.cpp                                               -*-C++-*-
+
+// Pragmas that the parser handles must not be reported as unknown when only
+// the preprocessor runs.
+
+#pragma pack(push, 1)
+struct Packed { char c; int i; };
+#pragma pack(pop)
+
+#pragma GCC visibility push(default)
+int visible();
+#pragma GCC visibility pop
+
+#pragma weak weak_function
+extern "C" void weak_function();
+
+// This comment is long enough for the long lines check to report, in both modes.
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
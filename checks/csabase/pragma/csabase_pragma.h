@@ -0,0 +1,28 @@
+// csabase_pragma.h                                                   -*-C++-*-
+#ifndef INCLUDED_CSABASE_PRAGMA
+#define INCLUDED_CSABASE_PRAGMA
+
+// This is a component header, so its pragmas are handled.
+
+#pragma bde_verify push
+#pragma bde_verify -LL01
+// Suppressed in the component header...........................................
+#pragma bde_verify pop
+// Reported in the component header.............................................
+
+#endif
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
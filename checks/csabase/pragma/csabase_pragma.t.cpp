@@ -0,0 +1,50 @@
+// csabase_pragma.t.cpp                                               -*-C++-*-
+
+#include "csabase_pragma.h"
+#include "csabase_pragmaextra.h"
+
+// Each 'bde_verify' pragma below suppresses 'LL01' for the long line after
+// it, until the matching 'pop'.  The lines outside the pushes are reported.
+
+#pragma bde_verify push
+#pragma bde_verify -LL01
+// Suppressed in the main file..................................................
+#pragma bde_verify pop
+// Reported in the main file....................................................
+
+// The prefilter looks for 'verify' in the rest of the pragma line, and must
+// let through the other spellings and spacings that the pragma allows.
+
+#pragma bde_verify push
+#  pragma   bdeverify   -LL01
+// Suppressed by the respelled pragma...........................................
+#pragma bde_verify pop
+
+#pragma bde_verify push
+#pragma bbe_verify -LL01
+// Suppressed by the oldest spelling............................................
+#pragma bde_verify pop
+
+// BDE_VERIFY pragma: push
+// BDE_VERIFY pragma: -LL01
+// Suppressed by the comment form...............................................
+// BDE_VERIFY pragma: pop
+
+int main()
+{
+}
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
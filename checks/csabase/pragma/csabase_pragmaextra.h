@@ -0,0 +1,27 @@
+// csabase_pragmaextra.h                                              -*-C++-*-
+#ifndef INCLUDED_CSABASE_PRAGMAEXTRA
+#define INCLUDED_CSABASE_PRAGMAEXTRA
+
+// This header is not part of the component, so nothing in it is reported
+// and its pragmas are ignored; were this one handled, it would be reported
+// as a 'push' that is never popped.
+
+#pragma bde_verify push
+// Not reported outside the component...........................................
+
+#endif
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
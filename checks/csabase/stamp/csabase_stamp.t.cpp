@@ -0,0 +1,33 @@
+// csabase_stamp.t.cpp                                                -*-C++-*-
+
+// This is checked three times with one stamp file: to record it, with its
+// text changed but not its size or time (so the recorded output is
+// replayed), and with a header created where it shadows the one found
+// before.
+
+#include <csabase_stampshadow.h>
+
+#if defined(FOUND_IN_SHADOW)
+#warning found the shadowing header
+#elif defined(FOUND_IN_ORIGINAL)
+#warning found the original header
+#endif
+
+int main()
+{
+}
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
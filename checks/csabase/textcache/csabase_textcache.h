@@ -0,0 +1,26 @@
+// csabase_textcache.h                                                -*-C++-*-
+
+// This header has no include guard, so that it is examined twice in one
+// translation unit.  Its second examination, and both in a later run with
+// the same text cache, replay the results recorded for the first.
+
+int f(int x) 
+{
+    return x;
+}
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
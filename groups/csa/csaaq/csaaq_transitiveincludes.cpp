@@ -8,6 +8,7 @@
 #include <csabase_analyser.h>
 #include <csabase_debug.h>
 #include <csabase_filenames.h>
+#include <csabase_headerindex.h>
 #include <csabase_ppobserver.h>
 #include <csabase_registercheck.h>
 #include <csabase_report.h>
@@ -71,281 +72,6 @@ static std::string const check_name("transitive-includes");
 namespace
 {
 
-std::set<llvm::StringRef> &top_level_files()
-{
-    static std::set<llvm::StringRef> s;
-    if (!s.size()) {
-#undef  X
-#define X(n)                                                                  \
-    s.insert(#n);                                                             \
-    s.insert("bsl_" #n ".h");                                                 \
-    s.insert("stl_" #n ".h");
-    X(algorithm)     X(array)         X(atomic)           X(bitset)
-    X(chrono)        X(codecvt)       X(complex)          X(condition_variable)
-    X(deque)         X(exception)     X(forward_list)     X(fstream)
-    X(functional)    X(future)        X(initializer_list) X(iomanip)
-    X(ios)           X(iosfwd)        X(iostream)         X(istream)
-    X(iterator)      X(limits)        X(list)             X(locale)
-    X(map)           X(memory)        X(mutex)            X(new)
-    X(numeric)       X(ostream)       X(queue)            X(random)
-    X(ratio)         X(regex)         X(scoped_allocator) X(set)
-    X(sstream)       X(stack)         X(stdexcept)        X(streambuf)
-    X(string)        X(strstream)     X(system_error)     X(thread)
-    X(tuple)         X(type_traits)   X(typeindex)        X(typeinfo)
-    X(unordered_map) X(unordered_set) X(utility)          X(valarray)
-    X(vector)
-#undef  X
-
-#undef  X
-#define X(n)                                                                  \
-    s.insert("c" #n);                                                         \
-    s.insert(#n ".h");                                                        \
-    s.insert("bsl_c" #n ".h");                                                \
-    s.insert("bsl_c_" #n ".h");
-    X(assert)   X(complex) X(ctype)    X(errno)  X(fenv)    X(float)
-    X(inttypes) X(iso646)  X(iso646)   X(limits) X(locale)  X(math)
-    X(setjmp)   X(signal)  X(stdalign) X(stdarg) X(stdbool) X(stddef)
-    X(stdint)   X(stdio)   X(stdlib)   X(string) X(tgmath)  X(time)
-    X(uchar)    X(wchar)   X(wctype)
-#undef  X
-
-    s.insert("vstring.h");
-    s.insert("unistd.h");
-    }
-
-    return s;
-}
-
-std::vector<llvm::StringRef> &top_level_prefixes()
-{
-    static std::vector<llvm::StringRef> s;
-    if (!s.size()) {
-#undef  X
-#define X(n) s.emplace_back(n);
-    X("bdlat_")  X("bdlb_")   X("bdlc_")  X("bdlde_") X("bdldfp_")
-    X("bdlf_")   X("bdlma_")  X("bdlmt_") X("bdlqq_") X("bdls_")
-    X("bdlsb_")  X("bdlscm_") X("bdlsu_") X("bdlt_")  X("bslalg_")
-    X("bslfwd_") X("bslh_")   X("bslim_") X("bslma_") X("bslmf_")
-    X("bsls_")   X("bslscm_") X("bsltf_") X("bslx_")
-#undef X
-    };
-
-    return s;
-}
-
-bool is_top_level(llvm::StringRef name)
-{
-    if (top_level_files().count(name)) {
-        return true;
-    }
-    for (auto s : top_level_prefixes()) {
-        if (name.startswith(s)) {
-            return true;
-        }
-    }
-    return false;
-}
-
-std::map<llvm::StringRef, llvm::StringRef> &mapped_files()
-{
-    static std::map<llvm::StringRef, llvm::StringRef> s;
-    if (!s.size()) {
-#undef  X
-#define X(a, b) s[a] = b;
-    X("/bits/algorithmfwd.h",                 "algorithm"          )
-    X("/bits/alloc_traits.h",                 "memory"             )
-    X("/bits/allocator.h",                    "memory"             )
-    X("/bits/atomic_base.h",                  "atomic"             )
-    X("/bits/atomic_lockfree_defines.h",      "atomic"             )
-    X("/bits/auto_ptr.h",                     "memory"             )
-    X("/bits/backward_warning.h",             "iosfwd"             )
-    X("/bits/basic_file.h",                   "ios"                )
-    X("/bits/basic_ios.h",                    "ios"                )
-    X("/bits/basic_ios.tcc",                  "ios"                )
-    X("/bits/basic_string.h",                 "string"             )
-    X("/bits/basic_string.tcc",               "string"             )
-    X("/bits/bessel_function.tcc",            "cmath"              )
-    X("/bits/beta_function.tcc",              "cmath"              )
-    X("/bits/binders.h",                      "functional"         )
-    X("/bits/boost_concept_check.h",          "iterator"           )
-    X("/bits/c++0x_warning.h",                "iosfwd"             )
-    X("/bits/c++allocator.h",                 "memory"             )
-    X("/bits/c++config.h",                    "iosfwd"             )
-    X("/bits/c++io.h",                        "ios"                )
-    X("/bits/c++locale.h",                    "locale"             )
-    X("/bits/cast.h",                         "pointer.h"          )
-    X("/bits/char_traits.h",                  "string"             )
-    X("/bits/codecvt.h",                      "locale"             )
-    X("/bits/concept_check.h",                "iterator"           )
-    X("/bits/cpp_type_traits.h",              "type_traits"        )
-    X("/bits/cpu_defines.h",                  "iosfwd"             )
-    X("/bits/ctype_base.h",                   "locale"             )
-    X("/bits/ctype_inline.h",                 "locale"             )
-    X("/bits/cxxabi_forced.h",                "cxxabi.h"           )
-    X("/bits/cxxabi_tweaks.h",                "cxxabi.h"           )
-    X("/bits/decimal.h",                      "decimal"            )
-    X("/bits/deque.tcc",                      "deque"              )
-    X("/bits/ell_integral.tcc",               "cmath"              )
-    X("/bits/error_constants.h",              "system_error"       )
-    X("/bits/exception_defines.h",            "exception"          )
-    X("/bits/exception_ptr.h",                "exception"          )
-    X("/bits/exp_integral.tcc",               "cmath"              )
-    X("/bits/forward_list.h",                 "forward_list"       )
-    X("/bits/forward_list.tcc",               "forward_list"       )
-    X("/bits/fstream.tcc",                    "fstream"            )
-    X("/bits/functexcept.h",                  "exception"          )
-    X("/bits/functional_hash.h",              "functional"         )
-    X("/bits/gamma.tcc",                      "cmath"              )
-    X("/bits/gslice.h",                       "valarray"           )
-    X("/bits/gslice_array.h",                 "valarray"           )
-    X("/bits/hash_bytes.h",                   "functional"         )
-    X("/bits/hashtable.h",                    "unordered_map"      )
-    X("/bits/hashtable_policy.h",             "unordered_map"      )
-    X("/bits/hypergeometric.tcc",             "cmath"              )
-    X("/bits/indirect_array.h",               "valarray"           )
-    X("/bits/ios_base.h",                     "ios"                )
-    X("/bits/istream.tcc",                    "istream"            )
-    X("/bits/legendre_function.tcc",          "cmath"              )
-    X("/bits/list.tcc",                       "list"               )
-    X("/bits/locale_classes.h",               "locale"             )
-    X("/bits/locale_classes.tcc",             "locale"             )
-    X("/bits/locale_facets.h",                "locale"             )
-    X("/bits/locale_facets.tcc",              "locale"             )
-    X("/bits/locale_facets_nonio.h",          "locale"             )
-    X("/bits/locale_facets_nonio.tcc",        "locale"             )
-    X("/bits/localefwd.h",                    "locale"             )
-    X("/bits/mask_array.h",                   "valarray"           )
-    X("/bits/memoryfwd.h",                    "memory"             )
-    X("/bits/messages_members.h",             "locale"             )
-    X("/bits/modified_bessel_func.tcc",       "cmath"              )
-    X("/bits/move.h",                         "utility"            )
-    X("/bits/nested_exception.h",             "exception"          )
-    X("/bits/opt_random.h",                   "random"             )
-    X("/bits/os_defines.h",                   "iosfwd"             )
-    X("/bits/ostream.tcc",                    "ostream"            )
-    X("/bits/ostream_insert.h",               "ostream"            )
-    X("/bits/poly_hermite.tcc",               "cmath"              )
-    X("/bits/poly_laguerre.tcc",              "cmath"              )
-    X("/bits/postypes.h",                     "iosfwd"             )
-    X("/bits/ptr_traits.h",                   "memory"             )
-    X("/bits/random.h",                       "random"             )
-    X("/bits/random.tcc",                     "random"             )
-    X("/bits/range_access.h",                 "iterator"           )
-    X("/bits/rc_string_base.h",               "vstring.h"          )
-    X("/bits/regex.h",                        "regex"              )
-    X("/bits/regex_compiler.h",               "regex"              )
-    X("/bits/regex_constants.h",              "regex"              )
-    X("/bits/regex_cursor.h",                 "regex"              )
-    X("/bits/regex_error.h",                  "regex"              )
-    X("/bits/regex_grep_matcher.h",           "regex"              )
-    X("/bits/regex_grep_matcher.tcc",         "regex"              )
-    X("/bits/regex_nfa.h",                    "regex"              )
-    X("/bits/regex_nfa.tcc",                  "regex"              )
-    X("/bits/riemann_zeta.tcc",               "cmath"              )
-    X("/bits/ropeimpl.h",                     "rope"               )
-    X("/bits/shared_ptr.h",                   "memory"             )
-    X("/bits/shared_ptr_base.h",              "memory"             )
-    X("/bits/slice_array.h",                  "valarray"           )
-    X("/bits/special_function_util.h",        "cmath"              )
-    X("/bits/sso_string_base.h",              "vstring.h"          )
-    X("/bits/sstream.tcc",                    "sstream"            )
-    X("/bits/stl_algo.h",                     "algorithm"          )
-    X("/bits/stl_algobase.h",                 "algorithm"          )
-    X("/bits/stl_bvector.h",                  "vector"             )
-    X("/bits/stl_construct.h",                "memory"             )
-    X("/bits/stl_deque.h",                    "deque"              )
-    X("/bits/stl_function.h",                 "functional"         )
-    X("/bits/stl_heap.h",                     "queue"              )
-    X("/bits/stl_iterator.h",                 "iterator"           )
-    X("/bits/stl_iterator_base_funcs.h",      "iterator"           )
-    X("/bits/stl_iterator_base_types.h",      "iterator"           )
-    X("/bits/stl_list.h",                     "list"               )
-    X("/bits/stl_map.h",                      "map"                )
-    X("/bits/stl_multimap.h",                 "map"                )
-    X("/bits/stl_multiset.h",                 "set"                )
-    X("/bits/stl_numeric.h",                  "numeric"            )
-    X("/bits/stl_pair.h",                     "utility"            )
-    X("/bits/stl_queue.h",                    "queue"              )
-    X("/bits/stl_raw_storage_iter.h",         "memory"             )
-    X("/bits/stl_relops.h",                   "utility"            )
-    X("/bits/stl_set.h",                      "set"                )
-    X("/bits/stl_stack.h",                    "stack"              )
-    X("/bits/stl_tempbuf.h",                  "memory"             )
-    X("/bits/stl_tree.h",                     "map"                )
-    X("/bits/stl_uninitialized.h",            "memory"             )
-    X("/bits/stl_vector.h",                   "vector"             )
-    X("/bits/stream_iterator.h",              "iterator"           )
-    X("/bits/streambuf.tcc",                  "streambuf"          )
-    X("/bits/streambuf_iterator.h",           "iterator"           )
-    X("/bits/stringfwd.h",                    "string"             )
-    X("/bits/strstream",                      "sstream"            )
-    X("/bits/time_members.h",                 "locale"             )
-    X("/bits/unique_ptr.h",                   "memory"             )
-    X("/bits/unordered_map.h",                "unordered_map"      )
-    X("/bits/unordered_set.h",                "unordered_set"      )
-    X("/bits/valarray_after.h",               "valarray"           )
-    X("/bits/valarray_array.h",               "valarray"           )
-    X("/bits/valarray_array.tcc",             "valarray"           )
-    X("/bits/valarray_before.h",              "valarray"           )
-    X("/bits/vector.tcc",                     "vector"             )
-    X("/bits/vstring.tcc",                    "vstring.h"          )
-    X("/bits/vstring_fwd.h",                  "vstring.h"          )
-    X("/bits/vstring_util.h",                 "vstring.h"          )
-
-    X("/bslstl_algorithmworkaround.h",        "bsl_algorithm.h"    )
-    X("/bslstl_allocator.h",                  "bsl_memory.h"       )
-    X("/bslstl_allocatortraits.h",            "bsl_memory.h"       )
-    X("/bslstl_badweakptr.h",                 "bsl_memory.h"       )
-    X("/bslstl_bidirectionaliterator.h",      "bsl_iterator.h"     )
-    X("/bslstl_bitset.h",                     "bsl_bitset.h"       )
-    X("/bslstl_deque.h",                      "bsl_deque.h"        )
-    X("/bslstl_equalto.h",                    "bsl_functional.h"   )
-    X("/bslstl_forwarditerator.h",            "bsl_iterator.h"     )
-    X("/bslstl_hash.h",                       "bsl_functional.h"   )
-    X("/bslstl_istringstream.h",              "bsl_sstream.h"      )
-    X("/bslstl_iterator.h",                   "bsl_iterator.h"     )
-    X("/bslstl_list.h",                       "bsl_list.h"         )
-    X("/bslstl_map.h",                        "bsl_map.h"          )
-    X("/bslstl_multimap.h",                   "bsl_map.h"          )
-    X("/bslstl_multiset.h",                   "bsl_set.h"          )
-    X("/bslstl_ostringstream.h",              "bsl_sstream.h"      )
-    X("/bslstl_pair.h",                       "bsl_utility.h"      )
-    X("/bslstl_randomaccessiterator.h",       "bsl_iterator.h"     )
-    X("/bslstl_set.h",                        "bsl_set.h"          )
-    X("/bslstl_sharedptr.h",                  "bsl_memory.h"       )
-    X("/bslstl_sstream.h",                    "bsl_sstream.h"      )
-    X("/bslstl_stack.h",                      "bsl_stack.h"        )
-    X("/bslstl_stdexceptutil.h",              "bsl_stdexcept.h"    )
-    X("/bslstl_string.h",                     "bsl_string.h"       )
-    X("/bslstl_stringbuf.h",                  "bsl_sstream.h"      )
-    X("/bslstl_stringstream.h",               "bsl_sstream.h"      )
-    X("/bslstl_unorderedmap.h",               "bsl_unordered_map.h")
-    X("/bslstl_unorderedmultimap.h",          "bsl_unordered_map.h")
-    X("/bslstl_unorderedmultiset.h",          "bsl_unordered_set.h")
-    X("/bslstl_unorderedset.h",               "bsl_unordered_set.h")
-    X("/bslstl_vector.h",                     "bsl_vector.h"       )
-    X("/bslstl_allocator.h",                  "bsl_memory.h"       )
-    }
-
-    return s;
-}
-
-std::string get_mapped(llvm::StringRef s)
-{
-    for (size_t rs = s.rfind('/'); rs != s.npos; rs = s.rfind('/', rs)) {
-        auto i = mapped_files().find(s.substr(rs));
-        if (i != mapped_files().end()) {
-            return i->second;
-        }
-    }
-    return "";
-}
-
-bool is_mapped(llvm::StringRef s)
-{
-    return !get_mapped(s).empty();
-}
-
 llvm::Regex (&skipped_files())[2]
 {
 
@@ -367,40 +93,6 @@ bool is_skipped(llvm::StringRef name)
     return false;
 }
 
-std::set<llvm::StringRef> &reexporting_files()
-{
-
-static auto &s = *new std::set<llvm::StringRef>({
-    "bael_log.h",
-});
-
-    return s;
-}
-
-std::map<llvm::StringRef, std::set<llvm::StringRef>> &if_included_map()
-{
-    static std::map<llvm::StringRef, std::set<llvm::StringRef>> s;
-    if (!s.size()) {
-        s["bsl_ios.h"].insert("bsl_iostream.h");
-        s["bsl_ios.h"].insert("bsl_streambuf.h");
-        s["bsl_ios.h"].insert("bsl_strstream.h");
-        s["bsl_iosfwd.h"].insert("bsl_ios.h");
-        s["bsl_istream.h"].insert("bsl_iostream.h");
-        s["bsl_ostream.h"].insert("bsl_iostream.h");
-        s["bsl_streambuf.h"].insert("bsl_iostream.h");
-        s["ios.h"].insert("bsl_iostream.h");
-        s["ios.h"].insert("bsl_streambuf.h");
-        s["ios.h"].insert("bsl_strstream.h");
-        s["iosfwd"].insert("bsl_ios.h");
-        s["istream"].insert("bsl_iostream.h");
-        s["math.h"].insert("bsl_cmath.h");
-        s["ostream"].insert("bsl_iostream.h");
-        s["streambuf"].insert("bsl_iostream.h");
-    }
-
-    return s;
-}
-
 bool reexports(llvm::StringRef outer, llvm::StringRef inner)
 {
     llvm::SmallVector<char, 1000> buf;
@@ -446,7 +138,7 @@ bool reexports(llvm::StringRef outer, llvm::StringRef inner)
         return true;
     }
 
-    if (reexporting_files().count(outer)) {
+    if (HeaderIndex::is_reexporting(outer)) {
         return true;
     }
 
@@ -608,9 +300,6 @@ struct report : public RecursiveASTVisitor<report>, Report<data>
         // specified declaration 'ds', determine which header file, if any, is
         // needed.
 
-    void operator()();
-        // Callback for end of main file.
-
     bool is_guard(llvm::StringRef guard);
     bool is_guard(const Token& token);
         // Return true if the specified 'guard' or 'token' looks like a header
@@ -630,9 +319,6 @@ struct report : public RecursiveASTVisitor<report>, Report<data>
     std::string name_for(const NamedDecl *decl);
         // Return a diagnostic name for the specified 'decl'.
 
-    bool shouldVisitTemplateInstantiations () const;
-        // Return true;
-
     bool VisitCXXConstructExpr(CXXConstructExpr *expr);
     bool VisitDeclRefExpr(DeclRefExpr *expr);
     bool VisitNamedDecl(NamedDecl *decl);
@@ -655,7 +341,8 @@ std::vector<std::pair<FileID, bool>>& report::include_stack(SourceLocation sl)
     if (!v.size()) {
         while (sl.isValid()) {
             FileName fn(m.getFilename(sl));
-            v.emplace_back(m.getFileID(sl), is_top_level(fn.name()));
+            v.emplace_back(m.getFileID(sl),
+                           HeaderIndex::is_top_level(fn.name()));
             sl = m.getIncludeLoc(v.back().first);
         }
     }
@@ -665,12 +352,9 @@ std::vector<std::pair<FileID, bool>>& report::include_stack(SourceLocation sl)
 std::string report::map_if_included(FileID fid, std::string name)
 {
     name = llvm::sys::path::filename(name);
-    auto i = if_included_map().find(name);
-    if (i != if_included_map().end()) {
-        for (const auto& m : i->second) {
-            if (d_data.d_all_includes.count(m)) {
-                return map_if_included(fid, m);
-            }
+    for (const auto& m : HeaderIndex::if_included(name)) {
+        if (d_data.d_all_includes.count(m.d_to)) {
+            return map_if_included(fid, m.d_to);
         }
     }
     std::string n = "bsl_" + name + ".h";
@@ -711,11 +395,11 @@ std::string report::file_for_location(SourceLocation sl, SourceLocation in)
                 result = t;
                 break;
             }
-            if (is_skipped(f) && !is_mapped(f)) {
+            if (is_skipped(f) && HeaderIndex::mapped(f).empty()) {
                 continue;
             }
             if (!found) {
-                if (p.second || is_mapped(f)) {
+                if (p.second || !HeaderIndex::mapped(f).empty()) {
                     found = true;
                     just_found = true;
                     top = p.first;
@@ -731,8 +415,9 @@ std::string report::file_for_location(SourceLocation sl, SourceLocation in)
     }
 
     if (!d_analyser.is_component(result)) {
-        if (is_mapped(result)) {
-            result = get_mapped(result);
+        llvm::StringRef mapped = HeaderIndex::mapped(result);
+        if (!mapped.empty()) {
+            result = mapped.str();
         }
         result = map_if_included(fid, result);
         if (is_skipped(result)) {
@@ -1023,17 +708,12 @@ void report::require_file(std::string     name,
     name = fn.name();
 
     if (name == ff.name() ||
-        is_top_level(ff.name()) ||
+        HeaderIndex::is_top_level(ff.name()) ||
+        HeaderIndex::is_mapped_either_way(ff.name()) ||
         is_skipped(ff.name())) {
         return;
     }
 
-    for (const auto& p : mapped_files()) {
-        if (p.first == ff.name() || p.second == ff.name()) {
-            return;
-        }
-    }
-
     for (const auto& s : d_data.d_includes[fid]) {
         if (files_match(llvm::sys::path::filename(s), name)) {
             return;
@@ -1142,11 +822,6 @@ std::string report::name_for(const NamedDecl *decl)
     return s.str();
 }
 
-bool report::shouldVisitTemplateInstantiations() const
-{
-    return !true;
-}
-
 bool report::VisitNamespaceAliasDecl(NamespaceAliasDecl *decl)
 {
     SourceLocation sl = decl->getLocation();
@@ -1354,15 +1029,12 @@ bool report::VisitTypedefTypeLoc(TypedefTypeLoc tl)
     return base::VisitTypedefTypeLoc(tl);
 }
 
-// TranslationUnitDone
-void report::operator()()
-{
-    TraverseDecl(d_analyser.context()->getTranslationUnitDecl());
-}
-
 void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
     // Hook up the callback functions.
 {
+    // Includes are needed for what is used in headers too.
+    analyser.keep_function_bodies();
+    analyser.index_parents(CheckRegistry::e_TranslationUnit);
     observer.onPPInclusionDirective += report(analyser,
                                                 observer.e_InclusionDirective);
     observer.onPPFileChanged        += report(analyser,
@@ -1382,7 +1054,7 @@ void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
     observer.onPPElif               += report(analyser, observer.e_Elif);
     observer.onPPElse               += report(analyser, observer.e_Else);
     observer.onPPEndif              += report(analyser, observer.e_Endif);
-    analyser.onTranslationUnitDone  += report(analyser);
+    analyser.add_pass(check_name, report(analyser));
 }
 
 }  // close anonymous namespace
@@ -39,7 +39,9 @@ void csabase::AbstractVisitor::visit_decl(Decl const* decl)
 
 void csabase::AbstractVisitor::visit(Decl const* decl)
 {
-    visit_decl(decl);
+    if (!prune(decl)) {
+        visit_decl(decl);
+    }
 }
 
 void csabase::AbstractVisitor::visit_stmt(Stmt const* stmt)
@@ -63,10 +65,17 @@ void csabase::AbstractVisitor::visit_context(void const*)
 void csabase::AbstractVisitor::visit_context(DeclContext const* context)
 {
     Debug d1("process DeclContext");
-    std::for_each(
-        context->decls_begin(),
-        context->decls_end(),
-        std::bind1st(std::mem_fun(&AbstractVisitor::visit_decl), this));
+    for (DeclContext::decl_iterator it = context->decls_begin(),
+                                    end = context->decls_end();
+         it != end;
+         ++it) {
+        visit(*it);
+    }
+}
+
+bool csabase::AbstractVisitor::prune(Decl const*)
+{
+    return false;
 }
 
 // -----------------------------------------------------------------------------
@@ -43,6 +43,10 @@ STMT(Stmt,void)
     void visit_stmt(clang::Stmt const*);
     void visit_context(void const*);
     void visit_context(clang::DeclContext const*);
+    virtual bool prune(clang::Decl const*);
+        // Return 'true' if the specified declaration, and everything within
+        // it, should not be visited when it is reached from the top level or
+        // from its enclosing context.  By default, nothing is pruned.
     void visit_children(clang::Stmt::child_range const&);
     template <typename Children> void visit_children(Children const&);
 };
@@ -9,11 +9,15 @@
 #include <clang/Basic/FileManager.h>
 #include <clang/Basic/SourceManager.h>
 #include <clang/Frontend/CompilerInstance.h>
+#include <clang/Lex/Preprocessor.h>
+#include <clang/Lex/Token.h>
 #include <clang/Rewrite/Core/Rewriter.h>
 #include <csabase_analyser.h>
 #include <csabase_debug.h>
 #include <csabase_diagnosticfilter.h>
 #include <csabase_filenames.h>
+#include <csabase_rewritefile.h>
+#include <csabase_stampfile.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Path.h>
@@ -24,7 +28,6 @@
 #endif
 #include <stdlib.h>
 #include <stddef.h>
-#include <fstream>
 #include <map>
 #include <string>
 #include <utility>
@@ -53,6 +56,7 @@ class AnalyseConsumer : public ASTConsumer
     bool HandleTopLevelDecl(DeclGroupRef DG);
     void ReadReplacements(std::string file);
     void HandleTranslationUnit(ASTContext&);
+    bool shouldSkipFunctionBody(Decl *decl);
 
   private:
     Analyser analyser_;
@@ -70,6 +74,20 @@ AnalyseConsumer::AnalyseConsumer(CompilerInstance&   compiler,
 {
     analyser_.toplevel(source);
 
+    // Batch mode stamps must be invalidated by changes to these files too.
+    for (const auto& file : analyser_.config()->loaded_files()) {
+        StampFile::note_dependency(file);
+    }
+    if (!plugin.diff_file().empty() && plugin.diff_file() != "-") {
+        StampFile::note_dependency(plugin.diff_file());
+    }
+
+    // Have the parser ask 'shouldSkipFunctionBody' whether to parse each
+    // function body.
+    if (analyser_.skips_function_bodies()) {
+        compiler.getFrontendOpts().SkipFunctionBodies = true;
+    }
+
     compiler.getDiagnostics().setClient(new DiagnosticFilter(
         analyser_, plugin.diagnose(), compiler.getDiagnosticOpts()));
     compiler.getDiagnostics().getClient()->BeginSourceFile(
@@ -96,29 +114,35 @@ AnalyseConsumer::HandleTopLevelDecl(DeclGroupRef DG)
 
 // -----------------------------------------------------------------------------
 
+bool
+AnalyseConsumer::shouldSkipFunctionBody(Decl *decl)
+{
+    return analyser_.skip_function_body(decl);
+}
+
+// -----------------------------------------------------------------------------
+
 void
 AnalyseConsumer::ReadReplacements(std::string file)
 {
     if (!file.empty()) {
-        std::ifstream f(file);
-        if (!f) {
-            llvm::errs() << analyser_.toplevel()
-                         << ":1:1: error: cannot open " << file
-                         << " for reading\n";
+        std::vector<std::vector<Replacement>> records;
+        unsigned damaged;
+        if (!RewriteFile::read(file, &records, &damaged)) {
+            DiagnosticFilter::output()
+                << analyser_.toplevel()
+                << ":1:1: error: cannot open " << file
+                << " for reading\n";
         }
         else {
-            int length;
-            std::string mod_file;
-            int rep_offset;
-            int rep_length;
-            std::string data;
-            while (f >> length) {
-                mod_file.resize(length);
-                f.ignore(1).read(&mod_file[0], mod_file.size()).ignore(1);
-                f >> rep_offset >> rep_length >> length;
-                data.resize(length);
-                f.ignore(1).read(&data[0], data.size()).ignore(1);
-                analyser_.ReplaceText(mod_file, rep_offset, rep_length, data);
+            if (damaged) {
+                DiagnosticFilter::output()
+                    << analyser_.toplevel()
+                    << ":1:1: warning: skipped " << damaged
+                    << " damaged record(s) in " << file << "\n";
+            }
+            for (const auto &record : records) {
+                analyser_.combine_replacements(record);
             }
         }
     }
@@ -154,39 +178,19 @@ void
 AnalyseConsumer::HandleTranslationUnit(ASTContext&)
 {
     analyser_.process_translation_unit_done();
+    Debug::dump_ring(DiagnosticFilter::output());
 
     std::string rf = analyser_.rewrite_file();
     if (!rf.empty()) {
-        int fd;
-        std::error_code file_error = llvm::sys::fs::openFileForWrite(
-            rf, fd, llvm::sys::fs::F_Append);
+        // The whole record goes out in one write, so that processes sharing
+        // the file do not interleave their actions.
+        std::error_code file_error = RewriteFile::append(
+            rf, RewriteFile::encode(analyser_.replacements()));
         if (file_error) {
-            llvm::errs() << analyser_.toplevel()
-                         << ":1:1: error: " << file_error.message()
-                         << ": cannot open " << rf
-                         << " for writing\n";
-        }
-        else {
-            llvm::raw_fd_ostream rfdo(fd, true);
-            rfdo.SetUnbuffered();
-            for (const auto &r : analyser_.replacements()) {
-                std::string buf;
-                llvm::raw_string_ostream os(buf);
-                llvm::StringRef c = FileName(r.getFilePath()).full();
-                os << c.size() << " "
-                   << c << " "
-                   << r.getOffset() << " "
-                   << r.getLength() << " "
-                   << r.getReplacementText().size() << " "
-                   << r.getReplacementText() << "\n";
-                rfdo << os.str();
-            }
-            rfdo.close();
-            if (rfdo.has_error()) {
-                rfdo.clear_error();
-                llvm::errs() << analyser_.toplevel() << ":1:1: error: "
-                             << "IO error closing " << rf << "\n";
-            }
+            DiagnosticFilter::output()
+                << analyser_.toplevel()
+                << ":1:1: error: " << file_error.message()
+                << ": cannot write " << rf << "\n";
         }
     }
 
@@ -194,6 +198,7 @@ AnalyseConsumer::HandleTranslationUnit(ASTContext&)
     if (!rd.empty()) {
         if (!rf.empty()) {
             ReadReplacements(rf);
+            analyser_.merge_replacements();
         }
         Rewriter& rw = analyser_.rewriter();
         SourceManager& m = analyser_.manager();
@@ -221,7 +226,7 @@ AnalyseConsumer::HandleTranslationUnit(ASTContext&)
                 }
             }
             else if (analyser_.diagnose() == "nogen") {
-                if (analyser_.is_generated(loc)) {
+                if (analyser_.is_generated(b->first)) {
                     continue;
                 }
             }
@@ -237,11 +242,12 @@ AnalyseConsumer::HandleTranslationUnit(ASTContext&)
                     llvm::sys::fs::createUniqueFile(
                         rewritten_file + "-%%%%%%%%", fd, path);
                 if (file_error) {
-                    llvm::errs() << analyser_.toplevel()
-                                 << ":1:1: error: " << file_error.message()
-                                 << ": cannot open " << path.data()
-                                 << " for writing -- attempt " << tries
-                                 << "\n";
+                    DiagnosticFilter::output()
+                        << analyser_.toplevel()
+                        << ":1:1: error: " << file_error.message()
+                        << ": cannot open " << path.data()
+                        << " for writing -- attempt " << tries
+                        << "\n";
                     continue;
                 }
                 llvm::raw_fd_ostream rfdo(fd, true);
@@ -249,30 +255,34 @@ AnalyseConsumer::HandleTranslationUnit(ASTContext&)
                 rfdo.close();
                 if (rfdo.has_error()) {
                     rfdo.clear_error();
-                    llvm::errs() << analyser_.toplevel() << ":1:1: error: "
-                                 << "IO error closing " << path.data()
-                                 << " -- attempt " << tries << "\n";
+                    DiagnosticFilter::output()
+                        << analyser_.toplevel() << ":1:1: error: "
+                        << "IO error closing " << path.data()
+                        << " -- attempt " << tries << "\n";
                     continue;
                 }
                 file_error =
                     llvm::sys::fs::rename(path.data(), rewritten_file);
                 if (file_error) {
-                    llvm::errs() << analyser_.toplevel() << ":1:1: error: "
-                                 << "cannot rename " << path.data()
-                                 << " to " << rewritten_file
-                                 << " -- attempt " << tries << "\n";
+                    DiagnosticFilter::output()
+                        << analyser_.toplevel() << ":1:1: error: "
+                        << "cannot rename " << path.data()
+                        << " to " << rewritten_file
+                        << " -- attempt " << tries << "\n";
                     continue;
                 }
                 break;
             }
             if (tries == MAX_TRIES) {
-                llvm::errs() << analyser_.toplevel() << ":1:1: error: "
-                             << "utterly failed to produce "
-                             << rewritten_file << "\n";
+                DiagnosticFilter::output()
+                    << analyser_.toplevel() << ":1:1: error: "
+                    << "utterly failed to produce "
+                    << rewritten_file << "\n";
             }
             else {
-                llvm::errs() << analyser_.toplevel() << ":1:1: note: "
-                << "wrote " << rewritten_file << "\n";
+                DiagnosticFilter::output()
+                    << analyser_.toplevel() << ":1:1: note: "
+                    << "wrote " << rewritten_file << "\n";
             }
         }
     }
@@ -285,6 +295,8 @@ PluginAction::PluginAction()
 , config_(1, "load .bdeverify")
 , tool_name_()
 , diagnose_("component")
+, parse_all_bodies_(false)
+, pp_only_(false)
 {
 }
 
@@ -314,6 +326,17 @@ bool PluginAction::ParseArgs(CompilerInstance const& compiler,
             Debug::set_debug(false);
             debug_ = false;
         }
+        else if (arg.startswith("debug-ring=")) {
+            unsigned size;
+            if (arg.substr(11).getAsInteger(10, size)) {
+                llvm::errs() << "bad csabase argument = '" << arg << "'\n";
+            }
+            else {
+                Debug::set_debug(size > 0);
+                Debug::set_ring(size);
+                debug_ = size > 0;
+            }
+        }
         else if (arg == "toplevel-only-on")
         {
             diagnose_ = "main";
@@ -339,6 +362,15 @@ bool PluginAction::ParseArgs(CompilerInstance const& compiler,
         else if (arg.startswith("diff=")) {
             diff_file_ = arg.substr(5).str();
         }
+        else if (arg.startswith("text-cache=")) {
+            text_cache_ = arg.substr(11).str();
+        }
+        else if (arg == "parse-all-bodies") {
+            parse_all_bodies_ = true;
+        }
+        else if (arg == "pp-only") {
+            pp_only_ = true;
+        }
         else
         {
             llvm::errs() << "unknown csabase argument = '" << arg << "'\n";
@@ -356,6 +388,32 @@ bool PluginAction::BeginInvocation(clang::CompilerInstance& compiler)
     return PluginASTAction::BeginInvocation(compiler);
 }
 
+void PluginAction::ExecuteAction()
+{
+    if (!pp_only_) {
+        PluginASTAction::ExecuteAction();
+        return;                                                       // RETURN
+    }
+
+    // Run the preprocessor over the whole translation unit, as parsing
+    // would, so that the preprocessor and comment events are raised, and
+    // then finish the translation unit, which has no declarations.
+    CompilerInstance& compiler = getCompilerInstance();
+    Preprocessor&     pp       = compiler.getPreprocessor();
+    ASTConsumer&      consumer = compiler.getASTConsumer();
+    consumer.Initialize(compiler.getASTContext());
+    // Without the parser, nothing handles the pragmas it would, such as
+    // '#pragma pack', so ignore those rather than warn that they are
+    // unknown.  The bde_verify pragmas are seen through the callbacks.
+    pp.IgnorePragmas();
+    pp.EnterMainSourceFile();
+    Token token;
+    do {
+        pp.Lex(token);
+    } while (token.isNot(tok::eof));
+    consumer.HandleTranslationUnit(compiler.getASTContext());
+}
+
 bool PluginAction::debug() const
 {
     return debug_;
@@ -391,6 +449,21 @@ std::string PluginAction::diff_file() const
     return diff_file_;
 }
 
+std::string PluginAction::text_cache() const
+{
+    return text_cache_;
+}
+
+bool PluginAction::parse_all_bodies() const
+{
+    return parse_all_bodies_;
+}
+
+bool PluginAction::pp_only() const
+{
+    return pp_only_;
+}
+
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
 //
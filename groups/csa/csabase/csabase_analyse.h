@@ -25,6 +25,9 @@ class PluginAction : public clang::PluginASTAction
     std::string rewrite_dir() const;
     std::string rewrite_file() const;
     std::string diff_file() const;
+    std::string text_cache() const;
+    bool parse_all_bodies() const;
+    bool pp_only() const;
 
   protected:
     std::unique_ptr<clang::ASTConsumer>
@@ -36,6 +39,10 @@ class PluginAction : public clang::PluginASTAction
 
     bool BeginInvocation(clang::CompilerInstance& compiler) override;
 
+    void ExecuteAction() override;
+        // Parse the translation unit or, with the 'pp-only' argument, only
+        // preprocess it, and pass it to the consumer.
+
   private:
     bool debug_;
     std::vector<std::string> config_;
@@ -44,6 +51,9 @@ class PluginAction : public clang::PluginASTAction
     std::string rewrite_dir_;
     std::string rewrite_file_;
     std::string diff_file_;
+    std::string text_cache_;
+    bool parse_all_bodies_;
+    bool pp_only_;
 };
 }
 
@@ -12,6 +12,7 @@
 #include <clang/AST/Type.h>
 #include <clang/AST/UnresolvedSet.h>
 #include <clang/Basic/DiagnosticIDs.h>
+#include <clang/Basic/FileManager.h>
 #include <clang/Basic/IdentifierTable.h>
 #include <clang/Basic/SourceManager.h>
 #include <clang/Frontend/CompilerInstance.h>
@@ -28,12 +29,17 @@
 #include <csabase_filenames.h>
 #include <csabase_location.h>
 #include <csabase_ppobserver.h>
+#include <csabase_rewritefile.h>
 #include <csabase_visitor.h>
 #include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseSet.h>
 #include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/Support/Error.h>
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
 #include <llvm/Support/Path.h>
 #include <llvm/Support/Regex.h>
+#include <assert.h>
 #include <stddef.h>
 #include <algorithm>
 #include <map>
@@ -49,26 +55,55 @@ using namespace clang;
 
 csabase::Analyser::Analyser(CompilerInstance& compiler,
                             const PluginAction& plugin)
-: d_config(new Config(plugin.config().size() == 0
-                          ? std::vector<std::string>(1, "load .bdeverify")
-                          : plugin.config(),
-                      compiler))
+: d_config(Config::create(plugin.config().size() == 0
+                              ? std::vector<std::string>(1, "load .bdeverify")
+                              : plugin.config(),
+                          compiler))
 , tool_name_(plugin.tool_name())
 , diagnose_(plugin.diagnose())
+, preprocess_only_(plugin.pp_only())
 , compiler_(compiler)
 , d_source_manager(compiler.getSourceManager())
 , visitor_(new Visitor())
+, diagnosable_visitor_(new Visitor())
 , context_(0)
 , rewriter_(new Rewriter(compiler.getSourceManager(), compiler.getLangOpts()))
 , rewrite_dir_(plugin.rewrite_dir())
 , rewrite_file_(plugin.rewrite_file())
 , diff_file_(plugin.diff_file())
+, text_cache_dir_(plugin.text_cache())
+, text_cache_(0)
+, instantiation_matchers_(0)
+, spelled_matchers_(0)
+, passes_(new MultiplexVisitor())
+, parents_(new ParentIndex())
+, parents_indexed_(false)
+, complete_(false)
+, keep_bodies_(plugin.parse_all_bodies())
+, skipped_bodies_(0)
 {
     compiler_.getPreprocessor().addPPCallbacks(std::unique_ptr<PPCallbacks>(
         new PPObserver(&d_source_manager, d_config.get())));
     compiler_.getPreprocessor().addCommentHandler(
         pp_observer().get_comment_handler());
-    CheckRegistry::attach(*this, *visitor_, pp_observer());
+    if (diagnose_ == "component" || diagnose_ == "main") {
+        // Pragmas elsewhere cannot affect anything that is reported.
+        pp_observer().pragma_files([this](FileID fid) {
+            return fid == d_source_manager.getMainFileID() ||
+                   is_component(fid);
+        });
+    }
+    ast_matchers::MatchFinder::MatchFinderOptions options;
+    if (compiler.getFrontendOpts().ShowTimers) {
+        options.CheckProfiling.emplace(match_times_);
+    }
+    match_finder_.reset(new ast_matchers::MatchFinder(options));
+    if (diagnose_ != "all") {
+        diagnosable_visitor_->skip([this](Decl const* decl) {
+            return !is_diagnosable(get_location(decl));
+        });
+    }
+    CheckRegistry::attach(*this, pp_observer());
 }
 
 // -----------------------------------------------------------------------------
@@ -90,6 +125,11 @@ std::string const& csabase::Analyser::diagnose() const
     return diagnose_;
 }
 
+bool csabase::Analyser::preprocess_only() const
+{
+    return preprocess_only_;
+}
+
 // -----------------------------------------------------------------------------
 
 ASTContext const* csabase::Analyser::context() const
@@ -119,6 +159,17 @@ csabase::PPObserver& csabase::Analyser::pp_observer()
         compiler_.getPreprocessor().getPPCallbacks());
 }
 
+CommentIndex& csabase::Analyser::comment_index()
+{
+    if (!comment_index_) {
+        comment_index_.reset(new CommentIndex(d_source_manager));
+        pp_observer().onComment += [this](SourceRange comment) {
+            comment_index_->add(comment);
+        };
+    }
+    return *comment_index_;
+}
+
 Rewriter& csabase::Analyser::rewriter()
 {
     return *rewriter_;
@@ -139,6 +190,21 @@ std::string const& csabase::Analyser::diff_file() const
     return diff_file_;
 }
 
+std::string const& csabase::Analyser::text_cache_dir() const
+{
+    return text_cache_dir_;
+}
+
+TextCache *csabase::Analyser::text_cache() const
+{
+    return text_cache_;
+}
+
+void csabase::Analyser::text_cache(TextCache *cache)
+{
+    text_cache_ = cache;
+}
+
 tooling::Replacements const& csabase::Analyser::replacements() const
 {
     return replacements_;
@@ -247,6 +313,24 @@ bool csabase::Analyser::is_toplevel(std::string const& name) const
     return is_top_level_[name] = FileName(name).full() == toplevel_;
 }
 
+bool csabase::Analyser::is_diagnosable(Location const& loc) const
+{
+    if (diagnose_ == "all") {
+        return true;                                                  // RETURN
+    }
+    if (!loc.file_id().isValid()) {
+        return false;                                                 // RETURN
+    }
+    if (diagnose_ == "component" && !is_component(loc)) {
+        return false;                                                 // RETURN
+    }
+    if (diagnose_ == "main" &&
+        loc.file_id() != d_source_manager.getMainFileID()) {
+        return false;                                                 // RETURN
+    }
+    return !is_generated(loc.file_id());
+}
+
 bool csabase::Analyser::is_component_header(std::string const& name) const
 {
     IsComponentHeader::iterator in = is_component_header_.find(name);
@@ -269,7 +353,25 @@ bool csabase::Analyser::is_component_header(std::string const& name) const
 
 bool csabase::Analyser::is_component_header(SourceLocation loc) const
 {
-    return is_component_header(get_location(loc).file());
+    return is_component_header(get_location(loc));
+}
+
+bool csabase::Analyser::is_component_header(Location const& loc) const
+{
+    return has_line_directives(loc.file_id())
+        ? is_component_header(loc.file())
+        : is_component_header(loc.file_id());
+}
+
+bool csabase::Analyser::is_component_header(FileID fid) const
+{
+    IsFile::iterator in = is_component_header_file_.find(fid);
+    if (in == is_component_header_file_.end()) {
+        in = is_component_header_file_.insert(
+                 std::make_pair(fid, is_component_header(file_name(fid))))
+                 .first;
+    }
+    return in->second;
 }
 
 bool csabase::Analyser::is_global_name(const NamedDecl *decl)
@@ -312,7 +414,25 @@ bool csabase::Analyser::is_system_header(llvm::StringRef file)
 
 bool csabase::Analyser::is_system_header(SourceLocation sl)
 {
-    return is_system_header(manager().getFilename(sl));
+    return is_system_header(manager().getFileID(sl));
+}
+
+bool csabase::Analyser::is_system_header(Location const& loc)
+{
+    return has_line_directives(loc.file_id())
+        ? is_system_header(loc.file())
+        : is_system_header(loc.file_id());
+}
+
+bool csabase::Analyser::is_system_header(FileID fid)
+{
+    IsFile::iterator in = is_system_header_file_.find(fid);
+    if (in == is_system_header_file_.end()) {
+        in = is_system_header_file_.insert(
+                 std::make_pair(fid, is_system_header(file_name(fid))))
+                 .first;
+    }
+    return in->second;
 }
 
 bool csabase::Analyser::is_global_package() const
@@ -374,7 +494,43 @@ bool csabase::Analyser::is_component(std::string const& file) const
 
 bool csabase::Analyser::is_component(SourceLocation loc) const
 {
-    return is_component(get_location(loc).file());
+    return is_component(get_location(loc));
+}
+
+bool csabase::Analyser::is_component(Location const& loc) const
+{
+    return has_line_directives(loc.file_id())
+        ? is_component(loc.file())
+        : is_component(loc.file_id());
+}
+
+bool csabase::Analyser::is_component(FileID fid) const
+{
+    IsFile::iterator in = is_component_file_.find(fid);
+    if (in == is_component_file_.end()) {
+        in = is_component_file_.insert(
+                 std::make_pair(fid, is_component(file_name(fid)))).first;
+    }
+    return in->second;
+}
+
+bool csabase::Analyser::has_line_directives(FileID fid) const
+    // Return true if '#line' directives in the file with the specified 'fid'
+    // can make its locations report different file names.
+{
+    bool invalid = false;
+    const SrcMgr::SLocEntry& entry =
+        d_source_manager.getSLocEntry(fid, &invalid);
+    return !invalid && entry.isFile() && entry.getFile().hasLineDirectives();
+}
+
+std::string csabase::Analyser::file_name(FileID fid) const
+    // Return the name of the file with the specified 'fid' as it was
+    // included.
+{
+    return get_location(d_source_manager.getLocForStartOfFile(fid))
+        .file()
+        .str();
 }
 
 bool csabase::Analyser::is_test_driver(std::string const &file) const
@@ -407,6 +563,9 @@ csabase::Analyser::report(SourceLocation where,
                           bool always,
                           DiagnosticIDs::Level level)
 {
+    diagnostic_builder::recorder *recorder = text_cache_
+        ? text_cache_->diagnostic(where, check, tag, message, always, level)
+        : 0;
     if (!config()->suppressed(tag, where)) {
         unsigned int id(
             compiler_.getDiagnostics().getDiagnosticIDs()->getCustomDiagID(
@@ -415,10 +574,14 @@ csabase::Analyser::report(SourceLocation where,
         if (fs.find(check) != fs.npos || fs.find(tag) != fs.npos) {
             csabase::DiagnosticFilter::fail_on(id);
         }
-        return csabase::diagnostic_builder(
+        csabase::diagnostic_builder builder(
             compiler_.getDiagnostics().Report(where, id), always);
+        builder.record(recorder);
+        return builder;                                               // RETURN
     }
-    return csabase::diagnostic_builder();
+    csabase::diagnostic_builder builder;
+    builder.record(recorder);
+    return builder;
 }
 
 // -----------------------------------------------------------------------------
@@ -475,9 +638,19 @@ SourceRange csabase::Analyser::get_line_range(SourceLocation loc)
         SourceManager& sm(manager());
         loc = sm.getExpansionLoc(loc);
         FileID fid = sm.getFileID(loc);
-        size_t line_num = sm.getExpansionLineNumber(loc);
-        range.setBegin(sm.translateLineCol(fid, line_num, 1u));
-        range.setEnd(sm.translateLineCol(fid, line_num, ~0u));
+        LineIndex const& index = line_index(fid);
+        if (!index.has_lone_cr()) {
+            unsigned line = index.line(sm.getFileOffset(loc));
+            SourceLocation start = sm.getLocForStartOfFile(fid);
+            range.setBegin(start.getLocWithOffset(index.line_start(line)));
+            range.setEnd(range.getBegin().getLocWithOffset(
+                index.line_length(line)));
+        }
+        else {
+            size_t line_num = sm.getExpansionLineNumber(loc);
+            range.setBegin(sm.translateLineCol(fid, line_num, 1u));
+            range.setEnd(sm.translateLineCol(fid, line_num, ~0u));
+        }
     }
 
     return range;
@@ -499,6 +672,16 @@ llvm::StringRef csabase::Analyser::get_source_line(SourceLocation loc)
     return get_source(get_line_range(loc), true);
 }
 
+LineIndex const& csabase::Analyser::line_index(FileID fid) const
+{
+    LineIndexes::iterator i = line_indexes_.find(fid);
+    if (i == line_indexes_.end()) {
+        i = line_indexes_.insert(std::make_pair(
+                fid, LineIndex(d_source_manager.getBufferData(fid)))).first;
+    }
+    return i->second;
+}
+
 // -----------------------------------------------------------------------------
 
 csabase::Location csabase::Analyser::get_location(SourceLocation sl) const
@@ -532,17 +715,261 @@ csabase::Location csabase::Analyser::get_location(Stmt const* stmt) const
 void csabase::Analyser::process_decl(Decl const* decl)
 {
     visitor_->visit(decl);
+    if (!diagnosable_checks_.empty()) {
+        diagnosable_visitor_->visit(decl);
+    }
+}
+
+csabase::Visitor& csabase::Analyser::visitor(CheckRegistry::Scope scope,
+                                            std::string const&   check)
+{
+    if (scope == CheckRegistry::e_Diagnosable) {
+        diagnosable_checks_.insert(check);
+        return *diagnosable_visitor_;                                 // RETURN
+    }
+    return *visitor_;
+}
+
+namespace
+{
+
+class MatchCallback : public ast_matchers::MatchFinder::MatchCallback
+    // This class saves the matches of one matcher for later delivery to its
+    // callback, and names the check that added it for profiling.
+{
+  public:
+    MatchCallback(std::string const& check,
+                  std::function<void(ast_matchers::BoundNodes const&)> const&
+                                     callback)
+    : d_check(check)
+    , d_callback(callback)
+    {
+    }
+
+    void run(ast_matchers::MatchFinder::MatchResult const& result) override
+    {
+        d_matches.push_back(result.Nodes);
+    }
+
+    StringRef getID() const override
+    {
+        return d_check;
+    }
+
+    void deliver()
+        // Invoke the callback for each saved match, and discard them.
+    {
+        for (const auto& nodes : d_matches) {
+            d_callback(nodes);
+        }
+        d_matches.clear();
+    }
+
+  private:
+    std::string                                           d_check;
+    std::function<void(ast_matchers::BoundNodes const&)> d_callback;
+    std::vector<ast_matchers::BoundNodes>                 d_matches;
+};
+
+template <class NODE>
+class SpelledMatcher : public ast_matchers::internal::MatcherInterface<NODE>
+    // This class matches the nodes of type 'NODE' that are in a set, which
+    // holds those the shared traversal reached.
+{
+  public:
+    explicit SpelledMatcher(llvm::DenseSet<void const *> const *nodes)
+    : d_nodes(nodes)
+    {
+    }
+
+    bool matches(NODE const&                                      node,
+                 ast_matchers::internal::ASTMatchFinder          *,
+                 ast_matchers::internal::BoundNodesTreeBuilder   *)
+        const override
+    {
+        return d_nodes->count(&node);
+    }
+
+  private:
+    llvm::DenseSet<void const *> const *d_nodes;
+};
+
+}
+
+void csabase::Analyser::add_matcher(
+       std::string const&                                           check,
+       ast_matchers::internal::DynTypedMatcher const&               matcher,
+       std::function<void(ast_matchers::BoundNodes const&)> const&  callback,
+       Traversal                                                    traversal)
+{
+    typedef ast_type_traits::ASTNodeKind              Kind;
+    typedef ast_matchers::internal::DynTypedMatcher   DynTypedMatcher;
+    Kind kind = matcher.getSupportedKind();
+    match_callbacks_.emplace_back(new MatchCallback(check, callback));
+    if (traversal == e_Spelled) {
+        // The shared traversal reports only declarations and statements, so
+        // a matcher of other nodes would never fire.
+        bool is_decl = Kind::getFromNodeKind<Decl>().isBaseOf(kind);
+        assert((is_decl || Kind::getFromNodeKind<Stmt>().isBaseOf(kind)) &&
+               "spelled-code matchers must match declarations or statements");
+
+        // The filter comes first, so that nodes the shared traversal did not
+        // reach are rejected before the matcher is tried.
+        DynTypedMatcher spelled = is_decl
+            ? DynTypedMatcher(ast_matchers::internal::Matcher<Decl>(
+                  new SpelledMatcher<Decl>(&spelled_nodes_)))
+            : DynTypedMatcher(ast_matchers::internal::Matcher<Stmt>(
+                  new SpelledMatcher<Stmt>(&spelled_nodes_)));
+        ++spelled_matchers_;
+        match_finder_->addDynamicMatcher(
+            DynTypedMatcher::constructVariadic(
+                DynTypedMatcher::VO_AllOf, kind, { spelled, matcher }),
+            match_callbacks_.back().get());
+    }
+    else {
+        ++instantiation_matchers_;
+        match_finder_->addDynamicMatcher(matcher,
+                                         match_callbacks_.back().get());
+    }
+}
+
+void csabase::Analyser::keep_function_bodies()
+{
+    keep_bodies_ = true;
+}
+
+void csabase::Analyser::index_parents(CheckRegistry::Scope scope)
+{
+    // The widest scope asked for is indexed.
+    if (!parents_indexed_ || scope != CheckRegistry::e_Diagnosable) {
+        passes_->index(parents_.get(), prune(scope));
+    }
+    parents_indexed_ = true;
+}
+
+MultiplexVisitor::Prune csabase::Analyser::prune(CheckRegistry::Scope scope)
+{
+    if (scope != CheckRegistry::e_Diagnosable || diagnose_ == "all") {
+        return MultiplexVisitor::Prune();                             // RETURN
+    }
+    return [this](Decl const* decl) {
+        return !is_diagnosable(get_location(decl));
+    };
+}
+
+bool csabase::Analyser::skips_function_bodies() const
+{
+    return diagnose_ != "all" && !keep_bodies_;
+}
+
+bool csabase::Analyser::skip_function_body(Decl const* decl)
+{
+    if (!skips_function_bodies() || is_diagnosable(get_location(decl))) {
+        return false;                                                 // RETURN
+    }
+
+    // Templates are instantiated from their bodies, possibly in diagnosed
+    // code that checks such as 'allocator-forward' examine.
+    if (llvm::isa<FunctionTemplateDecl>(decl)) {
+        return false;                                                 // RETURN
+    }
+    if (const DeclContext *dc = llvm::dyn_cast<DeclContext>(decl)) {
+        if (dc->isDependentContext()) {
+            return false;                                             // RETURN
+        }
+    }
+    ++skipped_bodies_;
+    return true;
 }
 
 void csabase::Analyser::process_translation_unit_done()
 {
+    complete_ = true;
     config()->check_bv_stack(*this);
+    if (spelled_matchers_) {
+        passes_->observe([this](ast_type_traits::DynTypedNode const& node) {
+            spelled_nodes_.insert(node.getMemoizationData());
+        });
+    }
+    if (!passes_->empty()) {
+        passes_->TraverseDecl(context_->getTranslationUnitDecl());
+        if (compiler_.getFrontendOpts().ShowTimers) {
+            llvm::raw_ostream& out = DiagnosticFilter::output();
+            out << "===" << std::string(73, '-') << "===\n"
+                << "                     bde_verify shared traversal report\n"
+                << "===" << std::string(73, '-') << "===\n";
+            passes_->print(out);
+        }
+    }
+    if (instantiation_matchers_ || spelled_matchers_) {
+        // One traversal, with the memoization and profiling of a single
+        // 'MatchFinder', serves both kinds of matcher.
+        match_finder_->matchAST(*context_);
+    }
+    if (!match_times_.empty()) {
+        llvm::raw_ostream& out = DiagnosticFilter::output();
+        llvm::TimeRecord   total;
+        for (const auto& time : match_times_) {
+            total += time.getValue();
+        }
+        out << "===" << std::string(73, '-') << "===\n"
+            << "                         bde_verify matcher time report\n"
+            << "===" << std::string(73, '-') << "===\n";
+        for (const auto& time : match_times_) {
+            time.getValue().print(total, out);
+            out << time.getKey() << "\n";
+        }
+        total.print(total, out);
+        out << "Total\n\n";
+    }
+    for (const auto& callback : match_callbacks_) {
+        static_cast<MatchCallback&>(*callback).deliver();
+    }
+    if (compiler_.getFrontendOpts().ShowTimers && diagnose_ != "all") {
+        // Passes prune for themselves; the checks subscribed to the
+        // diagnosable visitor share its pruning, and so its count.
+        std::map<std::string, unsigned> pruned;
+        passes_->pruned(&pruned);
+        for (const auto& check : diagnosable_checks_) {
+            pruned[check + " (shared)"] = diagnosable_visitor_->skipped();
+        }
+        if (!pruned.empty()) {
+            llvm::raw_ostream& out = DiagnosticFilter::output();
+            out << "===" << std::string(73, '-') << "===\n"
+                << "                  bde_verify pruned declarations report\n"
+                << "===" << std::string(73, '-') << "===\n"
+                << "  Declarations outside the files diagnosed ('diagnose "
+                << diagnose_ << "') skipped\n  with their contents, for "
+                << "each check:\n\n";
+            for (const auto& check : pruned) {
+                out << llvm::format("%10u", check.second) << "  "
+                    << check.first << "\n";
+            }
+            if (!diagnosable_checks_.empty()) {
+                out << "\n  Checks marked (shared) subscribe to one visitor, "
+                    << "which skipped the\n  declarations once for all of "
+                    << "them.\n";
+            }
+            out << "\n";
+        }
+    }
+    if (compiler_.getFrontendOpts().ShowTimers &&
+        skips_function_bodies()) {
+        llvm::raw_ostream& out = DiagnosticFilter::output();
+        out << "===" << std::string(73, '-') << "===\n"
+            << "                 bde_verify skipped function bodies report\n"
+            << "===" << std::string(73, '-') << "===\n"
+            << "  Function bodies outside the files diagnosed ('diagnose "
+            << diagnose_ << "') not parsed:\n\n"
+            << llvm::format("%10u", skipped_bodies_) << "\n\n";
+    }
     onTranslationUnitDone();
     FileID fid = d_source_manager.getMainFileID();
     pp_observer().FileChanged(d_source_manager.getLocForEndOfFile(fid),
                               PPCallbacks::ExitFile,
                               SrcMgr::CharacteristicKind(),
                               fid);
+    merge_replacements();
 }
 
 // -----------------------------------------------------------------------------
@@ -595,7 +1022,17 @@ namespace
 NamedDecl*
 csabase::Analyser::lookup_name(std::string const& name)
 {
-    return ::lookup_name(sema(), name);
+    // Until the translation unit is complete, a later declaration can change
+    // the result.
+    if (!complete_) {
+        return ::lookup_name(sema(), name);                           // RETURN
+    }
+    auto it = names_.find(name);
+    if (it == names_.end()) {
+        it = names_.insert(std::make_pair(name, ::lookup_name(sema(), name)))
+                 .first;
+    }
+    return it->getValue();
 }
 
 TypeDecl*
@@ -664,15 +1101,23 @@ bool csabase::Analyser::is_ADL_candidate(Decl const* decl)
 
 static llvm::Regex generated("GENERATED FILE -+ DO NOT EDIT");
 
-bool csabase::Analyser::is_generated(SourceLocation loc) const
-    // Return true if this is an automatically generated file.  The criterion
-    // is a first line containing "GENERATED FILE -- DO NOT EDIT".
-{
-    loc = d_source_manager.getFileLoc(loc);
-    FileID fid = d_source_manager.getFileID(loc);
+csabase::Analyser::Generated const&
+csabase::Analyser::generated(FileID fid) const
+    // Return the generated parts of the file with the specified 'fid',
+    // finding them on first use.  A file is generated if its first line
+    // contains "GENERATED FILE -- DO NOT EDIT".  Otherwise, a generated block
+    // starts at a "// {{{ BEGIN GENERATED CODE" line and extends to the next
+    // "// }}} END GENERATED CODE" line, or the end of the file.
+{
+    IsGenerated::iterator i = is_generated_.find(fid);
+    if (i != is_generated_.end()) {
+        return i->second;                                             // RETURN
+    }
+    Generated& g = is_generated_[fid];
     llvm::StringRef buf = d_source_manager.getBufferData(fid);
-    if (generated.match(buf.split('\n').first)) {
-        return true;                                                  // RETURN
+    g.whole_ = generated.match(buf.split('\n').first);
+    if (g.whole_) {
+        return g;                                                     // RETURN
     }
 
     // Note that the bg/eg tags below do not respect preprocessor sections.
@@ -685,14 +1130,39 @@ bool csabase::Analyser::is_generated(SourceLocation loc) const
     //  // }}} END GENERATED CODE
     //  #endif
     //..
-    unsigned pos = d_source_manager.getFileOffset(loc);
+    // A location belongs to the block of the last begin tag before it, so a
+    // begin tag within a block ends that block.
     static const char bg[] = "\n// {{{ BEGIN GENERATED CODE";
     static const char eg[] = "\n// }}} END GENERATED CODE";
-    size_t bpos = buf.npos;
-    for (size_t p = 0; (p = buf.find(bg, p)) < pos; ++p) {
-        bpos = p;
+    for (size_t b = buf.find(bg), next; b != buf.npos; b = next) {
+        next = buf.find(bg, b + 1);
+        size_t e = std::min(buf.find(eg, b),
+                            next == buf.npos ? next : next + 1);
+        g.regions_.push_back(std::make_pair(
+            unsigned(b + 1), unsigned(std::min<size_t>(e, ~0u))));
+    }
+    return g;
+}
+
+bool csabase::Analyser::is_generated(FileID fid) const
+    // Return true if this is an automatically generated file.
+{
+    return generated(fid).whole_;
+}
+
+bool csabase::Analyser::is_generated(SourceLocation loc) const
+    // Return true if this is in an automatically generated file or block.
+{
+    loc = d_source_manager.getFileLoc(loc);
+    std::pair<FileID, unsigned> p = d_source_manager.getDecomposedLoc(loc);
+    Generated const& g = generated(p.first);
+    if (g.whole_) {
+        return true;                                                  // RETURN
     }
-    return bpos != buf.npos && pos < buf.find(eg, bpos);
+    auto i = std::upper_bound(g.regions_.begin(),
+                              g.regions_.end(),
+                              std::make_pair(p.second, ~0u));
+    return i != g.regions_.begin() && p.second < (--i)->second;
 }
 
 // ----------------------------------------------------------------------------
@@ -700,10 +1170,7 @@ bool csabase::Analyser::is_generated(SourceLocation loc) const
 std::string
 csabase::Analyser::get_rewrite_file(std::string file)
 {
-    llvm::SmallVector<char, 512> path(
-        rewrite_dir_.begin(), rewrite_dir_.end());
-    llvm::sys::path::append(path, llvm::sys::path::filename(file));
-    return std::string(path.begin(), path.end()) + "-rewritten";
+    return RewriteFile::rewritten_name(rewrite_dir_, file);
 }
 
 // ----------------------------------------------------------------------------
@@ -745,14 +1212,73 @@ int csabase::Analyser::ReplaceText(SourceRange r, llvm::StringRef s)
 int csabase::Analyser::ReplaceText(
           llvm::StringRef file, unsigned offset, unsigned n, llvm::StringRef s)
 {
-    tooling::Replacement r(FileName(file).full(), offset, n, s);
-    tooling::Replacements one;
-    if (!one.add(r)) {
-        replacements_ = replacements_.merge(one);
+    if (text_cache_) {
+        text_cache_->replacement(file, offset, n, s);
     }
+    Edit edit = { offset, n, s.str() };
+    edits_[FileName(file).full()].push_back(edit);
     return 0;
 }
 
+void csabase::Analyser::merge_replacements()
+{
+    replacements_ = tooling::Replacements();
+    for (auto& file : edits_) {
+        llvm::StringRef    name  = file.getKey();
+        std::vector<Edit>& edits = file.getValue();
+
+        RewriteFile::merge(&edits, [&](Edit const& edit) {
+            report_conflict(name, edit.d_offset);
+        });
+
+        for (const auto& edit : edits) {
+            llvm::Error error = replacements_.add(tooling::Replacement(
+                name, edit.d_offset, edit.d_length, edit.d_text));
+            if (error) {
+                llvm::consumeError(std::move(error));
+                report_conflict(name, edit.d_offset);
+            }
+        }
+    }
+}
+
+void csabase::Analyser::combine_replacements(
+                         std::vector<tooling::Replacement> const& record)
+{
+    llvm::StringMap<std::vector<Edit>> record_edits;
+    for (const auto& r : record) {
+        Edit edit = {
+            r.getOffset(), r.getLength(), r.getReplacementText().str()
+        };
+        record_edits[FileName(r.getFilePath()).full()].push_back(edit);
+    }
+
+    for (auto& file : record_edits) {
+        llvm::StringRef name     = file.getKey();
+        auto            conflict = [&](Edit const& edit) {
+            report_conflict(name, edit.d_offset);
+        };
+        RewriteFile::merge(&file.getValue(), conflict);
+        RewriteFile::combine(&edits_[name], file.getValue(), conflict);
+    }
+}
+
+void csabase::Analyser::report_conflict(llvm::StringRef file, unsigned offset)
+    // Report that the rewriting action at the specified 'offset' of the
+    // specified 'file' conflicts with another, and is dropped.
+{
+    SourceLocation loc;
+    if (const FileEntry *fe = compiler_.getFileManager().getFile(file)) {
+        FileID fid = d_source_manager.translateFile(fe);
+        if (fid.isValid()) {
+            loc = d_source_manager.getLocForStartOfFile(fid).getLocWithOffset(
+                offset);
+        }
+    }
+    report(loc, "base", "RW01",
+           "Rewrite overlaps an earlier rewrite and is not applied");
+}
+
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
 //
@@ -4,21 +4,35 @@
 #define INCLUDED_CSABASE_ANALYSER
 
 #include <clang/AST/ASTContext.h>
+#include <clang/ASTMatchers/ASTMatchFinder.h>
 #include <clang/Basic/Diagnostic.h>
 #include <clang/Basic/SourceLocation.h>
 #include <clang/Tooling/Refactoring.h>
 #include <csabase_analyse.h>
 #include <csabase_attachments.h>
+#include <csabase_checkregistry.h>
+#include <csabase_commentindex.h>
 #include <csabase_config.h>
 #include <csabase_diagnostic_builder.h>
+#include <csabase_lineindex.h>
 #include <csabase_location.h>
+#include <csabase_multiplexvisitor.h>
+#include <csabase_parentindex.h>
 #include <csabase_ppobserver.h>
+#include <csabase_rewritefile.h>
+#include <csabase_textcache.h>
 #include <csabase_visitor.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/StringMap.h>
 #include <llvm/Support/Casting.h>
+#include <llvm/Support/Timer.h>
+#include <functional>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utils/event.hpp>
 #include <vector>
@@ -45,6 +59,10 @@ class Analyser : public Attachments
     Config const* config() const;
     std::string const& tool_name() const;
     std::string const& diagnose() const;
+    bool preprocess_only() const;
+        // Return whether the translation unit is only preprocessed, so that
+        // there are no declarations and only the checks with scope
+        // 'CheckRegistry::e_Preprocessor' are run.
 
     clang::ASTContext                   *context();
     clang::ASTContext const             *context() const;
@@ -55,6 +73,11 @@ class Analyser : public Attachments
     csabase::PPObserver&                 pp_observer();
     clang::tooling::Replacements const&  replacements() const;
 
+    CommentIndex&                        comment_index();
+        // Return the index of the comments of the translation unit, which
+        // collects comments from the first call on, so checks that use it
+        // should call this when they subscribe.
+
     std::string const& toplevel() const;
     std::string const& directory() const;
     std::string const& prefix() const;
@@ -64,21 +87,37 @@ class Analyser : public Attachments
     std::string const& rewrite_dir() const;
     std::string const& rewrite_file() const;
     std::string const& diff_file() const;
+    std::string const& text_cache_dir() const;
+    TextCache         *text_cache() const;
+    void               text_cache(TextCache *);
+        // The directory holding the results of text-only checks, and the
+        // object recording the results of the check currently examining a
+        // file, if any.  See 'TextCache'.
     void               toplevel(std::string const&);
     bool               is_header(std::string const&) const;
     bool               is_component_header(std::string const&) const;
     bool               is_component_header(clang::SourceLocation) const;
+    bool               is_component_header(Location const&) const;
+    bool               is_component_header(clang::FileID) const;
     bool               is_source(std::string const&) const;
     bool               is_component_source(std::string const&) const;
     bool               is_component_source(clang::SourceLocation) const;
     bool               is_component(clang::SourceLocation) const;
+    bool               is_component(Location const&) const;
+    bool               is_component(clang::FileID) const;
     bool               is_component(std::string const&) const;
     template <typename T> bool is_component(T const*);
     template <typename T> bool is_component_header(T const*);
     template <typename T> bool is_component_source(T const*);
     bool               is_system_header(llvm::StringRef);
     bool               is_system_header(clang::SourceLocation);
+    bool               is_system_header(Location const&);
+    bool               is_system_header(clang::FileID);
     template <typename T> bool is_system_header(T const*);
+        // The 'FileID' overloads classify a file by the name it is included
+        // as, and remember the answer.  The 'Location' overloads (and those
+        // for AST nodes) use them unless '#line' directives can give the
+        // file other names.
     bool               is_test_driver() const;
     bool               is_test_driver(const std::string &) const;
     template <typename T> bool is_test_driver(T const*);
@@ -89,7 +128,11 @@ class Analyser : public Attachments
     bool               is_global_package(std::string const&) const;
     bool               is_ADL_candidate(clang::Decl const*);
     bool               is_generated(clang::SourceLocation) const;
+    bool               is_generated(clang::FileID) const;
     bool               is_toplevel(std::string const&) const;
+    bool               is_diagnosable(Location const&) const;
+        // Return 'true' unless the 'diagnose' setting excludes every warning
+        // in the file of the specified location.
 
     diagnostic_builder report(clang::SourceLocation       where,
                               std::string const&          check,
@@ -114,6 +157,9 @@ class Analyser : public Attachments
     clang::SourceRange      get_line_range(clang::SourceLocation);
     clang::SourceRange      get_trim_line_range(clang::SourceLocation);
     llvm::StringRef         get_source_line(clang::SourceLocation);
+    LineIndex const&        line_index(clang::FileID) const;
+        // Return the index of the lines and special characters of the
+        // specified file, which is built on first use.
     Location get_location(clang::SourceLocation) const;
     Location get_location(clang::Decl const*) const;
     Location get_location(clang::Expr const*) const;
@@ -121,20 +167,111 @@ class Analyser : public Attachments
 
     template <typename InIt> void process_decls(InIt, InIt);
     void process_decl(clang::Decl const*);
+    Visitor& visitor(CheckRegistry::Scope scope, std::string const& check);
+        // Return the visitor to whose events the specified 'check' with the
+        // specified 'scope' subscribes.  Declarations in files that cannot
+        // be diagnosed are pruned from the traversal of the visitor for the
+        // 'e_Diagnosable' scope, and with '-ftime-report', the number pruned
+        // is reported for each such check.
+    void keep_function_bodies();
+        // Arrange for the bodies of all functions to be parsed.  Checks that
+        // need what is used in the bodies of functions in files that cannot
+        // be diagnosed call this when they subscribe.
+
+    bool skips_function_bodies() const;
+        // Return whether the bodies of functions in files that cannot be
+        // diagnosed are left unparsed.  This is not so with 'diagnose all',
+        // with the 'parse-all-bodies' plugin argument, or if a check has
+        // called 'keep_function_bodies'.
+
+    bool skip_function_body(clang::Decl const* decl);
+        // Return whether the body of the specified function 'decl' is left
+        // unparsed: 'skips_function_bodies()' is 'true', 'decl' is in a file
+        // that cannot be diagnosed, and 'decl' is not a template or within
+        // one (whose body is needed to instantiate it).  With
+        // '-ftime-report', the number of bodies skipped is reported.
+
     void process_translation_unit_done();
     utils::event<void()> onTranslationUnitDone;
 
+    enum Traversal {
+        e_Spelled,          // only code spelled in the source
+        e_Instantiations    // also template instantiations and implicit code
+    };
+        // The nodes a matcher is tried against.
+
+    void add_matcher(
+         std::string const&                                      check,
+         clang::ast_matchers::internal::DynTypedMatcher const&   matcher,
+         std::function<void(clang::ast_matchers::BoundNodes const&)> const&
+                                                                 callback,
+         Traversal                                     traversal = e_Spelled);
+        // Arrange for the specified 'callback' to be invoked with the bound
+        // nodes of every match of the specified 'matcher', on behalf of the
+        // specified 'check'.  By default, or if the optionally specified
+        // 'traversal' is 'e_Spelled', the matcher matches only the
+        // declarations and statements the passes added with 'add_pass' walk,
+        // which excludes implicit template instantiations and implicit code;
+        // such a matcher must match declarations or statements (this is
+        // asserted).  Otherwise it also matches every instantiation and
+        // implicit node, which checks that look at resolved calls or types
+        // within templates need.  All matchers are run together, in one
+        // traversal of the translation unit after that of the passes, once
+        // it is complete and before 'onTranslationUnitDone' is raised.  The
+        // callbacks are then invoked in the order they were added, each for
+        // all of its matches in traversal order, just as if each matcher had
+        // been run separately.  Checks should add their matchers when they
+        // subscribe, and should use matchers that match the nodes of
+        // interest directly rather than through 'forEachDescendant' of the
+        // translation unit.  With '-ftime-report', the matching time of each
+        // check and the number of nodes walked are reported.
+
+    template <typename Pass>
+    void add_pass(
+        std::string const&   check,
+        Pass const&          pass,
+        CheckRegistry::Scope scope = CheckRegistry::e_TranslationUnit);
+        // Arrange for the hooks of a copy of the specified 'pass', a
+        // 'RecursiveASTVisitor' of the kind 'MultiplexVisitor' accepts, to
+        // be called on behalf of the specified 'check' in a single traversal
+        // of the translation unit shared by all passes and by the 'e_Spelled'
+        // matchers, once it is complete, before the match callbacks are
+        // invoked and 'onTranslationUnitDone' is raised.  The traversal does
+        // not enter template instantiations or implicit code.  If the
+        // specified 'scope' is 'e_Diagnosable', the pass does not see
+        // declarations in files that cannot be diagnosed.
+        // Checks should add their passes when they subscribe, and finish
+        // their work in 'onTranslationUnitDone'.  With '-ftime-report', the
+        // number of nodes walked, and of those each pass saw, is reported.
+
     clang::NamedDecl* lookup_name(std::string const& name);
     clang::TypeDecl*  lookup_type(std::string const& name);
     template <typename T> T* lookup_name_as(std::string const& name);
+        // Return the declaration of the specified qualified 'name', or 0 if
+        // there is none.  Once the translation unit is complete, the result
+        // for each 'name' is remembered, so checks may look up the same
+        // names repeatedly.
 
     bool hasContext() const { return context_; }
 
+    void index_parents(
+                CheckRegistry::Scope scope = CheckRegistry::e_Diagnosable);
+        // Arrange for the shared traversal of the translation unit to record
+        // the parents of the declarations and statements in files that can
+        // be diagnosed, or, if the specified 'scope' is 'e_TranslationUnit',
+        // in all files, so that 'get_parent' finds their ancestors without
+        // building the parent map of the whole translation unit.  Checks
+        // that call 'get_parent' should call this when they subscribe.
+
     template <typename Parent, typename Node>
     const Parent *get_parent(const Node *node);
         // Return a pointer to the object of the specified 'Parent' type which
         // is the nearest ancestor of the specified 'node' of 'Node' type, and
-        // 0 if there is no such object.
+        // 0 if there is no such object.  The ancestors of a node recorded by
+        // 'index_parents' are found in time proportional to its depth; for
+        // any other node, such as one within a template instantiation or
+        // one reached before the shared traversal, 'clang::ASTContext' must
+        // build the parent map of the whole translation unit.
 
     std::string get_rewrite_file(std::string file);
         // Return the name of the file to use for rewriting the specified
@@ -147,7 +284,25 @@ class Analyser : public Attachments
     int ReplaceText(clang::SourceRange r, llvm::StringRef s);
     int ReplaceText(
          llvm::StringRef file, unsigned offset, unsigned n, llvm::StringRef s);
-        // Rewriting actions.
+        // Rewriting actions.  These are collected for each file, in terms of
+        // the original text, and become visible through 'replacements()'
+        // only when 'merge_replacements()' is called.
+
+    void merge_replacements();
+        // Make 'replacements()' hold all the rewriting actions so far, less
+        // duplicates.  Insertions at the same place are combined in the
+        // order they were made.  An action that overlaps one made earlier is
+        // reported and dropped.  This is called when the translation unit is
+        // done.
+
+    void combine_replacements(
+                 std::vector<clang::tooling::Replacement> const& record);
+        // Add the rewriting actions of the specified 'record', made by
+        // another translation unit, to those merged so far, as
+        // 'RewriteFile::combine' does: actions identical to ones already
+        // present are dropped, and other overlapping actions are reported
+        // and dropped.  They become visible through 'replacements()' when
+        // 'merge_replacements()' is next called.
 
 private:
     Analyser(Analyser const&);
@@ -156,9 +311,12 @@ private:
     std::auto_ptr<Config>                 d_config;
     std::string                           tool_name_;
     std::string                           diagnose_;
+    bool                                  preprocess_only_;
     clang::CompilerInstance&              compiler_;
     clang::SourceManager const&           d_source_manager;
     std::auto_ptr<Visitor>                visitor_;
+    std::auto_ptr<Visitor>                diagnosable_visitor_;
+    std::set<std::string>                 diagnosable_checks_;
     clang::ASTContext*                    context_;
     clang::Rewriter*                      rewriter_;
     std::string                           toplevel_;
@@ -170,15 +328,60 @@ private:
     std::string                           rewrite_dir_;
     std::string                           rewrite_file_;
     std::string                           diff_file_;
+    std::string                           text_cache_dir_;
+    TextCache                            *text_cache_;
     typedef std::map<std::string, bool>   IsComponent;
     mutable IsComponent                   is_component_;
     typedef std::map<std::string, bool>   IsComponentHeader;
     mutable IsComponentHeader             is_component_header_;
+    typedef llvm::DenseMap<clang::FileID, bool> IsFile;
+    mutable IsFile                        is_component_file_;
+    mutable IsFile                        is_component_header_file_;
+    IsFile                                is_system_header_file_;
+    bool               has_line_directives(clang::FileID) const;
+    std::string        file_name(clang::FileID) const;
     typedef std::map<std::string, bool>   IsGlobalPackage;
     mutable IsGlobalPackage               is_global_package_;
     typedef std::map<std::string, bool>   IsStandardNamespace;
     mutable IsStandardNamespace           is_standard_namespace_;
     clang::tooling::Replacements          replacements_;
+    typedef RewriteFile::Edit             Edit;
+    typedef llvm::StringMap<std::vector<Edit>> Edits;
+    Edits                                 edits_;
+    llvm::StringMap<llvm::TimeRecord>     match_times_;
+    std::unique_ptr<clang::ast_matchers::MatchFinder>
+                                          match_finder_;
+    llvm::DenseSet<void const *>          spelled_nodes_;
+    unsigned                              instantiation_matchers_;
+    unsigned                              spelled_matchers_;
+    std::vector<std::unique_ptr<
+        clang::ast_matchers::MatchFinder::MatchCallback>>
+                                          match_callbacks_;
+    std::unique_ptr<CommentIndex>         comment_index_;
+    std::unique_ptr<MultiplexVisitor>     passes_;
+    std::unique_ptr<ParentIndex>          parents_;
+    bool                                  parents_indexed_;
+    MultiplexVisitor::Prune prune(CheckRegistry::Scope scope);
+        // Return the predicate for the declarations that passes added with
+        // the specified 'scope' do not see.
+    bool                                  complete_;
+    bool                                  keep_bodies_;
+    unsigned                              skipped_bodies_;
+    llvm::StringMap<clang::NamedDecl*>    names_;
+    struct Generated
+        // The automatically generated parts of a file: either the whole
+        // file, or the sorted, non-overlapping '[begin, end)' offset ranges
+        // of its generated code blocks.
+    {
+        bool                                        whole_;
+        std::vector<std::pair<unsigned, unsigned>>  regions_;
+    };
+    Generated const&                      generated(clang::FileID) const;
+    typedef std::map<clang::FileID, Generated> IsGenerated;
+    mutable IsGenerated                   is_generated_;
+    void report_conflict(llvm::StringRef file, unsigned offset);
+    typedef std::map<clang::FileID, LineIndex> LineIndexes;
+    mutable LineIndexes                   line_indexes_;
     typedef std::map<std::string, bool>   IsSystemHeader;
     mutable IsSystemHeader                is_system_header_;
     typedef std::map<std::string, bool>   IsTopLevel;
@@ -216,14 +419,14 @@ template <typename T>
 inline
 bool Analyser::is_component(T const* value)
 {
-    return is_component(get_location(value).file());
+    return is_component(get_location(value));
 }
 
 template <typename T>
 inline
 bool Analyser::is_component_header(T const* value)
 {
-    return is_component_header(get_location(value).file());
+    return is_component_header(get_location(value));
 }
 
 template <typename T>
@@ -237,7 +440,7 @@ template <typename T>
 inline
 bool Analyser::is_system_header(T const* value)
 {
-    return is_system_header(get_location(value).file());
+    return is_system_header(get_location(value));
 }
 
 template <typename T>
@@ -247,6 +450,15 @@ bool Analyser::is_test_driver(T const* value)
     return is_test_driver(get_location(value).file());
 }
 
+template <typename Pass>
+inline
+void Analyser::add_pass(std::string const&   check,
+                        Pass const&          pass,
+                        CheckRegistry::Scope scope)
+{
+    passes_->add(check, pass, prune(scope));
+}
+
 template <typename T>
 inline
 T* Analyser::lookup_name_as(const std::string& name)
@@ -259,6 +471,10 @@ template <typename Parent, typename Node>
 inline
 const Parent* Analyser::get_parent(const Node* node)
 {
+    auto n = clang::ast_type_traits::DynTypedNode::create(*node);
+    if (parents_->contains(n)) {
+        return parents_->get<Parent>(n);                              // RETURN
+    }
     for (auto pv = context()->getParents(*node);
          pv.size() >= 1;
          pv = context()->getParents(pv[0])) {
@@ -1,6 +1,7 @@
 // csabase_attachments.cpp                                            -*-C++-*-
 
 #include <csabase_attachments.h>
+#include <atomic>
 
 csabase::AttachmentBase::~AttachmentBase()
 {
@@ -17,6 +18,12 @@ csabase::Attachments::~Attachments()
     }
 }
 
+size_t csabase::Attachments::allocate_index()
+{
+    static std::atomic<size_t> next(0);
+    return next++;
+}
+
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
 //
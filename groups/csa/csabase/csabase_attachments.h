@@ -81,6 +81,11 @@ class Attachments
         // the specified 'TYPE'.
 
   private:
+    static size_t allocate_index();
+        // Return a process-wide unique slot index for a new attachment type.
+        // Indexes must not depend on any one 'Attachments' object, since
+        // several analysers may be alive at once in batch mode.
+
     std::vector<AttachmentBase *> d_attachments;
 };
 
@@ -90,7 +95,7 @@ TYPE& Attachments::attachment()
 {
     // The first time this is called (for the specified 'TYPE') a new
     // attachment will be created in the attachments vector.
-    static size_t index = d_attachments.size();
+    static size_t index = allocate_index();
     if (index >= d_attachments.size()) {
         d_attachments.resize(index + 1);
     }
@@ -13,7 +13,9 @@ using namespace csabase;
 
 namespace
 {
-typedef std::multimap<std::string, CheckRegistry::Subscriber> map_type;
+typedef std::multimap<std::string,
+                      std::pair<CheckRegistry::Subscriber,
+                                CheckRegistry::Scope>> map_type;
 
 map_type& checks()
 {
@@ -26,17 +28,16 @@ map_type& checks()
 
 void
 csabase::CheckRegistry::add_check(std::string const& name,
-                                  CheckRegistry::Subscriber check)
+                                  CheckRegistry::Subscriber check,
+                                  CheckRegistry::Scope scope)
 {
-    checks().insert(std::make_pair(name, check));
+    checks().insert(std::make_pair(name, std::make_pair(check, scope)));
 }
 
 // -----------------------------------------------------------------------------
 
 void
-csabase::CheckRegistry::attach(Analyser& analyser,
-                               Visitor& visitor,
-                               PPObserver& observer)
+csabase::CheckRegistry::attach(Analyser& analyser, PPObserver& observer)
 {
     typedef map_type::const_iterator const_iterator;
     typedef std::map<std::string, Config::Status> checks_type;
@@ -55,9 +56,16 @@ csabase::CheckRegistry::attach(Analyser& analyser,
 
     for (const auto& check : checks()) {
         checks_type::const_iterator cit(config.find(check.first));
+        if (analyser.preprocess_only() &&
+            check.second.second != CheckRegistry::e_Preprocessor) {
+            continue;
+        }
         if ((config.end() != cit && cit->second == Config::on) ||
             (config.end() == cit && analyser.config()->all())) {
-            check.second(analyser, visitor, observer);
+            check.second.first(
+                analyser,
+                analyser.visitor(check.second.second, check.first),
+                observer);
         }
     }
 }
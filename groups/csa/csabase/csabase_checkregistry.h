@@ -21,8 +21,23 @@ class CheckRegistry
 {
   public:
     typedef utils::function<void(Analyser&, Visitor&, PPObserver&)> Subscriber;
-    static void add_check(std::string const&, Subscriber);
-    static void attach(Analyser&, Visitor&, PPObserver&);
+
+    enum Scope
+        // The declarations whose events a check needs to see.
+    {
+        e_TranslationUnit,  // all of them
+        e_Diagnosable,      // only those in files that can be diagnosed
+        e_Preprocessor      // none; only preprocessor events and comments
+    };
+
+    static void add_check(std::string const&,
+                          Subscriber,
+                          Scope = e_TranslationUnit);
+    static void attach(Analyser&, PPObserver&);
+        // Subscribe each enabled check to the events of the visitor that
+        // 'Analyser::visitor' returns for its scope.  If the translation
+        // unit is only preprocessed (see 'Analyser::preprocess_only'), only
+        // the checks with scope 'e_Preprocessor' are subscribed.
 };
 }
 
@@ -0,0 +1,181 @@
+// csabase_commentindex.cpp                                           -*-C++-*-
+
+#include <csabase_commentindex.h>
+#include <clang/Basic/SourceManager.h>
+#include <csabase_util.h>
+#include <algorithm>
+
+using namespace csabase;
+using namespace clang;
+
+// ----------------------------------------------------------------------------
+
+csabase::CommentIndex::CommentIndex(SourceManager& manager)
+: d_manager(manager)
+{
+}
+
+void csabase::CommentIndex::add(SourceRange comment)
+{
+    FileID fid = d_manager.getFileID(comment.getBegin());
+    if (d_files.find(fid) == d_files.end()) {
+        d_file_order.push_back(fid);
+    }
+    File& file = d_files[fid];
+    bool joined = !file.d_comments.empty() &&
+                  areConsecutive(d_manager, file.d_comments.back(), comment);
+    file.d_comments.push_back(comment);
+    file.d_joined.push_back(joined);
+    if (joined) {
+        file.d_blocks.back().setEnd(comment.getEnd());
+    }
+    else {
+        d_block_order.push_back(std::make_pair(fid, file.d_blocks.size()));
+        file.d_blocks.push_back(comment);
+    }
+}
+
+CommentIndex::Ranges csabase::CommentIndex::blocks() const
+{
+    Ranges result;
+    result.reserve(d_block_order.size());
+    for (const auto& block : d_block_order) {
+        result.push_back(d_files.find(block.first)->second.d_blocks[
+                                                               block.second]);
+    }
+    return result;
+}
+
+CommentIndex::Ranges const& csabase::CommentIndex::blocks(FileID fid) const
+{
+    static Ranges const empty;
+    auto it = d_files.find(fid);
+    return it == d_files.end() ? empty : it->second.d_blocks;
+}
+
+CommentIndex::Ranges csabase::CommentIndex::blocks(
+                 FileID                                         fid,
+                 std::function<bool(clang::SourceRange)> const& alone) const
+{
+    Ranges result;
+    auto it = d_files.find(fid);
+    if (it != d_files.end()) {
+        File const& file = it->second;
+        bool previous_alone = false;
+        for (size_t i = 0; i < file.d_comments.size(); ++i) {
+            SourceRange comment = file.d_comments[i];
+            bool this_alone = alone(comment);
+            if (file.d_joined[i] && !previous_alone && !this_alone) {
+                result.back().setEnd(comment.getEnd());
+            }
+            else {
+                result.push_back(comment);
+            }
+            previous_alone = this_alone;
+        }
+    }
+    return result;
+}
+
+unsigned csabase::CommentIndex::offset(SourceLocation location) const
+{
+    return d_manager.getFileOffset(d_manager.getExpansionLoc(location));
+}
+
+CommentIndex::File const *
+csabase::CommentIndex::file(SourceLocation location) const
+{
+    auto it = d_files.find(
+        d_manager.getFileID(d_manager.getExpansionLoc(location)));
+    return it == d_files.end() ? 0 : &it->second;
+}
+
+CommentIndex::Ranges::const_iterator
+csabase::CommentIndex::first_not_before(Ranges const&  ranges,
+                                        SourceLocation location) const
+{
+    unsigned where = offset(location);
+    return std::lower_bound(ranges.begin(),
+                            ranges.end(),
+                            where,
+                            [this](SourceRange const& r, unsigned o) {
+                                return offset(r.getEnd()) < o;
+                            });
+}
+
+SourceRange csabase::CommentIndex::before(SourceLocation location) const
+{
+    File const *f = file(location);
+    if (f) {
+        unsigned where = offset(location);
+        auto it = std::upper_bound(f->d_blocks.begin(),
+                                   f->d_blocks.end(),
+                                   where,
+                                   [this](unsigned o, SourceRange const& r) {
+                                       return o < offset(r.getEnd());
+                                   });
+        if (it != f->d_blocks.begin()) {
+            return *--it;                                             // RETURN
+        }
+    }
+    return SourceRange();
+}
+
+SourceRange csabase::CommentIndex::after(SourceLocation location) const
+{
+    File const *f = file(location);
+    if (f) {
+        unsigned where = offset(location);
+        auto it = std::lower_bound(f->d_blocks.begin(),
+                                   f->d_blocks.end(),
+                                   where,
+                                   [this](SourceRange const& r, unsigned o) {
+                                       return offset(r.getBegin()) < o;
+                                   });
+        if (it != f->d_blocks.end()) {
+            return *it;                                               // RETURN
+        }
+    }
+    return SourceRange();
+}
+
+std::pair<CommentIndex::Ranges::const_iterator,
+          CommentIndex::Ranges::const_iterator>
+csabase::CommentIndex::within(SourceRange range) const
+{
+    Ranges const& ranges = blocks(
+        d_manager.getFileID(d_manager.getExpansionLoc(range.getBegin())));
+    unsigned begin = offset(range.getBegin());
+    unsigned end   = offset(range.getEnd());
+    auto     first = std::lower_bound(
+        ranges.begin(),
+        ranges.end(),
+        begin,
+        [this](SourceRange const& r, unsigned o) {
+            return offset(r.getBegin()) < o;
+        });
+    auto     last  = std::upper_bound(
+        first,
+        ranges.end(),
+        end,
+        [this](unsigned o, SourceRange const& r) {
+            return o < offset(r.getBegin());
+        });
+    return std::make_pair(first, last);
+}
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
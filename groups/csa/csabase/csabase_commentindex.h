@@ -0,0 +1,123 @@
+// csabase_commentindex.h                                             -*-C++-*-
+
+#ifndef INCLUDED_CSABASE_COMMENTINDEX
+#define INCLUDED_CSABASE_COMMENTINDEX
+
+#include <clang/Basic/SourceLocation.h>
+#include <llvm/ADT/DenseMap.h>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace clang { class SourceManager; }
+
+// ----------------------------------------------------------------------------
+
+namespace csabase
+{
+class CommentIndex
+    // This class collects the comments of a translation unit, joining
+    // consecutive '//' comments (see 'areConsecutive') into blocks as they
+    // arrive, and keeps the blocks of each file in offset order, so that the
+    // blocks near a location are found by binary search.  The 'Analyser'
+    // builds one index for all the checks that use it.
+{
+  public:
+    typedef std::vector<clang::SourceRange> Ranges;
+
+    explicit CommentIndex(clang::SourceManager& manager);
+        // Create an empty index of comments managed by the specified
+        // 'manager'.
+
+    void add(clang::SourceRange comment);
+        // Add the specified 'comment', which follows all the comments
+        // already added from its file.
+
+    Ranges blocks() const;
+        // Return the comment blocks of all files, in the order in which
+        // their first comments were added.
+
+    std::vector<clang::FileID> const& files() const;
+        // Return the files that have comments, in the order in which their
+        // first comments were added.
+
+    Ranges const& blocks(clang::FileID file) const;
+        // Return the comment blocks of the specified 'file', in order.
+
+    Ranges blocks(clang::FileID                                  file,
+                  std::function<bool(clang::SourceRange)> const& alone)
+                                                                         const;
+        // Return the comment blocks of the specified 'file', in order, as
+        // they are formed when no comment for which the specified 'alone'
+        // returns 'true' is joined to another.
+
+    Ranges::const_iterator first_not_before(Ranges const&         ranges,
+                                            clang::SourceLocation location)
+                                                                         const;
+        // Return the first of the specified 'ranges', which are comments of
+        // one file in order, that does not end before the specified
+        // 'location' in that file.
+
+    clang::SourceRange before(clang::SourceLocation location) const;
+        // Return the last comment block of the file of the specified
+        // 'location' that ends at or before it, or an invalid range if there
+        // is none.
+
+    clang::SourceRange after(clang::SourceLocation location) const;
+        // Return the first comment block of the file of the specified
+        // 'location' that begins at or after it, or an invalid range if
+        // there is none.
+
+    std::pair<Ranges::const_iterator, Ranges::const_iterator>
+    within(clang::SourceRange range) const;
+        // Return the sequence of comment blocks that begin within the
+        // specified 'range' of one file.
+
+  private:
+    struct File
+        // The comments of one file.
+    {
+        Ranges            d_blocks;    // comment blocks
+        Ranges            d_comments;  // individual comments
+        std::vector<bool> d_joined;    // comment is joined to the previous
+    };
+
+    unsigned offset(clang::SourceLocation location) const;
+        // Return the offset of the specified 'location' in its file.
+
+    File const *file(clang::SourceLocation location) const;
+        // Return the comments of the file of the specified 'location', or 0
+        // if it has none.
+
+    clang::SourceManager&                          d_manager;
+    llvm::DenseMap<clang::FileID, File>            d_files;
+    std::vector<clang::FileID>                     d_file_order;
+    std::vector<std::pair<clang::FileID, size_t>>  d_block_order;
+};
+
+// ----------------------------------------------------------------------------
+
+inline
+std::vector<clang::FileID> const& CommentIndex::files() const
+{
+    return d_file_order;
+}
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
@@ -13,6 +13,8 @@
 #include <fstream>   // IWYU pragma: keep
 #include <iostream>  // IWYU pragma: keep
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>   // IWYU pragma: keep
 #include <vector>
@@ -92,10 +94,60 @@ set_status(std::map<std::string, Config::Status>& checks,
 csabase::Config::Config(std::vector<std::string> const& config,
                         CompilerInstance&               compiler)
 : d_toplevel_namespace("BloombergLP")
+, d_load_dirs(load_dirs(compiler))
 , d_all(on)
 , d_manager(compiler.getSourceManager())
 {
-    d_load_dirs.emplace_back(".");
+    for (size_t i = 0; i < config.size(); ++i) {
+        process(config[i]);
+    }
+}
+
+csabase::Config::Config(Config const& prototype, SourceManager& manager)
+: d_toplevel_namespace(prototype.d_toplevel_namespace)
+, d_loadpath(prototype.d_loadpath)
+, d_checks(prototype.d_checks)
+, d_groups(prototype.d_groups)
+, d_values(prototype.d_values)
+, d_suppressions(prototype.d_suppressions)
+, d_load_dirs(prototype.d_load_dirs)
+, d_loaded_files(prototype.d_loaded_files)
+, d_all(prototype.d_all)
+, d_manager(manager)
+{
+}
+
+csabase::Config *csabase::Config::create(
+                                  std::vector<std::string> const& config,
+                                  CompilerInstance&               compiler)
+{
+    std::string key;
+    for (const auto& dir : load_dirs(compiler)) {
+        key += dir + '\n';
+    }
+    key += '\0';
+    for (const auto& line : config) {
+        key += line + '\n';
+    }
+
+    // The prototypes only ever serve as the source of copied settings; their
+    // own source managers are never consulted.
+    static std::mutex mutex;
+    static std::map<std::string, std::unique_ptr<Config>> prototypes;
+
+    std::lock_guard<std::mutex> guard(mutex);
+    std::unique_ptr<Config>& prototype = prototypes[key];
+    if (!prototype) {
+        prototype.reset(new Config(config, compiler));
+    }
+    return new Config(*prototype, compiler.getSourceManager());
+}
+
+std::vector<std::string>
+csabase::Config::load_dirs(CompilerInstance& compiler)
+{
+    std::vector<std::string> dirs;
+    dirs.emplace_back(".");
     for (const auto &f : compiler.getFrontendOpts().Inputs) {
         if (f.isFile()) {
             StringRef file = f.getFile();
@@ -106,15 +158,12 @@ csabase::Config::Config(std::vector<std::string> const& config,
             sys::path::remove_filename(v);
             StringRef path(v.begin(), v.size());
             while (!path.empty()) {
-                d_load_dirs.emplace_back(path);
+                dirs.emplace_back(path);
                 path = sys::path::parent_path(path);
             }
         }
     }
-
-    for (size_t i = 0; i < config.size(); ++i) {
-        process(config[i]);
-    }
+    return dirs;
 }
 
 void
@@ -212,6 +261,7 @@ csabase::Config::process(std::string const& line)
             std::string file;
             while (args >> file) {
                 FileName fn(file);
+                d_suppressed.clear();
                 if (d_suppressions.insert(std::make_pair(tag, fn.name()))
                         .second &&
                     d_groups.count(tag)) {
@@ -234,6 +284,7 @@ csabase::Config::process(std::string const& line)
             while (args >> file) {
                 FileName fn(file);
                 auto p = std::make_pair(tag, fn.name());
+                d_suppressed.clear();
                 if (d_suppressions.erase(p) && d_groups.count(tag)) {
                     for (const auto& group_item : d_groups.find(tag)->second) {
                         process("unsuppress " + group_item + " " + file);
@@ -295,6 +346,7 @@ csabase::Config::load(std::string const& original)
                 << file << "'\n";
             return false;
         }
+        d_loaded_files.push_back(file);
         std::string line;
         while (std::getline(in, line)) {
             while (!line.empty() && line.back() == '\\') {
@@ -329,6 +381,11 @@ std::string const& csabase::Config::toplevel_namespace() const
     return d_toplevel_namespace;
 }
 
+std::vector<std::string> const& csabase::Config::loaded_files() const
+{
+    return d_loaded_files;
+}
+
 std::map<std::string, csabase::Config::Status> const&
 csabase::Config::checks() const
 {
@@ -345,23 +402,18 @@ void csabase::Config::bv_stack_level(
     std::vector<SourceLocation>* stack,
     SourceLocation where) const
 {
-    Location location(d_manager, where);
-    FileName fn(location.file());
     stack->clear();
     stack->push_back(where);
-    if (d_local_bv_pragmas.find(fn.name()) != d_local_bv_pragmas.end()) {
-        const std::vector<BVData>& ls =
-            d_local_bv_pragmas.find(fn.name())->second;
-        for (size_t i = 0; i < ls.size(); ++i) {
-            if (d_manager.isBeforeInTranslationUnit(where, ls[i].where)) {
-                break;
-            }
-            if (ls[i].type == '>') {
-                stack->push_back(ls[i].where);
-            } else if (stack->size() > 1 && ls[i].type == '<') {
-                stack->pop_back();
-            }
+    auto file = d_local_bv_pragmas.find(file_name(where));
+    if (file != d_local_bv_pragmas.end()) {
+        const BVFile& bv = file->second;
+        size_t level = stack->size();
+        for (unsigned scope = bv.scope(bv.position(d_manager, where));
+             scope != 0;
+             scope = bv.d_parent[scope]) {
+            stack->push_back(bv.d_pragmas[bv.d_opener[scope]].where);
         }
+        std::reverse(stack->begin() + level, stack->end());
     }
 }
 
@@ -369,37 +421,14 @@ const std::string& csabase::Config::value(const std::string& key,
                                           SourceLocation where) const
 {
     if (where.isValid()) {
-        Location location(d_manager, where);
-        FileName fn(location.file());
-        if (d_local_bv_pragmas.find(fn.name()) != d_local_bv_pragmas.end()) {
-            const std::vector<BVData>& ls =
-                d_local_bv_pragmas.find(fn.name())->second;
-            // Find the pragma stack of the diagnostic location.
-            std::vector<SourceLocation> stack;
-            bv_stack_level(&stack, where);
-            const std::string *found = 0;
-            // Look for a set pragma before the diagnostic location, only
-            // within the pragma stack for that location.
-            std::vector<SourceLocation> pragma_stack(1, where);
-            for (size_t i = 0; i < ls.size(); ++i) {
-                if (d_manager.isBeforeInTranslationUnit(where, ls[i].where)) {
-                    break;
-                }
-                if (ls[i].type == '>') {
-                    pragma_stack.push_back(ls[i].where);
-                } else if (pragma_stack.size() > 1 && ls[i].type == '<') {
-                    pragma_stack.pop_back();
-                } else if (   ls[i].type == '='
-                           && ls[i].s1 == key
-                           && pragma_stack.size() <= stack.size()
-                           && pragma_stack.back() ==
-                              stack[pragma_stack.size() - 1]) {
-                    found = &ls[i].s2;
-                }
-            }
-
-            if (found) {
-                return *found;                                        // RETURN
+        auto file = d_local_bv_pragmas.find(file_name(where));
+        if (file != d_local_bv_pragmas.end()) {
+            // Look for a set pragma before the location, only within the
+            // pragma stack for that location.
+            const BVFile& bv = file->second;
+            int found = bv.find(bv.position(d_manager, where), '=', key);
+            if (found >= 0) {
+                return bv.d_pragmas[found].s2;                        // RETURN
             }
         }
     }
@@ -433,61 +462,140 @@ bool glob_match(StringRef name, StringRef pattern)
 }
 }
 
+csabase::Config::BVFile::BVFile()
+: d_parent(1, 0)
+, d_opener(1, 0)
+, d_members(1)
+{
+}
+
+void csabase::Config::BVFile::add(BVData const& pragma)
+{
+    unsigned index = d_pragmas.size();
+    unsigned current = scope(index);
+    d_pragmas.push_back(pragma);
+    if (pragma.type == '>') {
+        current = d_parent.size();
+        d_parent.push_back(scope(index));
+        d_opener.push_back(index);
+        d_members.emplace_back();
+    } else if (pragma.type == '<') {
+        current = d_parent[current];
+    } else {
+        d_members[current].push_back(index);
+    }
+    d_scope.push_back(current);
+}
+
+unsigned csabase::Config::BVFile::position(SourceManager const& manager,
+                                           SourceLocation       where) const
+{
+    return std::upper_bound(d_pragmas.begin(),
+                            d_pragmas.end(),
+                            where,
+                            [&](SourceLocation loc, BVData const& pragma) {
+                                return manager.isBeforeInTranslationUnit(
+                                    loc, pragma.where);
+                            }) -
+           d_pragmas.begin();
+}
+
+unsigned csabase::Config::BVFile::scope(unsigned position) const
+{
+    return position == 0 ? 0 : d_scope[position - 1];
+}
+
+int csabase::Config::BVFile::find(unsigned           position,
+                                  char               type,
+                                  std::string const& key) const
+{
+    auto cached = d_found.insert(
+        std::make_pair(std::make_pair(position, type + key), -1));
+    int& found = cached.first->second;
+    if (!cached.second) {
+        return found;                                                 // RETURN
+    }
+
+    // Each enclosing scope contributes its last matching pragma before
+    // 'position'; the latest of those is the one in effect.
+    for (unsigned scope = this->scope(position);; scope = d_parent[scope]) {
+        const std::vector<unsigned>& members = d_members[scope];
+        for (auto i = std::lower_bound(members.begin(), members.end(),
+                                       position);
+             i != members.begin() && int(*(i - 1)) > found;
+             --i) {
+            const BVData& pragma = d_pragmas[*(i - 1)];
+            if (type == '='
+                    ? pragma.type == '=' && pragma.s1 == key
+                    : pragma.type != '=' && glob_match(key, pragma.s1)) {
+                found = *(i - 1);
+                break;
+            }
+        }
+        if (scope == 0) {
+            break;
+        }
+    }
+    return found;
+}
+
+const std::string& csabase::Config::file_name(SourceLocation where) const
+{
+    // Without '#line' directives, the name reported for a location depends
+    // only on the file into which it is expanded.
+    FileID fid = d_manager.getFileID(d_manager.getExpansionLoc(where));
+    bool invalid = false;
+    const SrcMgr::SLocEntry& entry = d_manager.getSLocEntry(fid, &invalid);
+    if (invalid || !entry.isFile() || !entry.getFile().hasLineDirectives()) {
+        auto i = d_file_names.find(fid);
+        if (i == d_file_names.end()) {
+            FileName fn(Location(d_manager, where).file());
+            i = d_file_names.insert(std::make_pair(fid, fn.name())).first;
+        }
+        return i->second;                                             // RETURN
+    }
+    static thread_local std::string name;
+    name = FileName(Location(d_manager, where).file()).name();
+    return name;
+}
+
 bool csabase::Config::suppressed(const std::string& tag,
                                  SourceLocation where) const
 {
-    Location location(d_manager, where);
-    FileName fn(location.file());
+    const std::string& name = file_name(where);
 
-    if (d_local_bv_pragmas.find(fn.name()) != d_local_bv_pragmas.end()) {
-        const std::vector<BVData>& ls =
-            d_local_bv_pragmas.find(fn.name())->second;
-        std::vector<SourceLocation> stack;
-        bv_stack_level(&stack, where);
-        char found = 0;
+    auto file = d_local_bv_pragmas.find(name);
+    if (file != d_local_bv_pragmas.end()) {
         // Look for a tag pragma before the diagnostic location, only within
         // the pragma stack for that location.
-        std::vector<SourceLocation> pragma_stack(1, where);
-        for (size_t i = 0; i < ls.size(); ++i) {
-            if (d_manager.isBeforeInTranslationUnit(where, ls[i].where)) {
-                break;
-            }
-            if (ls[i].type == '>') {
-                pragma_stack.push_back(ls[i].where);
-            } else if (pragma_stack.size() > 1 && ls[i].type == '<') {
-                pragma_stack.pop_back();
-            } else if (   (ls[i].type == '-' || ls[i].type == '+')
-                       && pragma_stack.size() <= stack.size()
-                       && pragma_stack.back() == stack[pragma_stack.size() - 1]
-                       && glob_match(tag, ls[i].s1)) {
-                found = ls[i].type;
-            }
-        }
-        if (found) {
-            return found == '-';                                      // RETURN
+        const BVFile& bv = file->second;
+        int found = bv.find(bv.position(d_manager, where), '-', tag);
+        if (found >= 0) {
+            return bv.d_pragmas[found].type == '-';                   // RETURN
         }
     }
 
-    for (const auto &sup : d_suppressions) {
-        if (glob_match(tag, sup.first) && glob_match(fn.name(), sup.second)) {
-            return true;
+    auto cached = d_suppressed.insert(
+        std::make_pair(std::make_pair(tag, name), false));
+    if (cached.second) {
+        for (const auto &sup : d_suppressions) {
+            if (glob_match(tag, sup.first) && glob_match(name, sup.second)) {
+                cached.first->second = true;
+                break;
+            }
         }
     }
-    return false;
+    return cached.first->second;
 }
 
 void csabase::Config::push_suppress(SourceLocation where)
 {
-    Location location(d_manager, where);
-    FileName fn(location.file());
-    d_local_bv_pragmas[fn.name()].push_back(BVData(where, '>'));
+    d_local_bv_pragmas[file_name(where)].add(BVData(where, '>'));
 }
 
 void csabase::Config::pop_suppress(SourceLocation where)
 {
-    Location location(d_manager, where);
-    FileName fn(location.file());
-    d_local_bv_pragmas[fn.name()].push_back(BVData(where, '<'));
+    d_local_bv_pragmas[file_name(where)].add(BVData(where, '<'));
 }
 
 void csabase::Config::suppress(const std::string& tag,
@@ -496,10 +604,8 @@ void csabase::Config::suppress(const std::string& tag,
                                std::set<std::string> in_progress)
 {
     if (!in_progress.count(tag)) {
-        Location location(d_manager, where);
-        FileName fn(location.file());
-        d_local_bv_pragmas[fn.name()]
-            .push_back(BVData(where, on ? '-' : '+', tag));
+        d_local_bv_pragmas[file_name(where)]
+            .add(BVData(where, on ? '-' : '+', tag));
         if (d_groups.find(tag) != d_groups.end()) {
             in_progress.insert(tag);
             const std::vector<std::string>& group_items =
@@ -515,20 +621,18 @@ void csabase::Config::set_bv_value(SourceLocation where,
                                    const std::string& variable,
                                    const std::string& value)
 {
-    Location location(d_manager, where);
-    FileName fn(location.file());
-    d_local_bv_pragmas[fn.name()]
-        .push_back(BVData(where, '=', variable, value));
+    d_local_bv_pragmas[file_name(where)]
+        .add(BVData(where, '=', variable, value));
 }
 
 void csabase::Config::check_bv_stack(Analyser& analyser) const
 {
-    for (std::map<std::string, std::vector<BVData> >::const_iterator
+    for (std::map<std::string, BVFile>::const_iterator
              b = d_local_bv_pragmas.begin(),
              e = d_local_bv_pragmas.end();
          b != e;
          ++b) {
-        const std::vector<BVData>& ls = b->second;
+        const std::vector<BVData>& ls = b->second.d_pragmas;
         std::vector<int> local_stack;
         for (size_t i = 0; i < ls.size(); ++i) {
             if (ls[i].type == '>') {
@@ -33,6 +33,19 @@ public:
         // Create a 'Config' object initialized with the set of specified
         // 'config' lines, using the specified 'compiler'.
 
+    Config(Config const& prototype, clang::SourceManager& manager);
+        // Create a 'Config' object holding the configuration settings of the
+        // specified 'prototype' but none of its local pragma state, using the
+        // specified 'manager'.
+
+    static Config *create(std::vector<std::string> const& config,
+                          clang::CompilerInstance&        compiler);
+        // Return a new 'Config' object initialized with the set of specified
+        // 'config' lines, using the specified 'compiler'.  The lines (and any
+        // files they load) are parsed only once per process for each distinct
+        // set of lines and load directories; later requests copy the result
+        // of that parse.  This function is thread-safe.
+
     bool load(std::string const& file);
         // Read a set of configuration lines from the specified 'file'.
         // Return 'true' iff the 'file' could be read.
@@ -41,6 +54,8 @@ public:
         // Append the specifed 'line' to the configuration.
 
     std::string const& toplevel_namespace() const;
+    std::vector<std::string> const& loaded_files() const;
+        // Return the names of the configuration files that were read.
 
     std::map<std::string, Status> const& checks() const;
 
@@ -88,6 +103,12 @@ public:
     void check_bv_stack(Analyser& analyser) const;
         // Verify that the csabase pragmas form a proper stack.
 
+    static std::vector<std::string> load_dirs(
+                                            clang::CompilerInstance& compiler);
+        // Return the directories, in search order, from which configuration
+        // files named without path components are loaded for the inputs of
+        // the specified 'compiler'.
+
     static std::vector<std::string> brace_expand(const std::string& s);
         // Brace-expand the specified string 's' (as done by ksh) and return
         // the vector of expanded strings.  E.g.,
@@ -97,6 +118,10 @@ public:
         // bde_comp_fooutil.h bde_comp_fooutil.cpp bde_comp_fooutil.t.cpp
 
 private:
+    std::string const& file_name(clang::SourceLocation where) const;
+        // Return the name, without directories, of the file containing the
+        // specified location 'where', as reported for diagnostics.
+
     std::string                                     d_toplevel_namespace;
     std::set<std::string>                           d_loadpath;
     std::map<std::string, Status>                   d_checks;
@@ -104,6 +129,7 @@ private:
     std::map<std::string, std::string>              d_values;
     std::set<std::pair<std::string, std::string>>   d_suppressions;
     std::vector<std::string>                        d_load_dirs;
+    std::vector<std::string>                        d_loaded_files;
 
     struct BVData
     {
@@ -121,7 +147,47 @@ private:
         }
     };
 
-    std::map<std::string, std::vector<BVData> >      d_local_bv_pragmas;
+    struct BVFile
+        // The pragmas of one file in translation unit order, with the nesting
+        // of push/pop scopes resolved as each pragma is added, so that the
+        // pragmas in effect at a location are found by binary search rather
+        // than by replaying the file.  Scope 0 is the file itself.
+    {
+        std::vector<BVData>                d_pragmas;
+        std::vector<unsigned>              d_scope;    // scope after pragma
+        std::vector<unsigned>              d_parent;   // enclosing scope
+        std::vector<unsigned>              d_opener;   // pragma opening scope
+        std::vector<std::vector<unsigned>> d_members;  // tag/value pragmas
+        mutable std::map<std::pair<unsigned, std::string>, int>
+                                           d_found;    // lookup cache
+
+        BVFile();
+
+        void add(BVData const& pragma);
+            // Append the specified 'pragma', which must not precede any
+            // pragma already added.
+
+        unsigned position(clang::SourceManager const& manager,
+                          clang::SourceLocation       where) const;
+            // Return the number of pragmas that do not follow the specified
+            // location 'where'.
+
+        unsigned scope(unsigned position) const;
+            // Return the scope in effect after the specified 'position'
+            // pragmas.
+
+        int find(unsigned position, char type, std::string const& key) const;
+            // Return the index of the last of the first specified 'position'
+            // pragmas that is of the specified 'type' class ('=' for values,
+            // '-' for tags), whose argument matches the specified 'key', and
+            // that lies within the scope in effect at 'position' or one
+            // enclosing it, or -1 if there is no such pragma.
+    };
+
+    std::map<std::string, BVFile>                    d_local_bv_pragmas;
+    mutable std::map<clang::FileID, std::string>     d_file_names;
+    mutable std::map<std::pair<std::string, std::string>, bool>
+                                                     d_suppressed;
     Status                                           d_all;
     clang::SourceManager&                            d_manager;
 };
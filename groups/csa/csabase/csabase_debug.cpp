@@ -1,14 +1,126 @@
 // csabase_debug.cpp                                                  -*-C++-*-
 
 #include <csabase_debug.h>
+#include <llvm/Support/Signals.h>
 #include <llvm/Support/raw_ostream.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <unistd.h>
 
 // -----------------------------------------------------------------------------
 
 namespace
 {
-    unsigned int level(0);
-    bool         do_debug(false);
+    thread_local unsigned int level(0);  // per thread, for batch mode
+    std::atomic<size_t>       ring_size(0);
+    std::once_flag            ring_once;
+
+    struct Event
+        // A recorded message, formatted as it is to be written.
+    {
+        std::string d_line;  // indentation, kind of message, and message
+    };
+
+    thread_local std::vector<Event> ring;         // recorded messages
+    thread_local size_t             ring_next(0); // next slot, once full
+    thread_local size_t             ring_total(0);// messages ever recorded
+    thread_local std::string        note_text;    // text of a pending note
+    thread_local unsigned int       note_depth(0);// level of a pending note
+
+    void record(unsigned int depth, char const* mark, llvm::StringRef text)
+        // Record a message with the specified 'depth', 'mark', and 'text' in
+        // the ring buffer of this thread, overwriting the oldest if it is
+        // full.
+    {
+        size_t size = ring_size.load(std::memory_order_relaxed);
+        Event *e;
+        if (ring.size() < size) {
+            ring.emplace_back();
+            e = &ring.back();
+        }
+        else {
+            e = &ring[ring_next];
+            ring_next = (ring_next + 1) % size;
+        }
+        // Format the message now, so that it can be written from a signal
+        // handler, which must not allocate.
+        e->d_line.assign(depth, ' ');
+        e->d_line.append(mark);
+        e->d_line.append(text.data(), text.size());
+        if (text.empty() || text.back() != '\n') {
+            e->d_line.push_back('\n');
+        }
+        ++ring_total;
+    }
+
+    size_t first_event()
+        // Return the index in 'ring' of the oldest recorded message.
+    {
+        return ring.size() < ring_size.load(std::memory_order_relaxed)
+                   ? 0
+                   : ring_next;
+    }
+
+    void flush_note()
+        // Record the text written since the last message as a note.
+    {
+        if (!note_text.empty()) {
+            record(note_depth, "| ", note_text);
+            note_text.clear();
+        }
+    }
+
+    class note_stream : public llvm::raw_ostream
+        // A stream collecting the text of a note for the ring buffer.
+    {
+        void write_impl(const char *ptr, size_t size) override
+        {
+            note_text.append(ptr, size);
+        }
+
+        uint64_t current_pos() const override
+        {
+            return note_text.size();
+        }
+
+      public:
+        note_stream()
+        : llvm::raw_ostream(true)
+        {
+        }
+    };
+
+    void write_stderr(char const *data, size_t size)
+        // Write the specified 'size' bytes at the specified 'data' to the
+        // standard error, using only async-signal-safe calls.
+    {
+        while (size > 0) {
+            ssize_t n = ::write(2, data, size);
+            if (n <= 0) {
+                return;                                               // RETURN
+            }
+            data += n;
+            size -= n;
+        }
+    }
+
+    void dump_on_crash(void *)
+        // Write the messages recorded by the crashing thread.  Only what was
+        // formatted when the messages were recorded is written, without
+        // allocating or using streams.
+    {
+        static const char header[] = "bde_verify debug: last messages\n";
+        if (ring.empty()) {
+            return;                                                   // RETURN
+        }
+        write_stderr(header, sizeof header - 1);
+        size_t first = first_event();
+        for (size_t i = 0; i < ring.size(); ++i) {
+            const std::string& line = ring[(first + i) % ring.size()].d_line;
+            write_stderr(line.data(), line.size());
+        }
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -28,34 +140,69 @@ namespace
 
 // -----------------------------------------------------------------------------
 
+bool csabase::Debug::enabled_(false);
+
 void csabase::Debug::set_debug(bool value)
 {
-    do_debug = value;
+    enabled_ = value;
 }
 
-bool csabase::Debug::get_debug()
+void csabase::Debug::set_ring(size_t size)
 {
-    return do_debug;
+    // Each analysis thread in batch mode parses the plugin arguments; the
+    // first to get here configures the process for all of them.
+    std::call_once(ring_once, [size] {
+        if (size) {
+            llvm::sys::AddSignalHandler(dump_on_crash, 0);
+        }
+        ring_size.store(size, std::memory_order_relaxed);
+    });
+    ring.clear();
+    ring_next = 0;
+    ring_total = 0;
+}
+
+void csabase::Debug::dump_ring(llvm::raw_ostream& out)
+{
+    flush_note();
+    if (ring.empty()) {
+        return;                                                       // RETURN
+    }
+    out << "bde_verify debug: last " << ring.size() << " of " << ring_total
+        << " messages\n";
+    size_t first = first_event();
+    for (size_t i = 0; i < ring.size(); ++i) {
+        out << ring[(first + i) % ring.size()].d_line;
+    }
+    ring.clear();
+    ring_next = 0;
+    ring_total = 0;
 }
 
 // -----------------------------------------------------------------------------
 
-csabase::Debug::Debug(char const* message, bool nest)
-: message_(message)
-, nest_(nest)
+void csabase::Debug::open()
 {
-    if (do_debug)
-    {
+    if (ring_size.load(std::memory_order_relaxed)) {
+        flush_note();
+        record(level, nest_ ? "\\ " : "| ",
+               std::string("'") + message_ + "'");
+    }
+    else {
         start(level) << (nest_ ? "\\ " : "| ") << "'" << message_ << "'\n";
-        level += nest;
     }
+    level += nest_;
 }
 
-csabase::Debug::~Debug()
+void csabase::Debug::close()
 {
-    if (do_debug && nest_)
-    {
-        start(level -= nest_) << (nest_ ? "/ " : "| ") << message_ << "\n";
+    level -= nest_;
+    if (ring_size.load(std::memory_order_relaxed)) {
+        flush_note();
+        record(level, "/ ", message_);
+    }
+    else {
+        start(level) << "/ " << message_ << "\n";
     }
 }
 
@@ -68,7 +215,16 @@ namespace
 
 llvm::raw_ostream& csabase::Debug::indent() const
 {
-    return do_debug ? start(level) << "| ": dummy_stream;
+    if (!enabled_) {
+        return dummy_stream;                                          // RETURN
+    }
+    if (ring_size.load(std::memory_order_relaxed)) {
+        static thread_local note_stream notes;
+        flush_note();
+        note_depth = level;
+        return notes;                                                 // RETURN
+    }
+    return start(level) << "| ";
 }
 
 // ----------------------------------------------------------------------------
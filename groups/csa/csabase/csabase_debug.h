@@ -4,7 +4,9 @@
 #define INCLUDED_CSABASE_DEBUG
 
 #include <llvm/Support/raw_ostream.h>
+#include <stddef.h>
 #include <stdio.h>
+#include <string>
 
 // -----------------------------------------------------------------------------
 
@@ -15,12 +17,35 @@ namespace csabase
 {
 
 class Debug
+    // Trace the progress of the checks while debugging is on, either writing
+    // nested messages to the standard error as they are made, or recording
+    // the latest ones in a per-thread ring buffer that is written out on
+    // request or if the program crashes.  Nothing is formatted while
+    // debugging is off.
 {
 public:
     static void set_debug(bool);
     static bool get_debug();
 
+    static void set_ring(size_t size);
+        // Record the last 'size' messages of each thread instead of writing
+        // them out, or, if 'size' is 0, write messages as they are made.
+        // The size is set, and the crash handler installed, only by the
+        // first call in the process; later calls, such as those of other
+        // threads in batch mode, only discard the messages recorded by the
+        // calling thread.
+
+    static void dump_ring(llvm::raw_ostream& out);
+        // Write the messages recorded by this thread to the specified 'out'
+        // and discard them.
+
     Debug(char const*, bool nest = true);
+    template <typename Message>
+    Debug(Message const& message,
+          bool           nest = true,
+          decltype(message()) * = 0);
+        // Trace the string returned by the specified 'message' functor,
+        // which is called only if debugging is on.
     ~Debug();
     template <typename T> llvm::raw_ostream& operator<< (T const& value) const;
 
@@ -28,13 +53,54 @@ private:
     Debug(Debug const&);
     void operator= (Debug const&);
     llvm::raw_ostream& indent() const;
+    void open();
+    void close();
 
+    static bool  enabled_;
     char const*  message_;
     unsigned int nest_;
+    std::string  text_;
 };
 
 // -----------------------------------------------------------------------------
 
+inline
+bool Debug::get_debug()
+{
+    return enabled_;
+}
+
+inline
+Debug::Debug(char const* message, bool nest)
+: message_(message)
+, nest_(nest)
+{
+    if (enabled_) {
+        open();
+    }
+}
+
+template <typename Message>
+inline
+Debug::Debug(Message const& message, bool nest, decltype(message()) *)
+: message_("")
+, nest_(nest)
+{
+    if (enabled_) {
+        text_ = message();
+        message_ = text_.c_str();
+        open();
+    }
+}
+
+inline
+Debug::~Debug()
+{
+    if (enabled_ && nest_) {
+        close();
+    }
+}
+
 template <typename T>
 inline
 llvm::raw_ostream& Debug::operator<<(T const& value) const
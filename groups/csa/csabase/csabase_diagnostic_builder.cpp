@@ -3,6 +3,10 @@
 
 bool csabase::diagnostic_builder::failed_;
 
+csabase::diagnostic_builder::recorder::~recorder()
+{
+}
+
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
 //
@@ -5,6 +5,9 @@
 
 #include <csabase_debug.h>
 #include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/SourceLocation.h>
+#include <llvm/ADT/StringRef.h>
+#include <string>
 
 // -----------------------------------------------------------------------------
 
@@ -13,6 +16,19 @@ namespace csabase
 class diagnostic_builder
 {
   public:
+    class recorder
+        // Protocol for observing the arguments given to a diagnostic, whether
+        // or not it is emitted.
+    {
+      public:
+        virtual ~recorder();
+        virtual void argument(int value) = 0;
+        virtual void argument(llvm::StringRef value) = 0;
+        virtual void argument(clang::SourceRange value) = 0;
+        virtual void other_argument() = 0;
+            // Note an argument of a type not covered by the other functions.
+    };
+
     diagnostic_builder();
     diagnostic_builder(clang::DiagnosticBuilder other, bool always = true);
     diagnostic_builder& operator<<(long long argument);
@@ -20,12 +36,27 @@ class diagnostic_builder
     template <typename T>
     diagnostic_builder& operator<<(T const& argument);
 
+    diagnostic_builder& record(recorder *observer);
+        // Send the subsequent arguments of this diagnostic to the specified
+        // 'observer', if it is not null.
+
     static bool failed();
     static void failed(bool status);
 
   private:
+    void note(int argument);
+    void note(unsigned argument);
+    void note(const char *argument);
+    void note(std::string const& argument);
+    void note(llvm::StringRef argument);
+    void note(clang::SourceRange argument);
+    template <typename T>
+    void note(T const& argument);
+        // Pass the specified 'argument' to the recorder.
+
     bool empty_;
     clang::DiagnosticBuilder builder_;
+    recorder *recorder_;
     static bool failed_;
 };
 
@@ -43,13 +74,13 @@ void diagnostic_builder::failed(bool status)
 
 inline
 diagnostic_builder::diagnostic_builder()
-: empty_(true), builder_(clang::DiagnosticBuilder::getEmpty())
+: empty_(true), builder_(clang::DiagnosticBuilder::getEmpty()), recorder_(0)
 {
 }
 
 inline diagnostic_builder::diagnostic_builder(clang::DiagnosticBuilder other,
                                               bool                     always)
-: empty_(false), builder_(other)
+: empty_(false), builder_(other), recorder_(0)
 {
     if (always) {
         builder_.setForceEmit();
@@ -72,11 +103,64 @@ template <typename T>
 inline
 diagnostic_builder& diagnostic_builder::operator<<(T const& argument)
 {
+    if (recorder_) {
+        note(argument);
+    }
     if (!empty_) {
         builder_ << argument;
     }
     return *this;
 }
+
+inline
+diagnostic_builder& diagnostic_builder::record(recorder *observer)
+{
+    recorder_ = observer;
+    return *this;
+}
+
+inline
+void diagnostic_builder::note(int argument)
+{
+    recorder_->argument(argument);
+}
+
+inline
+void diagnostic_builder::note(unsigned argument)
+{
+    recorder_->argument(static_cast<int>(argument));
+}
+
+inline
+void diagnostic_builder::note(const char *argument)
+{
+    recorder_->argument(llvm::StringRef(argument));
+}
+
+inline
+void diagnostic_builder::note(std::string const& argument)
+{
+    recorder_->argument(llvm::StringRef(argument));
+}
+
+inline
+void diagnostic_builder::note(llvm::StringRef argument)
+{
+    recorder_->argument(argument);
+}
+
+inline
+void diagnostic_builder::note(clang::SourceRange argument)
+{
+    recorder_->argument(argument);
+}
+
+template <typename T>
+inline
+void diagnostic_builder::note(T const&)
+{
+    recorder_->other_argument();
+}
 }
 
 #endif
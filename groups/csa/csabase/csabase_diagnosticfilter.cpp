@@ -13,6 +13,7 @@
 // IWYU pragma: no_include <clang/Basic/DiagnosticLexKinds.inc>
 #include <llvm/Support/Regex.h>
 #include <llvm/Support/raw_ostream.h>
+#include <mutex>
 #include <string>
 
 namespace clang { class LangOptions; }
@@ -29,49 +30,72 @@ static std::string const check_name("diagnostic-filter");
 
 // ----------------------------------------------------------------------------
 
-std::set<unsigned> csabase::DiagnosticFilter::s_fail_ids;
+thread_local std::set<unsigned> csabase::DiagnosticFilter::s_fail_ids;
+thread_local raw_ostream *csabase::DiagnosticFilter::s_output;
 std::map<std::string, std::set<unsigned>>
     csabase::DiagnosticFilter::s_diff_lines;
 
+raw_ostream& csabase::DiagnosticFilter::output()
+{
+    return s_output ? *s_output : errs();
+}
+
+void csabase::DiagnosticFilter::set_output(raw_ostream *stream)
+{
+    s_output = stream;
+}
+
 csabase::DiagnosticFilter::DiagnosticFilter(Analyser const&    analyser,
                                             std::string        diagnose,
                                             DiagnosticOptions& options)
-: TextDiagnosticPrinter(errs(), &options)
+: TextDiagnosticPrinter(output(), &options)
 , d_analyser(&analyser)
 , d_diagnose(diagnose)
 , d_prev_handle(false)
+, d_show_counts(options.ShowCarets)
 {
-    std::string diff = analyser.diff_file();
-    int fd = 0;
-    if (diff == "-" || !sys::fs::openFileForRead(diff, fd)) {
-        if (auto mb = MemoryBuffer::getOpenFile(fd, diff, -1)) {
-            s_diff_lines[""].insert(0);  // Force s_diff_files.size() > 0.
-            StringRef diffs((*mb)->getBufferStart(), (*mb)->getBufferSize());
-            Regex file("^[+][+][+] +.*/([^[:space:]]+)", Regex::Newline);
-            Regex lines("^@+[- 0-9,]*[+]([0-9,]+) *@", Regex::Newline);
-            SmallVector<StringRef, 3> matches;
-            std::string filename;
-            while (diffs.size() != 0) {
-                auto p = diffs.split('\n');
-                if (file.match(p.first, &matches)) {
-                    filename = matches[1];
-                }
-                else if (lines.match(p.first, &matches)) {
-                    auto lc = matches[1].split(',');
-                    unsigned line;
-                    lc.first.getAsInteger(10, line);
-                    unsigned count = 1;
-                    if (lc.second.size()) {
-                        lc.second.getAsInteger(10, count);
+    // Custom diagnostic ids are allocated per translation unit, so failure
+    // ids from a previous translation unit on this thread are meaningless.
+    s_fail_ids.clear();
+
+    // The diff is the same for every translation unit in the process (and
+    // may be standard input), so read it only once.
+    static std::once_flag diff_read;
+    std::call_once(diff_read, [&] {
+        std::string diff = analyser.diff_file();
+        int fd = 0;
+        if (diff == "-" || !sys::fs::openFileForRead(diff, fd)) {
+            if (auto mb = MemoryBuffer::getOpenFile(fd, diff, -1)) {
+                // Force s_diff_files.size() > 0.
+                s_diff_lines[""].insert(0);
+                StringRef diffs((*mb)->getBufferStart(),
+                                (*mb)->getBufferSize());
+                Regex file("^[+][+][+] +.*/([^[:space:]]+)", Regex::Newline);
+                Regex lines("^@+[- 0-9,]*[+]([0-9,]+) *@", Regex::Newline);
+                SmallVector<StringRef, 3> matches;
+                std::string filename;
+                while (diffs.size() != 0) {
+                    auto p = diffs.split('\n');
+                    if (file.match(p.first, &matches)) {
+                        filename = matches[1];
                     }
-                    while (count > 0) {
-                        s_diff_lines[filename].insert(line + --count);
+                    else if (lines.match(p.first, &matches)) {
+                        auto lc = matches[1].split(',');
+                        unsigned line;
+                        lc.first.getAsInteger(10, line);
+                        unsigned count = 1;
+                        if (lc.second.size()) {
+                            lc.second.getAsInteger(10, count);
+                        }
+                        while (count > 0) {
+                            s_diff_lines[filename].insert(line + --count);
+                        }
                     }
+                    diffs = p.second;
                 }
-                diffs = p.second;
             }
         }
-    }
+    });
 }
 
 // ----------------------------------------------------------------------------
@@ -139,6 +163,31 @@ csabase::DiagnosticFilter::HandleDiagnostic(DiagnosticsEngine::Level level,
     }
 }
 
+void csabase::DiagnosticFilter::finish()
+{
+    if (s_output) {
+        unsigned warnings = getNumWarnings();
+        unsigned errors   = getNumErrors();
+        if (d_show_counts && (warnings || errors)) {
+            // The same text as 'CompilerInstance::ExecuteAction'.
+            if (warnings) {
+                output() << warnings << " warning"
+                         << (warnings == 1 ? "" : "s");
+            }
+            if (warnings && errors) {
+                output() << " and ";
+            }
+            if (errors) {
+                output() << errors << " error" << (errors == 1 ? "" : "s");
+            }
+            output() << " generated.\n";
+        }
+        // With no counts left, 'CompilerInstance' writes nothing.
+        clear();
+    }
+    TextDiagnosticPrinter::finish();
+}
+
 // ----------------------------------------------------------------------------
 
 static void check(Analyser& analyser, const TranslationUnitDecl*)
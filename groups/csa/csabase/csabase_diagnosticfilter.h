@@ -12,6 +12,7 @@
 // ----------------------------------------------------------------------------
 
 namespace clang { class DiagnosticOptions; }
+namespace llvm { class raw_ostream; }
 
 namespace csabase { class Analyser; }
 namespace csabase
@@ -26,14 +27,28 @@ class DiagnosticFilter : public clang::TextDiagnosticPrinter
     void HandleDiagnostic(clang::DiagnosticsEngine::Level level,
                           clang::Diagnostic const&        info) override;
 
+    void finish() override;
+        // In batch mode, write the count of warnings and errors to 'output()'
+        // rather than leave it for 'clang::CompilerInstance', which writes it
+        // to 'llvm::errs()' outside the output of the translation unit.
+
     static void fail_on(unsigned id);
     static bool is_fail(unsigned id);
 
+    static llvm::raw_ostream& output();
+    static void set_output(llvm::raw_ostream *stream);
+        // Get or set the stream to which filters created on the calling
+        // thread write their diagnostics.  A null 'stream' (the default)
+        // means 'llvm::errs()'.  Batch mode uses this to collect the output
+        // of each translation unit separately.
+
   private:
     const Analyser                                    *d_analyser;
     std::string                                        d_diagnose;
     bool                                               d_prev_handle;
-    static std::set<unsigned>                          s_fail_ids;
+    bool                                               d_show_counts;
+    static thread_local std::set<unsigned>             s_fail_ids;
+    static thread_local llvm::raw_ostream             *s_output;
     static std::map<std::string, std::set<unsigned> >  s_diff_lines;
 };
 }
@@ -33,7 +33,8 @@ llvm::StringRef subdir(llvm::StringRef path, llvm::StringRef dir)
 
 }
 
-std::map<std::string, csabase::FileName> csabase::FileName::s_file_names_;
+thread_local std::map<std::string, csabase::FileName>
+    csabase::FileName::s_file_names_;
 
 void csabase::FileName::reset(llvm::StringRef sr)
 {
@@ -87,7 +87,7 @@ private:
     std::string prefix_;
     std::string tag_;
 
-    static std::map<std::string, FileName> s_file_names_;
+    static thread_local std::map<std::string, FileName> s_file_names_;
 };
 }
 
@@ -0,0 +1,826 @@
+// csabase_headerindex.cpp                                            -*-C++-*-
+
+#include <csabase_headerindex.h>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+using namespace csabase;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+const HeaderPair header_pairs[] = {
+    { "bsl_algorithm.h",     "INCLUDED_BSL_ALGORITHM",
+      "algorithm",           "INCLUDED_ALGORITHM"          },
+    { "bsl_bitset.h",        "INCLUDED_BSL_BITSET",
+      "bitset",              "INCLUDED_BITSET"             },
+    { "bsl_cassert.h",       "INCLUDED_BSL_CASSERT",
+      "cassert",             "INCLUDED_CASSERT"            },
+    { "bsl_cctype.h",        "INCLUDED_BSL_CCTYPE",
+      "cctype",              "INCLUDED_CCTYPE"             },
+    { "bsl_cerrno.h",        "INCLUDED_BSL_CERRNO",
+      "cerrno",              "INCLUDED_CERRNO"             },
+    { "bsl_cfloat.h",        "INCLUDED_BSL_CFLOAT",
+      "cfloat",              "INCLUDED_CFLOAT"             },
+    { "bsl_ciso646.h",       "INCLUDED_BSL_CISO646",
+      "ciso646",             "INCLUDED_CISO646"            },
+    { "bsl_climits.h",       "INCLUDED_BSL_CLIMITS",
+      "climits",             "INCLUDED_CLIMITS"            },
+    { "bsl_clocale.h",       "INCLUDED_BSL_CLOCALE",
+      "clocale",             "INCLUDED_CLOCALE"            },
+    { "bsl_cmath.h",         "INCLUDED_BSL_CMATH",
+      "cmath",               "INCLUDED_CMATH"              },
+    { "bsl_complex.h",       "INCLUDED_BSL_COMPLEX",
+      "complex",             "INCLUDED_COMPLEX"            },
+    { "bsl_csetjmp.h",       "INCLUDED_BSL_CSETJMP",
+      "csetjmp",             "INCLUDED_CSETJMP"            },
+    { "bsl_csignal.h",       "INCLUDED_BSL_CSIGNAL",
+      "csignal",             "INCLUDED_CSIGNAL"            },
+    { "bsl_cstdarg.h",       "INCLUDED_BSL_CSTDARG",
+      "cstdarg",             "INCLUDED_CSTDARG"            },
+    { "bsl_cstddef.h",       "INCLUDED_BSL_CSTDDEF",
+      "cstddef",             "INCLUDED_CSTDDEF"            },
+    { "bsl_cstdio.h",        "INCLUDED_BSL_CSTDIO",
+      "cstdio",              "INCLUDED_CSTDIO"             },
+    { "bsl_cstdlib.h",       "INCLUDED_BSL_CSTDLIB",
+      "cstdlib",             "INCLUDED_CSTDLIB"            },
+    { "bsl_cstring.h",       "INCLUDED_BSL_CSTRING",
+      "cstring",             "INCLUDED_CSTRING"            },
+    { "bsl_ctime.h",         "INCLUDED_BSL_CTIME",
+      "ctime",               "INCLUDED_CTIME"              },
+    { "bsl_cwchar.h",        "INCLUDED_BSL_CWCHAR",
+      "cwchar",              "INCLUDED_CWCHAR"             },
+    { "bsl_cwctype.h",       "INCLUDED_BSL_CWCTYPE",
+      "cwctype",             "INCLUDED_CWCTYPE"            },
+    { "bsl_deque.h",         "INCLUDED_BSL_DEQUE",
+      "deque",               "INCLUDED_DEQUE"              },
+    { "bsl_exception.h",     "INCLUDED_BSL_EXCEPTION",
+      "exception",           "INCLUDED_EXCEPTION"          },
+    { "bsl_fstream.h",       "INCLUDED_BSL_FSTREAM",
+      "fstream",             "INCLUDED_FSTREAM"            },
+    { "bsl_functional.h",    "INCLUDED_BSL_FUNCTIONAL",
+      "functional",          "INCLUDED_FUNCTIONAL"         },
+    { "bsl_hash_map.h",      "INCLUDED_BSL_HASH_MAP",
+      "hash_map",            "INCLUDED_HASH_MAP"           },
+    { "bsl_hash_set.h",      "INCLUDED_BSL_HASH_SET",
+      "hash_set",            "INCLUDED_HASH_SET"           },
+    { "bsl_iomanip.h",       "INCLUDED_BSL_IOMANIP",
+      "iomanip",             "INCLUDED_IOMANIP"            },
+    { "bsl_ios.h",           "INCLUDED_BSL_IOS",
+      "ios",                 "INCLUDED_IOS"                },
+    { "bsl_iosfwd.h",        "INCLUDED_BSL_IOSFWD",
+      "iosfwd",              "INCLUDED_IOSFWD"             },
+    { "bsl_iostream.h",      "INCLUDED_BSL_IOSTREAM",
+      "iostream",            "INCLUDED_IOSTREAM"           },
+    { "bsl_istream.h",       "INCLUDED_BSL_ISTREAM",
+      "istream",             "INCLUDED_ISTREAM"            },
+    { "bsl_iterator.h",      "INCLUDED_BSL_ITERATOR",
+      "iterator",            "INCLUDED_ITERATOR"           },
+    { "bsl_limits.h",        "INCLUDED_BSL_LIMITS",
+      "limits",              "INCLUDED_LIMITS"             },
+    { "bsl_list.h",          "INCLUDED_BSL_LIST",
+      "list",                "INCLUDED_LIST"               },
+    { "bsl_locale.h",        "INCLUDED_BSL_LOCALE",
+      "locale",              "INCLUDED_LOCALE"             },
+    { "bsl_map.h",           "INCLUDED_BSL_MAP",
+      "map",                 "INCLUDED_MAP"                },
+    { "bsl_memory.h",        "INCLUDED_BSL_MEMORY",
+      "memory",              "INCLUDED_MEMORY"             },
+    { "bsl_new.h",           "INCLUDED_BSL_NEW",
+      "new",                 "INCLUDED_NEW"                },
+    { "bsl_numeric.h",       "INCLUDED_BSL_NUMERIC",
+      "numeric",             "INCLUDED_NUMERIC"            },
+    { "bsl_ostream.h",       "INCLUDED_BSL_OSTREAM",
+      "ostream",             "INCLUDED_OSTREAM"            },
+    { "bsl_queue.h",         "INCLUDED_BSL_QUEUE",
+      "queue",               "INCLUDED_QUEUE"              },
+    { "bsl_set.h",           "INCLUDED_BSL_SET",
+      "set",                 "INCLUDED_SET"                },
+    { "bsl_slist.h",         "INCLUDED_BSL_SLIST",
+      "slist",               "INCLUDED_SLIST"              },
+    { "bsl_sstream.h",       "INCLUDED_BSL_SSTREAM",
+      "sstream",             "INCLUDED_SSTREAM"            },
+    { "bsl_stack.h",         "INCLUDED_BSL_STACK",
+      "stack",               "INCLUDED_STACK"              },
+    { "bsl_stdexcept.h",     "INCLUDED_BSL_STDEXCEPT",
+      "stdexcept",           "INCLUDED_STDEXCEPT"          },
+    { "bsl_streambuf.h",     "INCLUDED_BSL_STREAMBUF",
+      "streambuf",           "INCLUDED_STREAMBUF"          },
+    { "bsl_string.h",        "INCLUDED_BSL_STRING",
+      "string",              "INCLUDED_STRING"             },
+    { "bsl_strstream.h",     "INCLUDED_BSL_STRSTREAM",
+      "strstream",           "INCLUDED_STRSTREAM"          },
+    { "bsl_typeinfo.h",      "INCLUDED_BSL_TYPEINFO",
+      "typeinfo",            "INCLUDED_TYPEINFO"           },
+    { "bsl_unordered_map.h", "INCLUDED_BSL_UNORDERED_MAP",
+      "unordered_map",       "INCLUDED_UNORDERED_MAP"      },
+    { "bsl_unordered_set.h", "INCLUDED_BSL_UNORDERED_SET",
+      "unordered_set",       "INCLUDED_UNORDERED_SET"      },
+    { "bsl_utility.h",       "INCLUDED_BSL_UTILITY",
+      "utility",             "INCLUDED_UTILITY"            },
+    { "bsl_valarray.h",      "INCLUDED_BSL_VALARRAY",
+      "valarray",            "INCLUDED_VALARRAY"           },
+    { "bsl_vector.h",        "INCLUDED_BSL_VECTOR",
+      "vector",              "INCLUDED_VECTOR"             },
+
+    // bsl_ versions of standard C headers
+
+    { "bsl_cassert.h",      "INCLUDED_BSL_CASSERT",
+      "assert.h",            "_ASSERT_H"                   },
+    { "bsl_cctype.h",       "INCLUDED_BSL_CCTYPE",
+      "ctype.h",             "_CTYPE_H"                    },
+    { "bsl_cerrno.h",       "INCLUDED_BSL_CERRNO",
+      "errno.h",             "_ERRNO_H"                    },
+    { "bsl_cfloat.h",       "INCLUDED_BSL_CFLOAT",
+      "float.h",             "_FLOAT_H"                    },
+    { "bsl_ciso646.h",      "INCLUDED_BSL_CISO646",
+      "iso646.h",            "_ISO646_H"                   },
+    { "bsl_climits.h",      "INCLUDED_BSL_CLIMITS",
+      "limits.h",            "_LIBC_LIMITS_H_"             },
+    { "bsl_clocale.h",      "INCLUDED_BSL_CLOCALE",
+      "locale.h",            "_LOCALE_H"                   },
+    { "bsl_cmath.h",        "INCLUDED_BSL_CMATH",
+      "math.h",              "_MATH_H"                     },
+    { "bsl_csetjmp.h",      "INCLUDED_BSL_CSETJMP",
+      "setjmp.h",            "_SETJMP_H"                   },
+    { "bsl_csignal.h",      "INCLUDED_BSL_CSIGNAL",
+      "signal.h",            "_SIGNAL_H"                   },
+    { "bsl_cstdarg.h",      "INCLUDED_BSL_CSTDARG",
+      "stdarg.h",            "_STDARG_H"                   },
+    { "bsl_cstddef.h",      "INCLUDED_BSL_CSTDDEF",
+      "stddef.h",            "_STDDEF_H"                   },
+    { "bsl_cstdio.h",       "INCLUDED_BSL_CSTDIO",
+      "stdio.h",             "_STDIO_H"                    },
+    { "bsl_cstdlib.h",      "INCLUDED_BSL_CSTDLIB",
+      "stdlib.h",            "_STDLIB_H"                   },
+    { "bsl_cstring.h",      "INCLUDED_BSL_CSTRING",
+      "string.h",            "_STRING_H"                   },
+    { "bsl_c_sys_time.h",    "INCLUDED_BSL_C_SYS_TIME",
+      "sys/time.h",          "_SYS_TIME_H"                 },
+    { "bsl_ctime.h",        "INCLUDED_BSL_CTIME",
+      "time.h",              "_TIME_H"                     },
+    { "bsl_cwchar.h",       "INCLUDED_BSL_CWCHAR",
+      "wchar.h",             "_WCHAR_H"                    },
+    { "bsl_cwctype.h",      "INCLUDED_BSL_CWCTYPE",
+      "wctype.h",            "_WCTYPE_H"                   },
+
+    { "bsl_c_assert.h",     "INCLUDED_BSL_C_ASSERT",
+      "bsl_cassert.h",      "INCLUDED_BSL_CASSERT"         },
+    { "bsl_c_ctype.h",      "INCLUDED_BSL_C_CTYPE",
+      "bsl_cctype.h",       "INCLUDED_BSL_CCTYPE"          },
+    { "bsl_c_errno.h",      "INCLUDED_BSL_C_ERRNO",
+      "bsl_cerrno.h",       "INCLUDED_BSL_CERRNO"          },
+    { "bsl_c_float.h",      "INCLUDED_BSL_C_FLOAT",
+      "bsl_cfloat.h",       "INCLUDED_BSL_CFLOAT"          },
+    { "bsl_c_iso646.h",     "INCLUDED_BSL_C_ISO646",
+      "bsl_ciso646.h",      "INCLUDED_BSL_CISO646"         },
+    { "bsl_c_limits.h",     "INCLUDED_BSL_C_LIMITS",
+      "bsl_climits.h",      "INCLUDED_BSL_CLIMITS"         },
+    { "bsl_c_locale.h",     "INCLUDED_BSL_C_LOCALE",
+      "bsl_clocale.h",      "INCLUDED_BSL_CLOCALE"         },
+    { "bsl_c_math.h",       "INCLUDED_BSL_C_MATH",
+      "bsl_cmath.h",        "INCLUDED_BSL_CMATH"           },
+    { "bsl_c_setjmp.h",     "INCLUDED_BSL_C_SETJMP",
+      "bsl_csetjmp.h",      "INCLUDED_BSL_CSETJMP"         },
+    { "bsl_c_signal.h",     "INCLUDED_BSL_C_SIGNAL",
+      "bsl_csignal.h",      "INCLUDED_BSL_CSIGNAL"         },
+    { "bsl_c_stdarg.h",     "INCLUDED_BSL_C_STDARG",
+      "bsl_cstdarg.h",      "INCLUDED_BSL_CSTDARG"         },
+    { "bsl_c_stddef.h",     "INCLUDED_BSL_C_STDDEF",
+      "bsl_cstddef.h",      "INCLUDED_BSL_CSTDDEF"         },
+    { "bsl_c_stdio.h",      "INCLUDED_BSL_C_STDIO",
+      "bsl_cstdio.h",       "INCLUDED_BSL_CSTDIO"          },
+    { "bsl_c_stdlib.h",     "INCLUDED_BSL_C_STDLIB",
+      "bsl_cstdlib.h",      "INCLUDED_BSL_CSTDLIB"         },
+    { "bsl_c_string.h",     "INCLUDED_BSL_C_STRING",
+      "bsl_cstring.h",      "INCLUDED_BSL_CSTRING"         },
+    { "bsl_c_time.h",       "INCLUDED_BSL_C_TIME",
+      "bsl_ctime.h",        "INCLUDED_BSL_CTIME"           },
+    { "bsl_c_wchar.h",      "INCLUDED_BSL_C_WCHAR",
+      "bsl_cwchar.h",       "INCLUDED_BSL_CWCHAR"          },
+    { "bsl_c_wctype.h",     "INCLUDED_BSL_C_WCTYPE",
+      "bsl_cwctype.h",      "INCLUDED_BSL_CWCTYPE"         },
+
+    // GCC has some cross-includes that cause problems.  For example, <ios>
+    // includes <stl_algobase.h> without going through <algorithm>, so the
+    // replacement of std::max with bsl::max fails when <ios> is replaced with
+    // <bsl_ios.h>.  This section will include these sepcial non-standard
+    // headers.
+
+    { "bsl_algorithm.h",  "INCLUDED_BSL_ALGORITHM",
+      "stl_algo.h",       "_ALGO_H"                  },
+    { "bsl_algorithm.h",  "INCLUDED_BSL_ALGORITHM",
+      "stl_algobase.h",   "_ALGOBASE_H"              },
+    { "bsl_functional.h", "INCLUDED_BSL_FUNCTIONAL",
+      "stl_function.h",   "_FUNCTION_H"              },
+    { "bsl_utility.h",    "INCLUDED_BSL_UTILITY",
+      "stl_pair.h",       "_PAIR_H"                  },
+    { "bsl_ios.h",        "INCLUDED_BSL_IOS",
+      "postypes.h",       "_GLIBCXX_POSTYPES_H"      },
+    { "bsl_ios.h",        "INCLUDED_BSL_IOS",
+      "ios_base.h",       "_IOS_BASE_H"              },
+    { "bsl_memory.h",     "INCLUDED_BSL_MEORY",
+      "auto_ptr.h",       "_BACKWARD_AUTO_PTR_H"     },
+
+    // 'bsl_' equivalents for 'bslstl_' files
+    { "bsl_algorithm.h",                  "INCLUDED_BSL_ALGORITHM",
+      "bslstl_algorithmworkaround.h",  "INCLUDED_BSLSTL_ALGORITHMWORKAROUND" },
+    { "bsl_memory.h",                     "INCLUDED_BSL_MEMORY",
+      "bslstl_allocator.h",               "INCLUDED_BSLSTL_ALLOCATOR"        },
+    { "bsl_memory.h",                     "INCLUDED_BSL_MEMORY",
+      "bslstl_allocatortraits.h",         "INCLUDED_BSLSTL_ALLOCATORTRAITS"  },
+    { "bsl_memory.h",                     "INCLUDED_BSL_MEMORY",
+      "bslstl_badweakptr.h",              "INCLUDED_BSLSTL_BADWEAKPTR"       },
+    { "bsl_iterator.h",                   "INCLUDED_BSL_ITERATOR",
+      "bslstl_bidirectionaliterator.h",
+                                     "INCLUDED_BSLSTL_BIDIRECTIONALITERATOR" },
+    { "bsl_set.h",                        "INCLUDED_BSL_SET",
+      "bslstl_bidirectionalnodepool.h",
+                                     "INCLUDED_BSLSTL_BIDIRECTIONALNODEPOOL" },
+    { "bsl_bitset.h",                     "INCLUDED_BSL_BITSET",
+      "bslstl_bitset.h",                  "INCLUDED_BSLSTL_BITSET"           },
+    { "bsl_deque.h",                      "INCLUDED_BSL_DEQUE",
+      "bslstl_deque.h",                   "INCLUDED_BSLSTL_DEQUE"            },
+    { "bsl_functional.h",                 "INCLUDED_BSL_FUNCTIONAL",
+      "bslstl_equalto.h",                 "INCLUDED_BSLSTL_EQUALTO"          },
+    { "bsl_iterator.h",                   "INCLUDED_BSL_ITERATOR",
+      "bslstl_forwarditerator.h",         "INCLUDED_BSLSTL_FORWARDITERATOR"  },
+    { "bsl_functional.h",                 "INCLUDED_BSL_FUNCTIONAL",
+      "bslstl_hash.h",                    "INCLUDED_BSLSTL_HASH"             },
+    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
+      "bslstl_hashtable.h",               "INCLUDED_BSLSTL_HASHTABLE"        },
+    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
+      "bslstl_hashtablebucketiterator.h",
+                                   "INCLUDED_BSLSTL_HASHTABLEBUCKETITERATOR" },
+    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
+      "bslstl_hashtableiterator.h",      "INCLUDED_BSLSTL_HASHTABLEITERATOR" },
+    { "bsl_iosfwd.h"                      "INCLUDED_BSL_IOSFWD",
+      "bslstl_iosfwd.h",                  "INCLUDED_BSLSTL_IOSFWD"           },
+    { "bsl_sstream.h",                    "INCLUDED_BSL_SSTREAM",
+      "bslstl_istringstream.h",           "INCLUDED_BSLSTL_ISTRINGSTREAM"    },
+    { "bsl_iterator.h",                   "INCLUDED_BSL_ITERATOR",
+      "bslstl_iterator.h",                "INCLUDED_BSLSTL_ITERATOR"         },
+    { "bsl_unordered_set.h",              "INCLUDED_BSL_UNORDERED_SET",
+      "bslstl_iteratorutil.h",            "INCLUDED_BSLSTL_ITERATORUTIL"     },
+    { "bsl_list.h",                       "INCLUDED_BSL_LIST",
+      "bslstl_list.h",                    "INCLUDED_BSLSTL_LIST"             },
+    { "bsl_map.h",                        "INCLUDED_BSL_MAP",
+      "bslstl_map.h",                     "INCLUDED_BSLSTL_MAP"              },
+    { "bsl_map.h",                        "INCLUDED_BSL_MAP",
+      "bslstl_mapcomparator.h",           "INCLUDED_BSLSTL_MAPCOMPARATOR"    },
+    { "bsl_map.h",                        "INCLUDED_BSL_MAP",
+      "bslstl_multimap.h",                "INCLUDED_BSLSTL_MULTIMAP"         },
+    { "bsl_set.h",                        "INCLUDED_BSL_SET",
+      "bslstl_multiset.h",                "INCLUDED_BSLSTL_MULTISET"         },
+    { "bsl_sstream.h",                    "INCLUDED_BSL_SSTREAM",
+      "bslstl_ostringstream.h",           "INCLUDED_BSLSTL_OSTRINGSTREAM"    },
+    { "bsl_utility.h",                    "INCLUDED_BSL_UTILITY",
+      "bslstl_pair.h",                    "INCLUDED_BSLSTL_PAIR"             },
+    { "bsl_queue.h",                      "INCLUDED_BSL_QUEUE",
+      "bslstl_queue.h",                   "INCLUDED_BSLSTL_QUEUE"            },
+    { "bsl_iterator.h",                   "INCLUDED_BSL_ITERATOR",
+      "bslstl_randomaccessiterator.h",
+                                      "INCLUDED_BSLSTL_RANDOMACCESSITERATOR" },
+    { "bsl_set.h",                        "INCLUDED_BSL_SET",
+      "bslstl_set.h",                     "INCLUDED_BSLSTL_SET"              },
+    { "bsl_set.h",                        "INCLUDED_BSL_SET",
+      "bslstl_setcomparator.h",           "INCLUDED_BSLSTL_SETCOMPARATOR"    },
+    { "bsl_memory.h",                     "INCLUDED_BSL_MEMORY",
+      "bslstl_sharedptr.h",               "INCLUDED_BSLSTL_SHAREDPTR"        },
+    { "bsl_set.h",                        "INCLUDED_BSL_SET",
+      "bslstl_simplepool.h",              "INCLUDED_BSLSTL_SIMPLEPOOL"       },
+    { "bsl_sstream.h",                    "INCLUDED_BSL_SSTREAM",
+      "bslstl_sstream.h",                 "INCLUDED_BSLSTL_SSTREAM"          },
+    { "bsl_stack.h",                      "INCLUDED_BSL_STACK",
+      "bslstl_stack.h",                   "INCLUDED_BSLSTL_STACK"            },
+    { "bsl_bitset.h",                     "INCLUDED_BSL_BITSET",
+      "bslstl_stdexceptutil.h",           "INCLUDED_BSLSTL_STDEXCEPTUTIL"    },
+    { "bsl_string.h",                     "INCLUDED_BSL_STRING",
+      "bslstl_string.h",                  "INCLUDED_BSLSTL_STRING"           },
+    { "bsl_sstream.h",                    "INCLUDED_BSL_SSTREAM",
+      "bslstl_stringbuf.h",               "INCLUDED_BSLSTL_STRINGBUF"        },
+    { "bsl_string.h",                     "INCLUDED_BSL_STRING",
+      "bslstl_stringref.h",               "INCLUDED_BSLSTL_STRINGREF"        },
+    { "bsl_string.h",                     "INCLUDED_BSL_STRING",
+      "bslstl_stringrefdata.h",           "INCLUDED_BSLSTL_STRINGREFDATA"    },
+    { "bsl_sstream.h",                    "INCLUDED_BSL_SSTREAM",
+      "bslstl_stringstream.h",            "INCLUDED_BSLSTL_STRINGSTREAM"     },
+    { "bsl_set.h",                        "INCLUDED_BSL_SET",
+      "bslstl_treeiterator.h",            "INCLUDED_BSLSTL_TREEITERATOR"     },
+    { "bsl_set.h",                        "INCLUDED_BSL_SET",
+      "bslstl_treenode.h",                "INCLUDED_BSLSTL_TREENODE"         },
+    { "bsl_set.h",                        "INCLUDED_BSL_SET",
+      "bslstl_treenodepool.h",            "INCLUDED_BSLSTL_TREENODEPOOL"     },
+    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
+      "bslstl_unorderedmap.h",            "INCLUDED_BSLSTL_UNORDEREDMAP"     },
+    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
+      "bslstl_unorderedmapkeyconfiguration.h",
+                              "INCLUDED_BSLSTL_UNORDEREDMAPKEYCONFIGURATION" },
+    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
+      "bslstl_unorderedmultimap.h",      "INCLUDED_BSLSTL_UNORDEREDMULTIMAP" },
+    { "bsl_unordered_set.h",              "INCLUDED_BSL_UNORDERED_SET",
+      "bslstl_unorderedmultiset.h",      "INCLUDED_BSLSTL_UNORDEREDMULTISET" },
+    { "bsl_unordered_set.h",              "INCLUDED_BSL_UNORDERED_SET",
+      "bslstl_unorderedset.h",            "INCLUDED_BSLSTL_UNORDEREDSET"     },
+    { "bsl_unordered_set.h",              "INCLUDED_BSL_UNORDERED_SET",
+      "bslstl_unorderedsetkeyconfiguration.h",
+                              "INCLUDED_BSLSTL_UNORDEREDSETKEYCONFIGURATION" },
+    { "bsl_vector.h",                     "INCLUDED_BSL_VECTOR",
+      "bslstl_vector.h",                  "INCLUDED_BSLSTL_VECTOR"           },
+
+    // 'bsl_' equivalents for 'bslstp_' files
+    { "bsl_algorithm.h",       "INCLUDED_BSL_ALGORITHM",
+      "bslstp_exalgorithm.h",  "INCLUDE_BSLSTP_EXALGORITHM"   },
+    { "bsl_functional.h",      "INCLUDED_BSL_FUNCTIONAL",
+      "bslstp_exfunctional.h", "INCLUDE_BSLSTP_EXFUNCTIONAL"  },
+    { "bsl_cstddef.h",         "INCLUDED_BSL_CSTDDEF",
+      "bslstp_hash.h",         "INCLUDE_BSLSTP_HASH"          },
+    { "bsl_functional.h",      "INCLUDED_BSL_FUNCTIONAL",
+      "bslstp_hashmap.h",      "INCLUDE_BSLSTP_HASHMAP"       },
+    { "bsl_functional.h",      "INCLUDED_BSL_FUNCTIONAL",
+      "bslstp_hashset.h",      "INCLUDE_BSLSTP_HASHSET"       },
+    { "bsl_algorithm.h",       "INCLUDED_BSL_ALGORITHM",
+      "bslstp_hashtable.h",    "INCLUDE_BSLSTP_HASHTABLE"     },
+    { "bsl_functional.h",      "INCLUDED_BSL_FUNCTIONAL",
+      "bslstp_hashtable.h",    "INCLUDE_BSLSTP_HASHTABLE"     },
+    { "bsl_iterator.h",        "INCLUDED_BSL_ITERATOR",
+      "bslstp_hashtable.h",    "INCLUDE_BSLSTP_HASHTABLE"     },
+    { "bsl_cstddef.h",         "INCLUDED_BSL_CSTDDEF",
+      "bslstp_iterator.h",     "INCLUDE_BSLSTP_ITERATOR"      },
+    { "bsl_algorithm.h",       "INCLUDED_BSL_ALGORITHM",
+      "bslstp_slist.h",        "INCLUDE_BSLSTP_SLIST"         },
+    { "bsl_cstddef.h",         "INCLUDED_BSL_CSTDDEF",
+      "bslstp_slist.h",        "INCLUDE_BSLSTP_SLIST"         },
+    { "bsl_iterator.h",        "INCLUDED_BSL_ITERATOR",
+      "bslstp_slist.h",        "INCLUDE_BSLSTP_SLIST"         },
+    { "bsl_cstddef.h",         "INCLUDED_BSL_CSTDDEF",
+      "bslstp_slistbase.h",    "INCLUDE_BSLSTP_SLISTBASE"     },
+
+    // There are some bsls_ files that include headers transitively in override
+    // mode only, so if we see those headers we may need to include the
+    // transitive header explicitly.
+
+    { "bsl_cstddef.h",          "INCLUDED_BSL_CSTDDEF",
+      "bsls_alignment.h",       "INCLUDED_BSLS_ALIGNMENT"        },
+    { "bsl_limits.h",           "INCLUDED_BSL_LIMITS",
+      "bsls_alignmentutil.h",   "INCLUDED_BSLS_ALIGNMENTUTIL"    },
+    { "bsl_cstddef.h",          "INCLUDED_BSL_CSTDDEF",
+      "bsls_platformutil.h",    "INCLUDED_BSLS_PLATFORMUTIL"     },
+    { "bsl_iosfwd.h",           "INCLUDED_BSL_IOSFWD",
+      "bsls_systemclocktype.h", "INCLUDED_BSLS_SYSTEMCLOCK_TYPE" },
+    { "bsl_ostream.h",          "INCLUDED_BSL_OSTREAM",
+      "bsls_timeinterval.h",    "INCLUDED_BSLS_TIMEINTERVAL"     },
+    { "bsl_cstddef.h",          "INCLUDED_BSL_CSTDDEF",
+      "bsls_types.h",           "INCLUDED_BSLS_TYPES"            },
+    { "bslalg_typetraits.h",    "INCLUDED_BSLALG_TYPETRAITS",
+      "bsl_string.h",           "INCLUDED_BSL_STRING"            },
+    { "bsls_atomic.h",          "INCLUDED_BSLS_ATOMIC",
+      "bslma_sharedptrrep.h",   "INCLUDED_BSLMA_SHAREDPTRREP"    },
+    { "bslma_managedptr.h",     "INCLUDED_BSLMA_MANAGEDPTR",
+      "bslalg_swaputil.h",      "INCLUDED_BSLALG_SWAPUTIL"       },
+    { "bsls_types.h",           "INCLUDED_BSLS_TYPES",
+      "bdet_packedcalendar.h",  "INCLUDED_BDET_PACKEDCALENDAR"   },
+};
+
+// The following tables are sorted.
+
+const char *const cpp_headers[] = {
+    // Standard C++ headers, which are also top-level as 'bsl_X.h' and
+    // 'stl_X.h'.
+    "algorithm",           "array",               "atomic",
+    "bitset",              "chrono",              "codecvt",
+    "complex",             "condition_variable",  "deque",
+    "exception",           "forward_list",        "fstream",
+    "functional",          "future",              "initializer_list",
+    "iomanip",             "ios",                 "iosfwd",
+    "iostream",            "istream",             "iterator",
+    "limits",              "list",                "locale",
+    "map",                 "memory",              "mutex",
+    "new",                 "numeric",             "ostream",
+    "queue",               "random",              "ratio",
+    "regex",               "scoped_allocator",    "set",
+    "sstream",             "stack",               "stdexcept",
+    "streambuf",           "string",              "strstream",
+    "system_error",        "thread",              "tuple",
+    "type_traits",         "typeindex",           "typeinfo",
+    "unordered_map",       "unordered_set",       "utility",
+    "valarray",            "vector",
+};
+
+const char *const c_headers[] = {
+    // Standard C headers, which are top-level as 'X.h', 'cX', 'bsl_cX.h', and
+    // 'bsl_c_X.h'.
+    "assert",   "complex",  "ctype",    "errno",    "fenv",     "float",
+    "inttypes", "iso646",   "limits",   "locale",   "math",     "setjmp",
+    "signal",   "stdalign", "stdarg",   "stdbool",  "stddef",   "stdint",
+    "stdio",    "stdlib",   "string",   "tgmath",   "time",     "uchar",
+    "wchar",    "wctype",
+};
+
+const char *const other_headers[] = {
+    "unistd.h",
+    "vstring.h",
+};
+
+const char *const top_level_prefixes[] = {
+    "bdlat_",  "bdlb_",   "bdlc_",   "bdlde_",  "bdldfp_", "bdlf_",
+    "bdlma_",  "bdlmt_",  "bdlqq_",  "bdls_",   "bdlsb_",  "bdlscm_",
+    "bdlsu_",  "bdlt_",   "bslalg_", "bslfwd_", "bslh_",   "bslim_",
+    "bslma_",  "bslmf_",  "bsls_",   "bslscm_", "bsltf_",  "bslx_",
+};
+
+const HeaderMapping mapped_headers[] = {
+    { "/bits/algorithmfwd.h",                 "algorithm"           },
+    { "/bits/alloc_traits.h",                 "memory"              },
+    { "/bits/allocator.h",                    "memory"              },
+    { "/bits/atomic_base.h",                  "atomic"              },
+    { "/bits/atomic_lockfree_defines.h",      "atomic"              },
+    { "/bits/auto_ptr.h",                     "memory"              },
+    { "/bits/backward_warning.h",             "iosfwd"              },
+    { "/bits/basic_file.h",                   "ios"                 },
+    { "/bits/basic_ios.h",                    "ios"                 },
+    { "/bits/basic_ios.tcc",                  "ios"                 },
+    { "/bits/basic_string.h",                 "string"              },
+    { "/bits/basic_string.tcc",               "string"              },
+    { "/bits/bessel_function.tcc",            "cmath"               },
+    { "/bits/beta_function.tcc",              "cmath"               },
+    { "/bits/binders.h",                      "functional"          },
+    { "/bits/boost_concept_check.h",          "iterator"            },
+    { "/bits/c++0x_warning.h",                "iosfwd"              },
+    { "/bits/c++allocator.h",                 "memory"              },
+    { "/bits/c++config.h",                    "iosfwd"              },
+    { "/bits/c++io.h",                        "ios"                 },
+    { "/bits/c++locale.h",                    "locale"              },
+    { "/bits/cast.h",                         "pointer.h"           },
+    { "/bits/char_traits.h",                  "string"              },
+    { "/bits/codecvt.h",                      "locale"              },
+    { "/bits/concept_check.h",                "iterator"            },
+    { "/bits/cpp_type_traits.h",              "type_traits"         },
+    { "/bits/cpu_defines.h",                  "iosfwd"              },
+    { "/bits/ctype_base.h",                   "locale"              },
+    { "/bits/ctype_inline.h",                 "locale"              },
+    { "/bits/cxxabi_forced.h",                "cxxabi.h"            },
+    { "/bits/cxxabi_tweaks.h",                "cxxabi.h"            },
+    { "/bits/decimal.h",                      "decimal"             },
+    { "/bits/deque.tcc",                      "deque"               },
+    { "/bits/ell_integral.tcc",               "cmath"               },
+    { "/bits/error_constants.h",              "system_error"        },
+    { "/bits/exception_defines.h",            "exception"           },
+    { "/bits/exception_ptr.h",                "exception"           },
+    { "/bits/exp_integral.tcc",               "cmath"               },
+    { "/bits/forward_list.h",                 "forward_list"        },
+    { "/bits/forward_list.tcc",               "forward_list"        },
+    { "/bits/fstream.tcc",                    "fstream"             },
+    { "/bits/functexcept.h",                  "exception"           },
+    { "/bits/functional_hash.h",              "functional"          },
+    { "/bits/gamma.tcc",                      "cmath"               },
+    { "/bits/gslice.h",                       "valarray"            },
+    { "/bits/gslice_array.h",                 "valarray"            },
+    { "/bits/hash_bytes.h",                   "functional"          },
+    { "/bits/hashtable.h",                    "unordered_map"       },
+    { "/bits/hashtable_policy.h",             "unordered_map"       },
+    { "/bits/hypergeometric.tcc",             "cmath"               },
+    { "/bits/indirect_array.h",               "valarray"            },
+    { "/bits/ios_base.h",                     "ios"                 },
+    { "/bits/istream.tcc",                    "istream"             },
+    { "/bits/legendre_function.tcc",          "cmath"               },
+    { "/bits/list.tcc",                       "list"                },
+    { "/bits/locale_classes.h",               "locale"              },
+    { "/bits/locale_classes.tcc",             "locale"              },
+    { "/bits/locale_facets.h",                "locale"              },
+    { "/bits/locale_facets.tcc",              "locale"              },
+    { "/bits/locale_facets_nonio.h",          "locale"              },
+    { "/bits/locale_facets_nonio.tcc",        "locale"              },
+    { "/bits/localefwd.h",                    "locale"              },
+    { "/bits/mask_array.h",                   "valarray"            },
+    { "/bits/memoryfwd.h",                    "memory"              },
+    { "/bits/messages_members.h",             "locale"              },
+    { "/bits/modified_bessel_func.tcc",       "cmath"               },
+    { "/bits/move.h",                         "utility"             },
+    { "/bits/nested_exception.h",             "exception"           },
+    { "/bits/opt_random.h",                   "random"              },
+    { "/bits/os_defines.h",                   "iosfwd"              },
+    { "/bits/ostream.tcc",                    "ostream"             },
+    { "/bits/ostream_insert.h",               "ostream"             },
+    { "/bits/poly_hermite.tcc",               "cmath"               },
+    { "/bits/poly_laguerre.tcc",              "cmath"               },
+    { "/bits/postypes.h",                     "iosfwd"              },
+    { "/bits/ptr_traits.h",                   "memory"              },
+    { "/bits/random.h",                       "random"              },
+    { "/bits/random.tcc",                     "random"              },
+    { "/bits/range_access.h",                 "iterator"            },
+    { "/bits/rc_string_base.h",               "vstring.h"           },
+    { "/bits/regex.h",                        "regex"               },
+    { "/bits/regex_compiler.h",               "regex"               },
+    { "/bits/regex_constants.h",              "regex"               },
+    { "/bits/regex_cursor.h",                 "regex"               },
+    { "/bits/regex_error.h",                  "regex"               },
+    { "/bits/regex_grep_matcher.h",           "regex"               },
+    { "/bits/regex_grep_matcher.tcc",         "regex"               },
+    { "/bits/regex_nfa.h",                    "regex"               },
+    { "/bits/regex_nfa.tcc",                  "regex"               },
+    { "/bits/riemann_zeta.tcc",               "cmath"               },
+    { "/bits/ropeimpl.h",                     "rope"                },
+    { "/bits/shared_ptr.h",                   "memory"              },
+    { "/bits/shared_ptr_base.h",              "memory"              },
+    { "/bits/slice_array.h",                  "valarray"            },
+    { "/bits/special_function_util.h",        "cmath"               },
+    { "/bits/sso_string_base.h",              "vstring.h"           },
+    { "/bits/sstream.tcc",                    "sstream"             },
+    { "/bits/stl_algo.h",                     "algorithm"           },
+    { "/bits/stl_algobase.h",                 "algorithm"           },
+    { "/bits/stl_bvector.h",                  "vector"              },
+    { "/bits/stl_construct.h",                "memory"              },
+    { "/bits/stl_deque.h",                    "deque"               },
+    { "/bits/stl_function.h",                 "functional"          },
+    { "/bits/stl_heap.h",                     "queue"               },
+    { "/bits/stl_iterator.h",                 "iterator"            },
+    { "/bits/stl_iterator_base_funcs.h",      "iterator"            },
+    { "/bits/stl_iterator_base_types.h",      "iterator"            },
+    { "/bits/stl_list.h",                     "list"                },
+    { "/bits/stl_map.h",                      "map"                 },
+    { "/bits/stl_multimap.h",                 "map"                 },
+    { "/bits/stl_multiset.h",                 "set"                 },
+    { "/bits/stl_numeric.h",                  "numeric"             },
+    { "/bits/stl_pair.h",                     "utility"             },
+    { "/bits/stl_queue.h",                    "queue"               },
+    { "/bits/stl_raw_storage_iter.h",         "memory"              },
+    { "/bits/stl_relops.h",                   "utility"             },
+    { "/bits/stl_set.h",                      "set"                 },
+    { "/bits/stl_stack.h",                    "stack"               },
+    { "/bits/stl_tempbuf.h",                  "memory"              },
+    { "/bits/stl_tree.h",                     "map"                 },
+    { "/bits/stl_uninitialized.h",            "memory"              },
+    { "/bits/stl_vector.h",                   "vector"              },
+    { "/bits/stream_iterator.h",              "iterator"            },
+    { "/bits/streambuf.tcc",                  "streambuf"           },
+    { "/bits/streambuf_iterator.h",           "iterator"            },
+    { "/bits/stringfwd.h",                    "string"              },
+    { "/bits/strstream",                      "sstream"             },
+    { "/bits/time_members.h",                 "locale"              },
+    { "/bits/unique_ptr.h",                   "memory"              },
+    { "/bits/unordered_map.h",                "unordered_map"       },
+    { "/bits/unordered_set.h",                "unordered_set"       },
+    { "/bits/valarray_after.h",               "valarray"            },
+    { "/bits/valarray_array.h",               "valarray"            },
+    { "/bits/valarray_array.tcc",             "valarray"            },
+    { "/bits/valarray_before.h",              "valarray"            },
+    { "/bits/vector.tcc",                     "vector"              },
+    { "/bits/vstring.tcc",                    "vstring.h"           },
+    { "/bits/vstring_fwd.h",                  "vstring.h"           },
+    { "/bits/vstring_util.h",                 "vstring.h"           },
+    { "/bslstl_algorithmworkaround.h",        "bsl_algorithm.h"     },
+    { "/bslstl_allocator.h",                  "bsl_memory.h"        },
+    { "/bslstl_allocatortraits.h",            "bsl_memory.h"        },
+    { "/bslstl_badweakptr.h",                 "bsl_memory.h"        },
+    { "/bslstl_bidirectionaliterator.h",      "bsl_iterator.h"      },
+    { "/bslstl_bitset.h",                     "bsl_bitset.h"        },
+    { "/bslstl_deque.h",                      "bsl_deque.h"         },
+    { "/bslstl_equalto.h",                    "bsl_functional.h"    },
+    { "/bslstl_forwarditerator.h",            "bsl_iterator.h"      },
+    { "/bslstl_hash.h",                       "bsl_functional.h"    },
+    { "/bslstl_istringstream.h",              "bsl_sstream.h"       },
+    { "/bslstl_iterator.h",                   "bsl_iterator.h"      },
+    { "/bslstl_list.h",                       "bsl_list.h"          },
+    { "/bslstl_map.h",                        "bsl_map.h"           },
+    { "/bslstl_multimap.h",                   "bsl_map.h"           },
+    { "/bslstl_multiset.h",                   "bsl_set.h"           },
+    { "/bslstl_ostringstream.h",              "bsl_sstream.h"       },
+    { "/bslstl_pair.h",                       "bsl_utility.h"       },
+    { "/bslstl_randomaccessiterator.h",       "bsl_iterator.h"      },
+    { "/bslstl_set.h",                        "bsl_set.h"           },
+    { "/bslstl_sharedptr.h",                  "bsl_memory.h"        },
+    { "/bslstl_sstream.h",                    "bsl_sstream.h"       },
+    { "/bslstl_stack.h",                      "bsl_stack.h"         },
+    { "/bslstl_stdexceptutil.h",              "bsl_stdexcept.h"     },
+    { "/bslstl_string.h",                     "bsl_string.h"        },
+    { "/bslstl_stringbuf.h",                  "bsl_sstream.h"       },
+    { "/bslstl_stringstream.h",               "bsl_sstream.h"       },
+    { "/bslstl_unorderedmap.h",               "bsl_unordered_map.h" },
+    { "/bslstl_unorderedmultimap.h",          "bsl_unordered_map.h" },
+    { "/bslstl_unorderedmultiset.h",          "bsl_unordered_set.h" },
+    { "/bslstl_unorderedset.h",               "bsl_unordered_set.h" },
+    { "/bslstl_vector.h",                     "bsl_vector.h"        },
+};
+
+const char *const reexporting_headers[] = {
+    "bael_log.h",
+};
+
+const HeaderMapping if_included_headers[] = {
+    { "bsl_ios.h",       "bsl_iostream.h"  },
+    { "bsl_ios.h",       "bsl_streambuf.h" },
+    { "bsl_ios.h",       "bsl_strstream.h" },
+    { "bsl_iosfwd.h",    "bsl_ios.h"       },
+    { "bsl_istream.h",   "bsl_iostream.h"  },
+    { "bsl_ostream.h",   "bsl_iostream.h"  },
+    { "bsl_streambuf.h", "bsl_iostream.h"  },
+    { "ios.h",           "bsl_iostream.h"  },
+    { "ios.h",           "bsl_streambuf.h" },
+    { "ios.h",           "bsl_strstream.h" },
+    { "iosfwd",          "bsl_ios.h"       },
+    { "istream",         "bsl_iostream.h"  },
+    { "math.h",          "bsl_cmath.h"     },
+    { "ostream",         "bsl_iostream.h"  },
+    { "streambuf",       "bsl_iostream.h"  },
+};
+
+template <size_t N>
+bool contains(const char *const (&table)[N], llvm::StringRef name)
+    // Return 'true' if the specified sorted 'table' holds the specified
+    // 'name', and 'false' otherwise.
+{
+    auto it = std::lower_bound(std::begin(table),
+                               std::end(table),
+                               name,
+                               [](const char *entry, llvm::StringRef n) {
+                                   return llvm::StringRef(entry) < n;
+                               });
+    return it != std::end(table) && name == *it;
+}
+
+bool mapping_less(HeaderMapping const& mapping, llvm::StringRef name)
+    // Return 'true' if the specified 'mapping' is from a header ordered
+    // before the specified 'name', and 'false' otherwise.
+{
+    return llvm::StringRef(mapping.d_from) < name;
+}
+
+bool less_mapping(llvm::StringRef name, HeaderMapping const& mapping)
+    // Return 'true' if the specified 'name' is ordered before the header the
+    // specified 'mapping' is from, and 'false' otherwise.
+{
+    return name < llvm::StringRef(mapping.d_from);
+}
+
+struct MappedToIndex
+    // The headers that implementation headers are mapped to, in order.
+{
+    MappedToIndex();
+        // Create the index of 'mapped_headers'.
+
+    std::vector<llvm::StringRef> d_names;
+};
+
+MappedToIndex::MappedToIndex()
+{
+    for (HeaderMapping const& mapping : mapped_headers) {
+        d_names.push_back(mapping.d_to);
+    }
+    std::sort(d_names.begin(), d_names.end());
+}
+
+struct PairIndex
+    // The header pairs, under the name of each of their headers, ordered by
+    // name and then by position in the table.
+{
+    PairIndex();
+        // Create the index of 'header_pairs'.
+
+    std::vector<llvm::StringRef>    d_names;
+    std::vector<HeaderPair const *> d_pairs;
+};
+
+PairIndex::PairIndex()
+{
+    std::vector<std::pair<llvm::StringRef, HeaderPair const *>> entries;
+    for (HeaderPair const& pair : header_pairs) {
+        entries.emplace_back(pair.d_bsl, &pair);
+        entries.emplace_back(pair.d_std, &pair);
+    }
+    std::stable_sort(entries.begin(),
+                     entries.end(),
+                     [](std::pair<llvm::StringRef, HeaderPair const *> a,
+                        std::pair<llvm::StringRef, HeaderPair const *> b) {
+                         return a.first < b.first;
+                     });
+    for (const auto& entry : entries) {
+        d_names.push_back(entry.first);
+        d_pairs.push_back(entry.second);
+    }
+}
+
+}
+
+// ----------------------------------------------------------------------------
+
+llvm::ArrayRef<HeaderPair> csabase::HeaderIndex::pairs()
+{
+    return header_pairs;
+}
+
+HeaderIndex::Pairs csabase::HeaderIndex::pairs(llvm::StringRef header)
+{
+    static PairIndex const index;
+    auto range = std::equal_range(
+        index.d_names.begin(), index.d_names.end(), header);
+    return Pairs(index.d_pairs.data() + (range.first - index.d_names.begin()),
+                 range.second - range.first);
+}
+
+bool csabase::HeaderIndex::is_top_level(llvm::StringRef header)
+{
+    if (contains(cpp_headers, header) || contains(other_headers, header)) {
+        return true;                                                  // RETURN
+    }
+    if (header.startswith("c") && contains(c_headers, header.drop_front(1))) {
+        return true;                                                  // RETURN
+    }
+    if (header.endswith(".h")) {
+        llvm::StringRef stem = header.drop_back(2);
+        if (contains(c_headers, stem)) {
+            return true;                                              // RETURN
+        }
+        if ((stem.startswith("bsl_") || stem.startswith("stl_")) &&
+            contains(cpp_headers, stem.drop_front(4))) {
+            return true;                                              // RETURN
+        }
+        if (stem.startswith("bsl_c_") &&
+            contains(c_headers, stem.drop_front(6))) {
+            return true;                                              // RETURN
+        }
+        if (stem.startswith("bsl_c") &&
+            contains(c_headers, stem.drop_front(5))) {
+            return true;                                              // RETURN
+        }
+    }
+    for (llvm::StringRef prefix : top_level_prefixes) {
+        if (header.startswith(prefix)) {
+            return true;                                              // RETURN
+        }
+    }
+    return false;
+}
+
+llvm::StringRef csabase::HeaderIndex::mapped(llvm::StringRef path)
+{
+    for (size_t rs = path.rfind('/'); rs != path.npos;
+         rs = path.rfind('/', rs)) {
+        llvm::StringRef suffix = path.substr(rs);
+        auto it = std::lower_bound(std::begin(mapped_headers),
+                                   std::end(mapped_headers),
+                                   suffix,
+                                   mapping_less);
+        if (it != std::end(mapped_headers) && suffix == it->d_from) {
+            return it->d_to;                                          // RETURN
+        }
+    }
+    return llvm::StringRef();
+}
+
+llvm::ArrayRef<HeaderMapping> csabase::HeaderIndex::mappings()
+{
+    return mapped_headers;
+}
+
+bool csabase::HeaderIndex::is_mapped_either_way(llvm::StringRef name)
+{
+    static MappedToIndex const index;
+    auto it = std::lower_bound(std::begin(mapped_headers),
+                               std::end(mapped_headers),
+                               name,
+                               mapping_less);
+    return (it != std::end(mapped_headers) && name == it->d_from) ||
+           std::binary_search(index.d_names.begin(),
+                              index.d_names.end(),
+                              name);
+}
+
+bool csabase::HeaderIndex::is_reexporting(llvm::StringRef header)
+{
+    return contains(reexporting_headers, header);
+}
+
+llvm::ArrayRef<HeaderMapping>
+csabase::HeaderIndex::if_included(llvm::StringRef header)
+{
+    auto first = std::lower_bound(std::begin(if_included_headers),
+                                  std::end(if_included_headers),
+                                  header,
+                                  mapping_less);
+    auto last  = std::upper_bound(first,
+                                  std::end(if_included_headers),
+                                  header,
+                                  less_mapping);
+    return llvm::ArrayRef<HeaderMapping>(first, last);
+}
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
@@ -0,0 +1,92 @@
+// csabase_headerindex.h                                              -*-C++-*-
+
+#ifndef INCLUDED_CSABASE_HEADERINDEX
+#define INCLUDED_CSABASE_HEADERINDEX
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringRef.h>
+
+// ----------------------------------------------------------------------------
+
+namespace csabase
+{
+struct HeaderPair
+    // A 'bsl_' header, the header it stands for, and their include guards.
+{
+    const char *d_bsl;
+    const char *d_bsl_guard;
+    const char *d_std;
+    const char *d_std_guard;
+};
+
+struct HeaderMapping
+    // A header name and a header that should be named in its place.
+{
+    const char *d_from;
+    const char *d_to;
+};
+
+class HeaderIndex
+    // This class provides the tables of standard and 'bsl_' headers used by
+    // the checks that work out which header a name should come from.  The
+    // tables are constant arrays, so they need no construction, and those
+    // that are searched are kept sorted, so that they are searched by
+    // bisection.
+{
+  public:
+    typedef llvm::ArrayRef<HeaderPair const *> Pairs;
+
+    static llvm::ArrayRef<HeaderPair> pairs();
+        // Return all the header pairs.
+
+    static Pairs pairs(llvm::StringRef header);
+        // Return the header pairs of which either header is the specified
+        // 'header', in table order.
+
+    static bool is_top_level(llvm::StringRef header);
+        // Return 'true' if the specified 'header' (a file name without
+        // directory) is one that programs include directly, such as a
+        // standard header, its 'bsl_' counterpart, or a low-level BDE
+        // component, and 'false' otherwise.
+
+    static llvm::StringRef mapped(llvm::StringRef path);
+        // Return the header that should be included in place of the
+        // implementation header with the specified 'path', or an empty
+        // string if there is none.
+
+    static llvm::ArrayRef<HeaderMapping> mappings();
+        // Return the mappings from implementation headers to the headers
+        // that should be included in their place, in order of the former.
+
+    static bool is_mapped_either_way(llvm::StringRef name);
+        // Return 'true' if the specified 'name' is either side of one of the
+        // 'mappings()', and 'false' otherwise.
+
+    static bool is_reexporting(llvm::StringRef header);
+        // Return 'true' if the specified 'header' makes available everything
+        // that it includes, and 'false' otherwise.
+
+    static llvm::ArrayRef<HeaderMapping> if_included(llvm::StringRef header);
+        // Return the headers that supply what the specified 'header'
+        // supplies, and should be named in its place if they are included,
+        // in order of name.
+};
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
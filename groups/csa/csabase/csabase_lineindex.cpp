@@ -0,0 +1,116 @@
+// csabase_lineindex.cpp                                              -*-C++-*-
+
+#include <csabase_lineindex.h>
+#include <llvm/Support/MathExtras.h>
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace csabase;
+
+// ----------------------------------------------------------------------------
+
+csabase::LineIndex::LineIndex(llvm::StringRef buffer)
+: d_lone_cr(false)
+{
+    const char *b    = buffer.data();
+    unsigned    size = buffer.size();
+    unsigned    i    = 0;
+
+    d_line_starts.push_back(0);
+
+#if defined(__SSE2__)
+    // Find the interesting characters sixteen at a time.  Most chunks have
+    // nothing but a newline or two, and are dispatched with a few compares.
+    const __m128i nl  = _mm_set1_epi8('\n');
+    const __m128i cr  = _mm_set1_epi8('\r');
+    const __m128i tab = _mm_set1_epi8('\t');
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, nl), _mm_cmpeq_epi8(chunk, cr)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, tab), chunk));
+        for (unsigned mask = _mm_movemask_epi8(hits); mask; mask &= mask - 1) {
+            note(buffer, i + llvm::countTrailingZeros(mask));
+        }
+    }
+#endif
+
+    for (; i < size; ++i) {
+        char c = b[i];
+        if (c == '\n' || c == '\r' || c == '\t' || (c & 0x80)) {
+            note(buffer, i);
+        }
+    }
+    end_line(buffer, size);
+}
+
+void csabase::LineIndex::end_line(llvm::StringRef buffer, unsigned offset)
+{
+    unsigned start = d_line_starts.back();
+    unsigned end   = offset;
+    while (end > start && buffer[end - 1] == '\r') {
+        --end;
+    }
+    unsigned spaces = end;
+    while (spaces > start && buffer[spaces - 1] == ' ') {
+        --spaces;
+    }
+    if (spaces < end) {
+        Run run = { spaces, end - spaces };
+        d_trailing_spaces.push_back(run);
+    }
+    d_line_lengths.push_back(
+        offset - start - (offset > start && buffer[offset - 1] == '\r'));
+}
+
+void csabase::LineIndex::note(llvm::StringRef buffer, unsigned offset)
+{
+    switch (buffer[offset]) {
+      case '\n': {
+        end_line(buffer, offset);
+        d_line_starts.push_back(offset + 1);
+      } break;
+      case '\r': {
+        if (offset + 1 == buffer.size() || buffer[offset + 1] != '\n') {
+            d_lone_cr = true;
+        }
+      } break;
+      default: {
+        std::vector<Run>& runs = buffer[offset] == '\t' ? d_tabs : d_non_ascii;
+        if (!runs.empty() &&
+            runs.back().d_offset + runs.back().d_length == offset) {
+            ++runs.back().d_length;
+        }
+        else {
+            Run run = { offset, 1 };
+            runs.push_back(run);
+        }
+      } break;
+    }
+}
+
+unsigned csabase::LineIndex::line(unsigned offset) const
+{
+    return std::upper_bound(
+               d_line_starts.begin(), d_line_starts.end(), offset) -
+           d_line_starts.begin() - 1;
+}
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
@@ -0,0 +1,139 @@
+// csabase_lineindex.h                                                -*-C++-*-
+
+#ifndef INCLUDED_CSABASE_LINEINDEX
+#define INCLUDED_CSABASE_LINEINDEX
+
+#include <llvm/ADT/StringRef.h>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace csabase
+{
+class LineIndex
+    // This class describes the lines of a file buffer, and the positions of
+    // the characters that the textual format checks look for, gathered in a
+    // single (vectorized, where possible) pass over the buffer.  Lines are
+    // separated by '\n'; the buffer always has one more line than newlines.
+{
+  public:
+    struct Run
+        // A sequence of characters of the same kind.
+    {
+        unsigned d_offset;  // offset of the first character in the buffer
+        unsigned d_length;  // number of characters
+    };
+
+    explicit LineIndex(llvm::StringRef buffer);
+        // Create an index of the specified 'buffer'.
+
+    unsigned lines() const;
+        // Return the number of lines.
+
+    unsigned line(unsigned offset) const;
+        // Return the 0-based number of the line containing the specified
+        // 'offset'.
+
+    unsigned line_start(unsigned line) const;
+        // Return the offset of the start of the specified 0-based 'line'.
+
+    unsigned line_length(unsigned line) const;
+        // Return the length of the specified 0-based 'line', excluding its
+        // terminating newline and a carriage return preceding it.
+
+    bool has_lone_cr() const;
+        // Return 'true' if the buffer has a carriage return that is not
+        // immediately followed by a newline, so that clang (which also takes
+        // those to end lines) numbers the lines differently.
+
+    std::vector<Run> const& tabs() const;
+        // Return the maximal runs of tab characters, in order.
+
+    std::vector<Run> const& trailing_spaces() const;
+        // Return the maximal runs of spaces followed by zero or more carriage
+        // returns and then a newline or the end of the buffer, in order.
+
+    std::vector<Run> const& non_ascii() const;
+        // Return the maximal runs of characters with the high bit set, in
+        // order.
+
+  private:
+    void note(llvm::StringRef buffer, unsigned offset);
+        // Record the special character at the specified 'offset' of the
+        // specified 'buffer'.
+
+    void end_line(llvm::StringRef buffer, unsigned offset);
+        // Record the length and any trailing spaces of the last line started
+        // in the specified 'buffer', which ends at the specified 'offset' (of
+        // its newline, or of the end of the buffer).
+
+    std::vector<unsigned> d_line_starts;
+    std::vector<unsigned> d_line_lengths;
+    bool                  d_lone_cr;
+    std::vector<Run>      d_tabs;
+    std::vector<Run>      d_trailing_spaces;
+    std::vector<Run>      d_non_ascii;
+};
+
+// ----------------------------------------------------------------------------
+
+inline
+unsigned LineIndex::lines() const
+{
+    return d_line_starts.size();
+}
+
+inline
+unsigned LineIndex::line_start(unsigned line) const
+{
+    return d_line_starts[line];
+}
+
+inline
+unsigned LineIndex::line_length(unsigned line) const
+{
+    return d_line_lengths[line];
+}
+
+inline
+bool LineIndex::has_lone_cr() const
+{
+    return d_lone_cr;
+}
+
+inline
+std::vector<LineIndex::Run> const& LineIndex::tabs() const
+{
+    return d_tabs;
+}
+
+inline
+std::vector<LineIndex::Run> const& LineIndex::trailing_spaces() const
+{
+    return d_trailing_spaces;
+}
+
+inline
+std::vector<LineIndex::Run> const& LineIndex::non_ascii() const
+{
+    return d_non_ascii;
+}
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
@@ -12,21 +12,32 @@ using namespace clang;
 // -----------------------------------------------------------------------------
 
 csabase::Location::Location()
-    : d_file("<unknown>")
+    : d_manager(0)
+    , d_location()
+    , d_file_id()
+    , d_file("<unknown>")
     , d_line(0)
     , d_column(0)
-    , d_location()
 {
 }
 
 csabase::Location::Location(SourceManager const& manager,
                             SourceLocation location)
-: d_file()
+: d_manager(&manager)
+, d_location(manager.getExpansionLoc(location))
+, d_file_id(manager.getFileID(d_location))
+, d_file(0)
 , d_line(0)
 , d_column(0)
-, d_location(manager.getExpansionLoc(location))
 {
-    PresumedLoc loc(manager.getPresumedLoc(location));
+}
+
+// -----------------------------------------------------------------------------
+
+void csabase::Location::resolve() const
+{
+    // The presumed location of a macro location is that of its expansion.
+    PresumedLoc loc(d_manager->getPresumedLoc(d_location));
     if (loc.isValid()) {
         d_file   = loc.getFilename();
         d_line   = loc.getLine();
@@ -37,20 +48,27 @@ csabase::Location::Location(SourceManager const& manager,
     }
 }
 
-// -----------------------------------------------------------------------------
-
-std::string csabase::Location::file() const
+llvm::StringRef csabase::Location::file() const
 {
+    if (!d_file) {
+        resolve();
+    }
     return d_file;
 }
 
 size_t csabase::Location::line() const
 {
+    if (!d_file) {
+        resolve();
+    }
     return d_line;
 }
 
 size_t csabase::Location::column() const
 {
+    if (!d_file) {
+        resolve();
+    }
     return d_column;
 }
 
@@ -59,24 +77,29 @@ SourceLocation csabase::Location::location() const
     return d_location;
 }
 
+FileID csabase::Location::file_id() const
+{
+    return d_file_id;
+}
+
 bool csabase::Location::operator<(Location const& rhs) const
 {
-    if (d_file < rhs.d_file) {
+    if (file() < rhs.file()) {
         return true;
     }
-    if (rhs.d_file < d_file) {
+    if (rhs.file() < file()) {
         return false;
     }
-    if (d_line < rhs.d_line) {
+    if (line() < rhs.line()) {
         return true;
     }
-    if (rhs.d_line < d_line) {
+    if (rhs.line() < line()) {
         return false;
     }
-    if (d_column < rhs.d_column) {
+    if (column() < rhs.column()) {
         return true;
     }
-    if (rhs.d_column < d_column) {
+    if (rhs.column() < column()) {
         return false;
     }
     return false;
@@ -99,7 +122,8 @@ llvm::raw_ostream& csabase::operator<<(llvm::raw_ostream& out,
 
 std::ostream& csabase::operator<<(std::ostream& out, Location const& loc)
 {
-    return out << loc.file() << ":" << loc.line() << ":" << loc.column();
+    return out << loc.file().str() << ":" << loc.line() << ":"
+               << loc.column();
 }
 
 // -----------------------------------------------------------------------------
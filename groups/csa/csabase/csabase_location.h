@@ -4,6 +4,7 @@
 #define INCLUDED_CSABASE_LOCATION
 
 #include <clang/Basic/SourceLocation.h>
+#include <llvm/ADT/StringRef.h>
 #include <stddef.h>
 #include <iosfwd>
 #include <string>
@@ -16,12 +17,20 @@ namespace llvm { class raw_ostream; }
 namespace csabase
 {
 class Location
+    // The expansion location of a source location.  The file name, line, and
+    // column (which honor '#line' directives) are computed only when first
+    // asked for, since most users need only the file.
 {
 private:
-    std::string           d_file;
-    size_t                d_line;
-    size_t                d_column;
-    clang::SourceLocation d_location;
+    clang::SourceManager const *d_manager;
+    clang::SourceLocation       d_location;
+    clang::FileID               d_file_id;
+    mutable const char         *d_file;      // 0 until computed
+    mutable size_t              d_line;
+    mutable size_t              d_column;
+
+    void resolve() const;
+        // Compute the file name, line, and column.
 
 public:
     Location();
@@ -30,10 +39,11 @@ public:
     Location(const Location&) = default;
     Location& operator=(const Location&) = default;
 
-    std::string           file() const;
+    llvm::StringRef       file() const;
     size_t                line() const;
     size_t                column() const;
     clang::SourceLocation location() const;
+    clang::FileID         file_id() const;
 
     bool operator< (Location const& location) const;
     operator bool() const;
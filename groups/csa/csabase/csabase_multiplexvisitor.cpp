@@ -0,0 +1,233 @@
+// csabase_multiplexvisitor.cpp                                       -*-C++-*-
+
+#include <csabase_multiplexvisitor.h>
+#include <csabase_parentindex.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/Stmt.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+#include <utility>
+
+using namespace csabase;
+using namespace clang;
+
+// ----------------------------------------------------------------------------
+
+csabase::MultiplexVisitor::Pass::~Pass()
+{
+}
+
+csabase::MultiplexVisitor::MultiplexVisitor()
+: d_parents(0)
+, d_indexing(false)
+, d_active(0)
+, d_stopped(0)
+, d_nodes(0)
+, d_observed(0)
+{
+}
+
+void csabase::MultiplexVisitor::add(std::string const&    name,
+                                    std::unique_ptr<Pass> pass,
+                                    Prune const&          prune)
+{
+    Entry entry;
+    entry.d_name    = name;
+    entry.d_pass    = std::move(pass);
+    entry.d_prune   = prune;
+    entry.d_pruning = false;
+    entry.d_stopped = false;
+    entry.d_visits  = 0;
+    entry.d_pruned  = 0;
+    d_passes.push_back(std::move(entry));
+    ++d_active;
+}
+
+void csabase::MultiplexVisitor::observe(Observer const& observer)
+{
+    d_observer = observer;
+}
+
+void csabase::MultiplexVisitor::index(ParentIndex  *parents,
+                                      Prune const&  prune)
+{
+    d_parents       = parents;
+    d_parents_prune = prune;
+}
+
+void csabase::MultiplexVisitor::print(llvm::raw_ostream& out) const
+{
+    out << "  Nodes walked once for " << d_passes.size() << " pass"
+        << (d_passes.size() == 1 ? "" : "es")
+        << ", and declarations and statements observed and indexed:\n\n"
+        << llvm::format("%10u%10u%10u",
+                        d_nodes,
+                        d_observed,
+                        unsigned(d_parents ? d_parents->size() : 0))
+        << "\n\n"
+        << "  Nodes seen and declarations pruned by each pass:\n\n";
+    unsigned total = 0;
+    for (const auto& entry : d_passes) {
+        total += entry.d_visits;
+        out << llvm::format("%10u%10u", entry.d_visits, entry.d_pruned)
+            << "  " << entry.d_name << "\n";
+    }
+    out << llvm::format("%10u", total) << "            Total\n\n"
+        << "  Nodes walked by separate traversals for the passes, and by the "
+        << "shared one:\n\n"
+        << llvm::format("%10u%10u", total, d_nodes) << "\n\n";
+}
+
+void csabase::MultiplexVisitor::pruned(
+                               std::map<std::string, unsigned> *counts) const
+{
+    for (const auto& entry : d_passes) {
+        if (entry.d_prune) {
+            (*counts)[entry.d_name] += entry.d_pruned;
+        }
+    }
+}
+
+template <class NODE>
+inline
+bool csabase::MultiplexVisitor::fan_out(NODE node, bool (Pass::*hook)(NODE))
+{
+    ++d_nodes;
+    for (auto& entry : d_passes) {
+        if (!entry.d_pruning && !entry.d_stopped) {
+            ++entry.d_visits;
+            if (!(entry.d_pass.get()->*hook)(node)) {
+                entry.d_stopped = true;
+                --d_active;
+                ++d_stopped;
+            }
+        }
+    }
+    return d_observer || d_parents || d_stopped < d_passes.size();
+}
+
+bool csabase::MultiplexVisitor::TraverseDecl(Decl *decl)
+{
+    if (!decl || decl->isImplicit()) {
+        return Base::TraverseDecl(decl);                              // RETURN
+    }
+
+    ast_type_traits::DynTypedNode node =
+                                  ast_type_traits::DynTypedNode::create(*decl);
+    if (d_observer) {
+        ++d_observed;
+        d_observer(node);
+    }
+
+    // Passes that prune 'decl' see nothing until it has been walked, and
+    // neither it nor its contents are indexed if the index prunes it.
+    llvm::SmallVector<Entry *, 8> pruning;
+    bool indexing = d_indexing;
+    if (llvm::isa<TranslationUnitDecl>(decl)) {
+        d_indexing = d_parents != 0;
+    }
+    else {
+        for (auto& entry : d_passes) {
+            if (!entry.d_pruning &&
+                !entry.d_stopped &&
+                entry.d_prune &&
+                entry.d_prune(decl)) {
+                entry.d_pruning = true;
+                ++entry.d_pruned;
+                pruning.push_back(&entry);
+            }
+        }
+        if (d_indexing) {
+            if (d_parents_prune && d_parents_prune(decl)) {
+                d_indexing = false;
+            }
+            else {
+                d_parents->add(node, d_parent);
+            }
+        }
+    }
+    d_active -= pruning.size();
+
+    ast_type_traits::DynTypedNode parent = d_parent;
+    d_parent = node;
+
+    bool result = (d_active == 0 && !d_observer && !d_indexing) ||
+                  Base::TraverseDecl(decl);
+
+    d_parent = parent;
+    d_indexing = indexing;
+    for (auto entry : pruning) {
+        entry->d_pruning = false;
+    }
+    d_active += pruning.size();
+    return result;
+}
+
+bool csabase::MultiplexVisitor::TraverseStmt(Stmt *stmt)
+{
+    if (!stmt) {
+        return Base::TraverseStmt(stmt);                              // RETURN
+    }
+
+    if (d_observer) {
+        ++d_observed;
+        d_observer(ast_type_traits::DynTypedNode::create(*stmt));
+    }
+    if (d_indexing) {
+        d_parents->add(ast_type_traits::DynTypedNode::create(*stmt), d_parent);
+    }
+
+    ast_type_traits::DynTypedNode parent = d_parent;
+    bool result = Base::TraverseStmt(stmt);
+    d_parent = parent;
+    return result;
+}
+
+#define DECL(CLASS, BASE)                                                     \
+    bool csabase::MultiplexVisitor::WalkUpFrom##CLASS##Decl(                  \
+                                                      CLASS##Decl *decl)      \
+    {                                                                         \
+        return fan_out(decl, &Pass::WalkUpFrom##CLASS##Decl);                 \
+    }
+#include "clang/AST/DeclNodes.inc"  // IWYU pragma: keep
+
+#define STMT(CLASS, PARENT)                                                   \
+    bool csabase::MultiplexVisitor::WalkUpFrom##CLASS(CLASS *stmt)            \
+    {                                                                         \
+        if (d_indexing) {                                                     \
+            d_parent = ast_type_traits::DynTypedNode::create<Stmt>(*stmt);    \
+        }                                                                     \
+        return fan_out(stmt, &Pass::WalkUpFrom##CLASS);                       \
+    }
+#include "clang/AST/StmtNodes.inc"  // IWYU pragma: keep
+
+#define TYPE(CLASS, BASE)                                                     \
+    bool csabase::MultiplexVisitor::WalkUpFrom##CLASS##Type(                  \
+                                                      CLASS##Type *type)      \
+    {                                                                         \
+        return fan_out(type, &Pass::WalkUpFrom##CLASS##Type);                 \
+    }                                                                         \
+    bool csabase::MultiplexVisitor::WalkUpFrom##CLASS##TypeLoc(               \
+                                                      CLASS##TypeLoc tl)      \
+    {                                                                         \
+        return fan_out(tl, &Pass::WalkUpFrom##CLASS##TypeLoc);                \
+    }
+#include "clang/AST/TypeNodes.def"  // IWYU pragma: keep
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
@@ -0,0 +1,249 @@
+// csabase_multiplexvisitor.h                                         -*-C++-*-
+
+#ifndef INCLUDED_CSABASE_MULTIPLEXVISITOR
+#define INCLUDED_CSABASE_MULTIPLEXVISITOR
+
+#include <clang/AST/ASTTypeTraits.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clang { class Decl; }
+namespace clang { class Stmt; }
+namespace csabase { class ParentIndex; }
+namespace llvm { class raw_ostream; }
+
+// ----------------------------------------------------------------------------
+
+namespace csabase
+{
+class MultiplexVisitor : public clang::RecursiveASTVisitor<MultiplexVisitor>
+    // This class walks a translation unit once on behalf of several passes,
+    // each of which is a 'RecursiveASTVisitor' that would otherwise walk the
+    // translation unit itself.  A pass may use the 'Visit*' and 'WalkUpFrom*'
+    // hooks of declarations, statements, types, and type locations, but must
+    // not override the 'Traverse*' functions or the traversal policy.  At
+    // each node, the 'WalkUpFrom*' hook of the class of the node is called on
+    // each pass in the order in which the passes were added, so each pass
+    // sees the nodes it would see in its own traversal, in the same order.  A
+    // pass whose hook returns 'false' sees no more nodes.  A pass may prune
+    // declarations, and sees nothing within those it prunes; declarations
+    // that every pass prunes are not walked at all unless there is an
+    // observer or they are indexed.  Like each pass, the walk does not enter
+    // template instantiations or implicit code.
+{
+  public:
+    typedef clang::RecursiveASTVisitor<MultiplexVisitor> Base;
+
+    typedef std::function<bool(clang::Decl const*)> Prune;
+
+    typedef std::function<void(clang::ast_type_traits::DynTypedNode const&)>
+        Observer;
+
+    class Pass
+        // This class is the interface through which the hooks of a pass are
+        // called.
+    {
+      public:
+        virtual ~Pass();
+
+#define DECL(CLASS, BASE)                                                     \
+        virtual bool WalkUpFrom##CLASS##Decl(clang::CLASS##Decl *decl) = 0;
+#include "clang/AST/DeclNodes.inc"  // IWYU pragma: keep
+
+#define STMT(CLASS, PARENT)                                                   \
+        virtual bool WalkUpFrom##CLASS(clang::CLASS *stmt) = 0;
+#include "clang/AST/StmtNodes.inc"  // IWYU pragma: keep
+
+#define TYPE(CLASS, BASE)                                                     \
+        virtual bool WalkUpFrom##CLASS##Type(clang::CLASS##Type *type) = 0;  \
+        virtual bool WalkUpFrom##CLASS##TypeLoc(clang::CLASS##TypeLoc tl) = 0;
+#include "clang/AST/TypeNodes.def"  // IWYU pragma: keep
+    };
+
+    template <class VISITOR>
+    class Adapter;
+        // This class calls the hooks of a pass of type 'VISITOR'.
+
+    MultiplexVisitor();
+
+    template <class VISITOR>
+    void add(std::string const& name,
+             VISITOR const&     visitor,
+             Prune const&       prune = Prune());
+        // Add, under the specified 'name', a pass that calls the hooks of a
+        // copy of the specified 'visitor'.  Optionally specify 'prune', a
+        // predicate that returns 'true' for the declarations the pass does
+        // not want to see, with their contents.
+
+    void observe(Observer const& observer);
+        // Call the specified 'observer' with every declaration and statement
+        // walked, whether or not any pass prunes it, in the order in which a
+        // 'MatchFinder' matches them: a declaration before its contents,
+        // and a statement when the walk of its parent reaches it.
+
+    void index(ParentIndex *parents, Prune const& prune = Prune());
+        // Record in the specified 'parents' the parent of every declaration
+        // and statement walked, as the walk reaches it.  Optionally specify
+        // 'prune', a predicate that returns 'true' for the declarations that
+        // are not to be recorded, with their contents.
+
+    bool empty() const;
+        // Return 'true' if no passes, no observer, and no index have been
+        // added, and 'false' otherwise.
+
+    void print(llvm::raw_ostream& out) const;
+        // Write to the specified 'out' the number of nodes walked, observed,
+        // and indexed, and for each pass, the number of nodes it saw and the
+        // number of declarations it pruned.  The nodes seen by all the passes
+        // are those that walking the translation unit separately for each
+        // pass would visit, and are shown beside the nodes walked.
+
+    void pruned(std::map<std::string, unsigned> *counts) const;
+        // For each pass that prunes declarations, add the number it pruned
+        // to the element of the specified 'counts' named for the pass.
+
+    bool TraverseDecl(clang::Decl *decl);
+        // Walk the specified 'decl' for the observer, the index, and the
+        // passes that do not prune it, if there are any.
+
+    bool TraverseStmt(clang::Stmt *stmt);
+        // Observe, index, and walk the specified 'stmt'.  Because this is
+        // overridden, 'RecursiveASTVisitor' calls it for each statement
+        // rather than queueing statements for data recursion.
+
+#define DECL(CLASS, BASE)                                                     \
+    bool WalkUpFrom##CLASS##Decl(clang::CLASS##Decl *decl);
+#include "clang/AST/DeclNodes.inc"  // IWYU pragma: keep
+
+#define STMT(CLASS, PARENT)                                                   \
+    bool WalkUpFrom##CLASS(clang::CLASS *stmt);
+#include "clang/AST/StmtNodes.inc"  // IWYU pragma: keep
+
+#define TYPE(CLASS, BASE)                                                     \
+    bool WalkUpFrom##CLASS##Type(clang::CLASS##Type *type);                   \
+    bool WalkUpFrom##CLASS##TypeLoc(clang::CLASS##TypeLoc tl);
+#include "clang/AST/TypeNodes.def"  // IWYU pragma: keep
+        // Call the hook for the class of the specified node on each pass
+        // that is not pruning or stopped, and return 'false' only when every
+        // pass has stopped and there is no observer or index.  A statement
+        // is the parent of those the walk reaches until the next call.
+
+  private:
+    struct Entry
+        // A pass and its state.
+    {
+        std::string           d_name;     // name of the pass
+        std::unique_ptr<Pass> d_pass;     // hooks of the pass
+        Prune                 d_prune;    // declarations not wanted
+        bool                  d_pruning;  // within a pruned declaration
+        bool                  d_stopped;  // a hook returned 'false'
+        unsigned              d_visits;   // nodes seen
+        unsigned              d_pruned;   // declarations pruned
+    };
+
+    void add(std::string const&    name,
+             std::unique_ptr<Pass> pass,
+             Prune const&          prune);
+        // Add the specified 'pass' under the specified 'name', pruning the
+        // declarations for which the specified 'prune' returns 'true'.
+
+    template <class NODE>
+    bool fan_out(NODE node, bool (Pass::*hook)(NODE));
+        // Call the specified 'hook' with the specified 'node' on each pass
+        // that is not pruning or stopped, and return 'false' only when every
+        // pass has stopped and there is no observer or index.
+
+    std::vector<Entry>                    d_passes;
+    Observer                              d_observer;
+    ParentIndex                          *d_parents;
+    Prune                                 d_parents_prune;
+    bool                                  d_indexing;  // not pruned
+    clang::ast_type_traits::DynTypedNode  d_parent;    // of nodes reached
+    unsigned                              d_active;    // passes neither
+                                                       // pruning nor stopped
+    unsigned                              d_stopped;   // passes stopped
+    unsigned                              d_nodes;     // nodes walked
+    unsigned                              d_observed;  // nodes observed
+};
+
+// ----------------------------------------------------------------------------
+
+template <class VISITOR>
+class MultiplexVisitor::Adapter : public MultiplexVisitor::Pass
+{
+  public:
+    explicit Adapter(VISITOR const& visitor);
+
+#define DECL(CLASS, BASE)                                                     \
+    bool WalkUpFrom##CLASS##Decl(clang::CLASS##Decl *decl) override           \
+    {                                                                         \
+        return d_visitor.WalkUpFrom##CLASS##Decl(decl);                       \
+    }
+#include "clang/AST/DeclNodes.inc"  // IWYU pragma: keep
+
+#define STMT(CLASS, PARENT)                                                   \
+    bool WalkUpFrom##CLASS(clang::CLASS *stmt) override                       \
+    {                                                                         \
+        return d_visitor.WalkUpFrom##CLASS(stmt);                             \
+    }
+#include "clang/AST/StmtNodes.inc"  // IWYU pragma: keep
+
+#define TYPE(CLASS, BASE)                                                     \
+    bool WalkUpFrom##CLASS##Type(clang::CLASS##Type *type) override           \
+    {                                                                         \
+        return d_visitor.WalkUpFrom##CLASS##Type(type);                       \
+    }                                                                         \
+    bool WalkUpFrom##CLASS##TypeLoc(clang::CLASS##TypeLoc tl) override        \
+    {                                                                         \
+        return d_visitor.WalkUpFrom##CLASS##TypeLoc(tl);                      \
+    }
+#include "clang/AST/TypeNodes.def"  // IWYU pragma: keep
+
+  private:
+    VISITOR d_visitor;
+};
+
+template <class VISITOR>
+inline
+MultiplexVisitor::Adapter<VISITOR>::Adapter(VISITOR const& visitor)
+: d_visitor(visitor)
+{
+}
+
+template <class VISITOR>
+inline
+void MultiplexVisitor::add(std::string const& name,
+                           VISITOR const&     visitor,
+                           Prune const&       prune)
+{
+    add(name, std::unique_ptr<Pass>(new Adapter<VISITOR>(visitor)), prune);
+}
+
+inline
+bool MultiplexVisitor::empty() const
+{
+    return d_passes.empty() && !d_observer && !d_parents;
+}
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
@@ -0,0 +1,35 @@
+// csabase_parentindex.cpp                                            -*-C++-*-
+
+#include <csabase_parentindex.h>
+#include <utility>
+
+using namespace csabase;
+using namespace clang;
+
+// ----------------------------------------------------------------------------
+
+void csabase::ParentIndex::add(Node const& node, Node const& parent)
+{
+    d_parents.insert(std::make_pair(node.getMemoizationData(), parent));
+}
+
+bool csabase::ParentIndex::contains(Node const& node) const
+{
+    return d_parents.count(node.getMemoizationData()) != 0;
+}
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
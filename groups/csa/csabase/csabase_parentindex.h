@@ -0,0 +1,84 @@
+// csabase_parentindex.h                                              -*-C++-*-
+
+#ifndef INCLUDED_CSABASE_PARENTINDEX
+#define INCLUDED_CSABASE_PARENTINDEX
+
+#include <clang/AST/ASTTypeTraits.h>
+#include <llvm/ADT/DenseMap.h>
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+namespace csabase
+{
+class ParentIndex
+    // This class records the parent of each declaration and statement added
+    // to it, so that the nearest ancestor of a given type can be found in
+    // time proportional to its depth, without the parent map of the whole
+    // translation unit that 'clang::ASTContext::getParents' builds.
+{
+  public:
+    typedef clang::ast_type_traits::DynTypedNode Node;
+
+    void add(Node const& node, Node const& parent);
+        // Record the specified 'parent' as that of the specified 'node',
+        // unless a parent has already been recorded for 'node'.
+
+    bool contains(Node const& node) const;
+        // Return 'true' if the parent of the specified 'node' has been
+        // recorded, and 'false' otherwise.
+
+    template <class Parent>
+    Parent const* get(Node const& node) const;
+        // Return the nearest recorded ancestor of the specified 'node' that
+        // is of the 'Parent' type, and 0 if there is none.
+
+    std::size_t size() const;
+        // Return the number of nodes whose parents have been recorded.
+
+  private:
+    typedef llvm::DenseMap<void const*, Node> Parents;
+
+    Parents d_parents;  // parents, keyed by the nodes' memoization data
+};
+
+// ----------------------------------------------------------------------------
+
+template <class Parent>
+inline
+Parent const* ParentIndex::get(Node const& node) const
+{
+    for (auto i = d_parents.find(node.getMemoizationData());
+         i != d_parents.end();
+         i = d_parents.find(i->second.getMemoizationData())) {
+        if (Parent const* p = i->second.template get<Parent>()) {
+            return p;                                                 // RETURN
+        }
+    }
+    return 0;
+}
+
+inline
+std::size_t ParentIndex::size() const
+{
+    return d_parents.size();
+}
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
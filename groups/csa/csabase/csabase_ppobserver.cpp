@@ -7,6 +7,7 @@
 #include <csabase_debug.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/Support/Regex.h>
+#include <string.h>
 #include <csabase_config.h>
 #include <utils/event.hpp>
 
@@ -81,9 +82,10 @@ void csabase::PPObserver::do_include_file(SourceLocation location,
                                           bool is_angled,
                                           std::string const& file)
 {
-    std::string msg("do_include_file '" + file + "' angled=" +
-                    (is_angled ? "true" : "false"));
-    Debug d(msg.c_str());
+    Debug d([&] {
+        return "do_include_file '" + file + "' angled=" +
+               (is_angled ? "true" : "false");
+    });
     onInclude(location, is_angled, file);
 }
 
@@ -91,8 +93,7 @@ void csabase::PPObserver::do_open_file(SourceLocation location,
                                        std::string const& from,
                                        std::string const& file)
 {
-    std::string msg("do_open_file '" + file + "'");
-    Debug d(msg.c_str());
+    Debug d([&] { return "do_open_file '" + file + "'"; });
     onOpenFile(location, from, file);
 }
 
@@ -100,31 +101,27 @@ void csabase::PPObserver::do_close_file(SourceLocation location,
                                         std::string const& from,
                                         std::string const& file)
 {
-    std::string msg("do_close_file '" + file + "'");
-    Debug d(msg.c_str());
+    Debug d([&] { return "do_close_file '" + file + "'"; });
     onCloseFile(location, from, file);
 }
 
 void csabase::PPObserver::do_skip_file(std::string const& from,
                                        std::string const& file)
 {
-    std::string msg("do_skip_file(" + from + ", " + file + ")");
-    Debug d(msg.c_str());
+    Debug d([&] { return "do_skip_file(" + from + ", " + file + ")"; });
     onSkipFile(from, file);
 }
 
 void csabase::PPObserver::do_file_not_found(std::string const& file)
 {
-    std::string msg("do_file_not_found(" + file + ")");
-    Debug d(msg.c_str());
+    Debug d([&] { return "do_file_not_found(" + file + ")"; });
     onFileNotFound(file);
 }
 
 void csabase::PPObserver::do_other_file(std::string const& file,
                                         PPCallbacks::FileChangeReason reason)
 {
-    std::string msg("do_other_file '" + file + "'");
-    Debug d(msg.c_str());
+    Debug d([&] { return "do_other_file '" + file + "'"; });
     onOtherFile(file, reason);
 }
 
@@ -311,6 +308,47 @@ static llvm::Regex comment_bdeverify(
     ")",
     llvm::Regex::NoFlags);
 
+static bool may_be_bv_pragma(const SourceManager& m,
+                             SourceRange          range,
+                             llvm::StringRef      word)
+    // Return 'false' if the text of the specified 'range' (or, if the range
+    // has no end, the rest of its line) does not contain the specified
+    // 'word', and so cannot be a pragma.  This scans the raw text with
+    // 'memchr', and spares nearly every comment and '#pragma' the line
+    // lookups and regular expression match of 'handle_bv_pragma'.
+{
+    if (!range.getBegin().isFileID()) {
+        return true;                                                  // RETURN
+    }
+    std::pair<FileID, unsigned> begin = m.getDecomposedLoc(range.getBegin());
+    bool invalid = false;
+    llvm::StringRef text = m.getBufferData(begin.first, &invalid);
+    if (invalid) {
+        return true;                                                  // RETURN
+    }
+    text = text.drop_front(begin.second);
+    std::pair<FileID, unsigned> end(FileID(), 0);
+    if (range.getEnd().isValid() && range.getEnd().isFileID()) {
+        end = m.getDecomposedLoc(range.getEnd());
+    }
+    if (end.first == begin.first && end.second >= begin.second) {
+        text = text.substr(0, end.second - begin.second);
+    }
+    else if (const void *eol = memchr(text.data(), '\n', text.size())) {
+        text = text.substr(0, static_cast<const char *>(eol) - text.data());
+    }
+
+    const char *e = text.end();
+    for (const char *p = text.begin();
+         (p = static_cast<const char *>(memchr(p, word[0], e - p)));
+         ++p) {
+        if (llvm::StringRef(p, e - p).startswith(word)) {
+            return true;                                              // RETURN
+        }
+    }
+    return false;
+}
+
 static bool handle_bv_pragma(const SourceManager&  m,
                              Config               *c,
                              SourceLocation        l,
@@ -352,7 +390,9 @@ void csabase::PPObserver::do_comment(SourceRange range)
 {
     Debug d("do_comment");
 
-    if (!handle_bv_pragma(
+    if (!may_be_bv_pragma(*source_manager_, range, "VERIFY") ||
+        !is_pragma_file(range.getBegin()) ||
+        !handle_bv_pragma(
             *source_manager_, config_, range.getBegin(), comment_bdeverify)) {
         onComment(range);
     }
@@ -361,12 +401,27 @@ void csabase::PPObserver::do_comment(SourceRange range)
 void csabase::PPObserver::PragmaDirective(SourceLocation location,
                                           PragmaIntroducerKind introducer)
 {
-    if (!handle_bv_pragma(
+    SourceRange line(location, SourceLocation());
+    if (!may_be_bv_pragma(*source_manager_, line, "verify") ||
+        !is_pragma_file(location) ||
+        !handle_bv_pragma(
             *source_manager_, config_, location, pragma_bdeverify)) {
         onPPPragmaDirective(location, introducer);
     }
 }
 
+void csabase::PPObserver::pragma_files(
+                        std::function<bool(clang::FileID)> const& predicate)
+{
+    pragma_files_ = predicate;
+}
+
+bool csabase::PPObserver::is_pragma_file(SourceLocation location) const
+{
+    return !pragma_files_ ||
+           pragma_files_(source_manager_->getFileID(location));
+}
+
 void csabase::PPObserver::PragmaComment(SourceLocation location,
                                         IdentifierInfo const *id,
                                         llvm::StringRef value)
@@ -11,6 +11,7 @@
 #include <clang/Lex/Pragma.h>
 #include <llvm/ADT/ArrayRef.h>
 #include <llvm/ADT/StringRef.h>
+#include <functional>
 #include <stack>
 #include <string>
 #include <utils/event.hpp>
@@ -37,6 +38,10 @@ public:
     ~PPObserver();
     void detach();
     clang::CommentHandler* get_comment_handler();
+    void pragma_files(std::function<bool(clang::FileID)> const& predicate);
+        // Handle 'bde_verify' pragmas only in files for which the specified
+        // 'predicate' returns 'true' (by default, in all files).  Pragmas in
+        // other files are passed on as ordinary comments and pragmas.
 
     utils::event<void(clang::SourceLocation, bool, std::string const&)>               onInclude;
     utils::event<
@@ -342,12 +347,15 @@ private:
     void do_endif(clang::SourceLocation, clang::SourceLocation);
     void do_comment(clang::SourceRange);
     void do_context();
+    bool is_pragma_file(clang::SourceLocation) const;
 
     std::string get_file(clang::SourceLocation) const;
     clang::SourceManager const* source_manager_;
     std::stack<std::string> files_;
     bool                    connected_;
     Config*                 config_;
+    std::function<bool(clang::FileID)>
+                            pragma_files_;
 };
 }
 
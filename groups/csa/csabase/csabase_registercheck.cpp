@@ -49,10 +49,12 @@ namespace csabase
 #define REGISTER(D)                                                  \
     template <>                                                      \
     RegisterCheck::RegisterCheck(                                    \
-        std::string const& name, void (*check)(Analyser&, D const*)) \
+        std::string const&     name,                                 \
+        void                 (*check)(Analyser&, D const*),          \
+        CheckRegistry::Scope   scope)                                \
     {                                                                \
         CheckRegistry::add_check(                                    \
-            name, add_to_event<D>(&Visitor::on##D, check));          \
+            name, add_to_event<D>(&Visitor::on##D, check), scope);   \
     }
 
 #define ABSTRACT_DECL(ARG) ARG
@@ -66,10 +68,11 @@ STMT(Stmt, )
 #include "clang/AST/StmtNodes.inc"
 REGISTER(Expr)
 
-RegisterCheck::RegisterCheck(
-    std::string const & name, CheckRegistry::Subscriber subscriber)
+RegisterCheck::RegisterCheck(std::string const&        name,
+                             CheckRegistry::Subscriber subscriber,
+                             CheckRegistry::Scope      scope)
 {
-    CheckRegistry::add_check(name, subscriber);
+    CheckRegistry::add_check(name, subscriber, scope);
 }
 
 }
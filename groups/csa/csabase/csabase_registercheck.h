@@ -3,6 +3,7 @@
 #ifndef INCLUDED_CSABASE_REGISTERCHECK
 #define INCLUDED_CSABASE_REGISTERCHECK
 
+#include <csabase_checkregistry.h>
 #include <string>
 
 namespace utils { template <typename Signature> class function; }
@@ -18,9 +19,22 @@ class RegisterCheck
 {
   public:
     template <typename T>
-    RegisterCheck(std::string const& name, void (*check)(Analyser&, T const*));
-    RegisterCheck(std::string const& name,
-                  utils::function<void(Analyser&, Visitor&, PPObserver&)>);
+    RegisterCheck(std::string const&     name,
+                  void                 (*check)(Analyser&, T const*),
+                  CheckRegistry::Scope   scope =
+                                             CheckRegistry::e_TranslationUnit);
+    RegisterCheck(std::string const&     name,
+                  utils::function<void(Analyser&, Visitor&, PPObserver&)>,
+                  CheckRegistry::Scope   scope =
+                                             CheckRegistry::e_TranslationUnit);
+        // Register the specified 'check' under the specified 'name'.  A
+        // check whose 'scope' is 'CheckRegistry::e_Diagnosable' sees the
+        // events only of declarations in files it can report on (see
+        // 'Analyser::is_diagnosable'), and is spared the traversal of the
+        // rest of the translation unit.  A check whose 'scope' is
+        // 'CheckRegistry::e_Preprocessor' uses only preprocessor events and
+        // comments, and so also runs when the translation unit is only
+        // preprocessed.
 };
 }
 
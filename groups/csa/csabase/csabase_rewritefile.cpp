@@ -0,0 +1,370 @@
+// csabase_rewritefile.cpp                                            -*-C++-*-
+
+#include <csabase_rewritefile.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/JamCRC.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <algorithm>
+#include <map>
+#include <stdint.h>
+
+using namespace csabase;
+using namespace clang::tooling;
+using namespace llvm;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+const char magic[] = "BVRW";
+const size_t header_size = 12;  // magic, body length, body checksum
+
+void put32(std::string *out, uint32_t value)
+    // Append the specified 'value' to the specified 'out' in little-endian
+    // order.
+{
+    char bytes[4];
+    support::endian::write32le(bytes, value);
+    out->append(bytes, sizeof bytes);
+}
+
+bool get32(StringRef *in, uint32_t *value)
+    // Remove a little-endian 32-bit integer from the front of the specified
+    // 'in', load it into the specified 'value', and return 'true', or return
+    // 'false' if 'in' is too short.
+{
+    if (in->size() < 4) {
+        return false;                                                 // RETURN
+    }
+    *value = support::endian::read32le(in->data());
+    *in = in->drop_front(4);
+    return true;
+}
+
+bool get_text(StringRef *in, StringRef *text)
+    // Remove a length-prefixed string from the front of the specified 'in',
+    // load it into the specified 'text', and return 'true' on success.
+{
+    uint32_t size;
+    if (!get32(in, &size) || in->size() < size) {
+        return false;                                                 // RETURN
+    }
+    *text = in->substr(0, size);
+    *in = in->drop_front(size);
+    return true;
+}
+
+uint32_t checksum(StringRef data)
+    // Return the CRC of the specified 'data'.
+{
+    JamCRC crc;
+    crc.update(makeArrayRef(data.data(), data.size()));
+    return crc.getCRC();
+}
+
+bool decode(StringRef body, std::vector<Replacement> *replacements)
+    // Append the actions in the specified record 'body' to the specified
+    // 'replacements' and return 'true', or return 'false', appending
+    // nothing, if 'body' is malformed.
+{
+    std::vector<Replacement> result;
+    while (!body.empty()) {
+        StringRef path;
+        StringRef text;
+        uint32_t  offset;
+        uint32_t  length;
+        if (!get_text(&body, &path) ||
+            !get32(&body, &offset) ||
+            !get32(&body, &length) ||
+            !get_text(&body, &text)) {
+            return false;                                             // RETURN
+        }
+        result.push_back(Replacement(path, offset, length, text));
+    }
+    replacements->insert(replacements->end(), result.begin(), result.end());
+    return true;
+}
+
+void sort_edits(std::vector<RewriteFile::Edit> *edits)
+    // Sort the specified 'edits' by position, with insertions before
+    // replacements at the same offset, keeping the order in which equivalent
+    // actions were made.
+{
+    std::stable_sort(edits->begin(),
+                     edits->end(),
+                     [](RewriteFile::Edit const& a,
+                        RewriteFile::Edit const& b) {
+                         return a.d_offset != b.d_offset
+                             ? a.d_offset < b.d_offset
+                             : a.d_length < b.d_length;
+                     });
+}
+
+void sweep_edits(
+              std::vector<RewriteFile::Edit>                       *edits,
+              bool                                                  join,
+              std::function<void(RewriteFile::Edit const&)> const&  conflict)
+    // Remove from the specified sorted 'edits' each one identical to the
+    // edit before it.  If the specified 'join' is 'true', append the text of
+    // each insertion to that of an insertion at the same offset before it;
+    // otherwise treat it as overlapping.  Remove each edit that overlaps an
+    // earlier one and pass it to the specified 'conflict' function.
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < edits->size(); ++i) {
+        RewriteFile::Edit& edit = (*edits)[i];
+        if (kept > 0) {
+            RewriteFile::Edit& prev = (*edits)[kept - 1];
+            if (edit.d_offset == prev.d_offset &&
+                edit.d_length == prev.d_length &&
+                edit.d_text == prev.d_text) {
+                continue;
+            }
+            if (edit.d_offset == prev.d_offset &&
+                edit.d_length == 0 &&
+                prev.d_length == 0) {
+                if (join) {
+                    prev.d_text += edit.d_text;
+                }
+                else {
+                    conflict(edit);
+                }
+                continue;
+            }
+            if (edit.d_offset < prev.d_offset + prev.d_length) {
+                conflict(edit);
+                continue;
+            }
+        }
+        if (kept != i) {
+            (*edits)[kept] = std::move(edit);
+        }
+        ++kept;
+    }
+    edits->resize(kept);
+}
+
+}
+
+// ----------------------------------------------------------------------------
+
+void RewriteFile::merge(std::vector<Edit>                       *edits,
+                        std::function<void(Edit const&)> const&  conflict)
+{
+    sort_edits(edits);
+    sweep_edits(edits, true, conflict);
+}
+
+void RewriteFile::combine(std::vector<Edit>                       *edits,
+                          std::vector<Edit> const&                 other,
+                          std::function<void(Edit const&)> const&  conflict)
+{
+    // The sort is stable, so edits already present come before those of
+    // 'other' at the same position, and are the ones kept.
+    edits->insert(edits->end(), other.begin(), other.end());
+    sort_edits(edits);
+    sweep_edits(edits, false, conflict);
+}
+
+std::string RewriteFile::encode(Replacements const& replacements)
+{
+    std::string body;
+    for (const auto& r : replacements) {
+        put32(&body, r.getFilePath().size());
+        body += r.getFilePath();
+        put32(&body, r.getOffset());
+        put32(&body, r.getLength());
+        put32(&body, r.getReplacementText().size());
+        body += r.getReplacementText();
+    }
+
+    std::string record(magic);
+    put32(&record, body.size());
+    put32(&record, checksum(body));
+    return record + body;
+}
+
+std::error_code RewriteFile::append(std::string const& path, StringRef record)
+{
+    int             fd;
+    std::error_code error =
+        sys::fs::openFileForWrite(path, fd, sys::fs::F_Append);
+    if (error) {
+        return error;                                                 // RETURN
+    }
+    raw_fd_ostream out(fd, true);
+    out.SetUnbuffered();
+    out << record;
+    out.close();
+    if (out.has_error()) {
+        out.clear_error();
+        return std::make_error_code(std::errc::io_error);             // RETURN
+    }
+    return std::error_code();
+}
+
+bool RewriteFile::read(std::string const&                     path,
+                       std::vector<std::vector<Replacement>> *records,
+                       unsigned                              *damaged)
+{
+    *damaged = 0;
+
+    // Large files are mapped rather than read.
+    ErrorOr<std::unique_ptr<MemoryBuffer>> file =
+        MemoryBuffer::getFile(path, -1, false);
+    if (!file) {
+        return false;                                                 // RETURN
+    }
+
+    StringRef buffer = (*file)->getBuffer();
+    while (!buffer.empty()) {
+        if (buffer.size() >= header_size && buffer.startswith(magic)) {
+            uint32_t size = support::endian::read32le(buffer.data() + 4);
+            uint32_t crc  = support::endian::read32le(buffer.data() + 8);
+            StringRef body = buffer.substr(header_size, size);
+            std::vector<Replacement> replacements;
+            if (body.size() == size &&
+                checksum(body) == crc &&
+                decode(body, &replacements)) {
+                records->push_back(std::move(replacements));
+                buffer = buffer.drop_front(header_size + size);
+                continue;
+            }
+        }
+
+        // Skip to the next thing that looks like a record.
+        ++*damaged;
+        size_t next = buffer.find(magic, 1);
+        buffer = next == StringRef::npos ? StringRef() : buffer.substr(next);
+    }
+    return true;
+}
+
+std::string RewriteFile::rewritten_name(StringRef directory, StringRef file)
+{
+    SmallString<512> path(directory);
+    sys::path::append(path, sys::path::filename(file));
+    return path.str().str() + "-rewritten";
+}
+
+int RewriteFile::apply(std::string const& path,
+                       std::string const& directory,
+                       raw_ostream&       errors)
+{
+    std::vector<std::vector<Replacement>> records;
+    unsigned                              damaged;
+    if (!read(path, &records, &damaged)) {
+        errors << "error: cannot read rewrite file " << path << "\n";
+        return 1;                                                     // RETURN
+    }
+    if (damaged) {
+        errors << "warning: skipped " << damaged << " damaged record"
+               << (damaged == 1 ? "" : "s") << " in " << path << "\n";
+    }
+
+    // Merge the edits of each record on their own, and then combine the
+    // records, so that an edit made by several translation units (in a
+    // header they share) is applied once.
+    std::map<std::string, std::vector<Edit>> files;
+    for (const auto& record : records) {
+        std::map<std::string, std::vector<Edit>> record_files;
+        for (const auto& r : record) {
+            Edit edit = {
+                r.getOffset(), r.getLength(), r.getReplacementText().str()
+            };
+            record_files[r.getFilePath().str()].push_back(edit);
+        }
+        for (auto& file : record_files) {
+            const std::string& name     = file.first;
+            auto               conflict = [&](Edit const& edit) {
+                errors << name << ": warning: rewrite at offset "
+                       << edit.d_offset
+                       << " overlaps an earlier rewrite and is not applied\n";
+            };
+            merge(&file.second, conflict);
+            combine(&files[name], file.second, conflict);
+        }
+    }
+
+    int status = 0;
+    for (auto& file : files) {
+        const std::string& name  = file.first;
+        std::vector<Edit>& edits = file.second;
+
+        ErrorOr<std::unique_ptr<MemoryBuffer>> source =
+            MemoryBuffer::getFile(name);
+        if (!source) {
+            errors << "error: cannot read " << name << "\n";
+            status = 1;
+            continue;
+        }
+        StringRef code = (*source)->getBuffer();
+        if (!edits.empty() &&
+            edits.back().d_offset + edits.back().d_length > code.size()) {
+            errors << "error: rewrites do not fit " << name
+                   << ", which may have changed\n";
+            status = 1;
+            continue;
+        }
+
+        std::string result;
+        size_t      position = 0;
+        result.reserve(code.size());
+        for (const auto& edit : edits) {
+            result.append(code.data() + position, edit.d_offset - position);
+            result += edit.d_text;
+            position = edit.d_offset + edit.d_length;
+        }
+        result.append(code.data() + position, code.size() - position);
+
+        // Write to a temporary file and rename it, so that readers never see
+        // a partial file.
+        std::string      rewritten = rewritten_name(directory, name);
+        int              fd;
+        SmallString<256> temp;
+        if (sys::fs::createUniqueFile(rewritten + "-%%%%%%%%", fd, temp)) {
+            errors << "error: cannot open " << rewritten << " for writing\n";
+            status = 1;
+            continue;
+        }
+        raw_fd_ostream out(fd, true);
+        out << result;
+        out.close();
+        if (out.has_error()) {
+            out.clear_error();
+            sys::fs::remove(temp);
+            errors << "error: cannot write " << rewritten << "\n";
+            status = 1;
+            continue;
+        }
+        if (sys::fs::rename(temp, rewritten)) {
+            sys::fs::remove(temp);
+            errors << "error: cannot rename " << temp << " to " << rewritten
+                   << "\n";
+            status = 1;
+        }
+    }
+    return status;
+}
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
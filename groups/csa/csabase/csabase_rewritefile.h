@@ -0,0 +1,108 @@
+// csabase_rewritefile.h                                              -*-C++-*-
+
+#ifndef INCLUDED_CSABASE_REWRITEFILE
+#define INCLUDED_CSABASE_REWRITEFILE
+
+#include <clang/Tooling/Core/Replacement.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/raw_ostream.h>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace csabase
+{
+class RewriteFile
+    // This class reads and writes rewrite files, which collect the rewriting
+    // actions of any number of translation units, possibly checked by
+    // concurrent processes, so that they can be applied together.  Each
+    // translation unit appends one record, with a single write to the file
+    // opened for appending, so records of concurrent writers do not mix.  A
+    // record is the four bytes "BVRW", the 32-bit little-endian length and
+    // CRC of its body, and the body, which holds, for each action, the
+    // length and text of the file name, the offset and length of the text
+    // replaced, and the length and text of the replacement.  Damaged records
+    // (for example, those still being written) are skipped when reading.
+{
+  public:
+    struct Edit
+        // A rewriting action within a file.
+    {
+        unsigned    d_offset;  // offset of the replaced text
+        unsigned    d_length;  // length of the replaced text
+        std::string d_text;    // replacement text
+    };
+
+    static void merge(std::vector<Edit>                        *edits,
+                      std::function<void(Edit const&)> const&  conflict);
+        // Sort the specified 'edits' made to a single file by one translation
+        // unit by position, removing duplicates and combining insertions at
+        // the same offset in their original order.  Remove each edit that
+        // overlaps an earlier one and pass it to the specified 'conflict'
+        // function.
+
+    static void combine(std::vector<Edit>                        *edits,
+                        std::vector<Edit> const&                  other,
+                        std::function<void(Edit const&)> const&   conflict);
+        // Add to the specified 'edits' the specified 'other' edits, made to
+        // the same file by another translation unit, where both have been
+        // merged.  Drop each edit of 'other' that is identical to one of
+        // 'edits', since both translation units made it (for example, in a
+        // header they share).  Pass each other edit of 'other' that overlaps
+        // one of 'edits', or inserts different text at the same offset, to
+        // the specified 'conflict' function and drop it.
+
+    static std::string encode(
+                         clang::tooling::Replacements const& replacements);
+        // Return a record holding the specified 'replacements'.
+
+    static std::error_code append(std::string const& path,
+                                  llvm::StringRef    record);
+        // Append the specified 'record' to the rewrite file with the
+        // specified 'path', creating it if need be.
+
+    static bool read(
+           std::string const&                                      path,
+           std::vector<std::vector<clang::tooling::Replacement>>  *records,
+           unsigned                                               *damaged);
+        // Load the actions of each record in the rewrite file with the
+        // specified 'path' into an element of the specified 'records', and
+        // the number of damaged records skipped into the specified
+        // 'damaged'.  Return 'false' if the file cannot be read.
+
+    static std::string rewritten_name(llvm::StringRef directory,
+                                      llvm::StringRef file);
+        // Return the name of the file in the specified 'directory' that
+        // holds the rewritten version of the specified 'file'.
+
+    static int apply(std::string const& path,
+                     std::string const& directory,
+                     llvm::raw_ostream& errors);
+        // Merge the actions of each record in the rewrite file with the
+        // specified 'path', combine the records, and write each file they
+        // affect, with its actions applied once, into the specified
+        // 'directory'.  Report problems to the specified 'errors'.  Return 0
+        // on success and 1 otherwise.
+};
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
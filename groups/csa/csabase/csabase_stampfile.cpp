@@ -0,0 +1,350 @@
+// csabase_stampfile.cpp                                              -*-C++-*-
+
+#include <csabase_stampfile.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+
+using namespace csabase;
+using namespace llvm;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+const char header[] = "bde_verify-stamps ";
+
+const int64_t granularity = 1000000000;
+    // The coarsest modification time resolution, in nanoseconds, of the file
+    // systems expected to hold checked files.
+
+std::string md5(StringRef data)
+    // Return the MD5 hash of the specified 'data' as a hex string.
+{
+    MD5 hasher;
+    hasher.update(data);
+    MD5::MD5Result result;
+    hasher.final(result);
+    SmallString<32> hex;
+    MD5::stringifyResult(result, hex);
+    return hex.str();
+}
+
+bool next_line(StringRef *buffer, StringRef *line)
+    // Remove the first line of the specified 'buffer', load it without its
+    // newline into the specified 'line', and return 'true', or return
+    // 'false' if 'buffer' does not contain a complete line.
+{
+    size_t eol = buffer->find('\n');
+    if (eol == StringRef::npos) {
+        return false;                                                 // RETURN
+    }
+    *line = buffer->substr(0, eol);
+    *buffer = buffer->substr(eol + 1);
+    return true;
+}
+
+bool next_field(StringRef *line, StringRef *field)
+    // Remove the first space-separated field of the specified 'line', load
+    // it into the specified 'field', and return 'true' if it is not empty.
+{
+    std::pair<StringRef, StringRef> split = line->split(' ');
+    *field = split.first;
+    *line = split.second;
+    return !field->empty();
+}
+
+}
+
+thread_local std::vector<std::string> *StampFile::s_dependencies;
+
+// ----------------------------------------------------------------------------
+
+StampFile::StampFile(std::string const& path, std::string const& version)
+: d_path(path)
+, d_version(version)
+{
+}
+
+bool StampFile::read()
+{
+    ErrorOr<std::unique_ptr<MemoryBuffer>> file =
+        MemoryBuffer::getFile(d_path);
+    if (!file) {
+        return file.getError() == std::errc::no_such_file_or_directory;
+                                                                      // RETURN
+    }
+
+    StringRef buffer = (*file)->getBuffer();
+    StringRef line;
+    if (!next_line(&buffer, &line) ||
+        !line.startswith(header) ||
+        line.substr(sizeof header - 1) != d_version) {
+        return true;                                                  // RETURN
+    }
+
+    while (next_line(&buffer, &line)) {
+        StringRef tag, key, count, length;
+        unsigned  ndeps;
+        size_t    nout;
+        if (!next_field(&line, &tag) || tag != "tu" ||
+            !next_field(&line, &key) ||
+            !next_field(&line, &count) || count.getAsInteger(10, ndeps) ||
+            !next_field(&line, &length) || length.getAsInteger(10, nout)) {
+            return false;                                             // RETURN
+        }
+        Entry entry;
+        for (unsigned i = 0; i < ndeps; ++i) {
+            StringRef  size, time, hash;
+            Dependency dependency;
+            if (!next_line(&buffer, &line) ||
+                !next_field(&line, &size) ||
+                size.getAsInteger(10, dependency.d_size) ||
+                !next_field(&line, &time) ||
+                time.getAsInteger(10, dependency.d_time) ||
+                !next_field(&line, &hash) ||
+                line.empty()) {
+                return false;                                         // RETURN
+            }
+            dependency.d_hash = hash.str();
+            dependency.d_path = line.str();
+            entry.d_dependencies.push_back(dependency);
+        }
+        if (buffer.size() < nout + 1 || buffer[nout] != '\n') {
+            return false;                                             // RETURN
+        }
+        entry.d_output = buffer.substr(0, nout).str();
+        buffer = buffer.substr(nout + 1);
+        d_entries[key.str()] = std::move(entry);
+    }
+    return buffer.empty();
+}
+
+bool StampFile::write()
+{
+    std::lock_guard<std::mutex> guard(d_mutex);
+
+    int               fd;
+    SmallString<256>  temp;
+    std::error_code   error =
+        sys::fs::createUniqueFile(d_path + "-%%%%%%%%", fd, temp);
+    if (error) {
+        return false;                                                 // RETURN
+    }
+    {
+        raw_fd_ostream out(fd, true);
+        out << header << d_version << "\n";
+        for (const auto& entry : d_entries) {
+            const Entry& e = entry.second;
+            out << "tu " << entry.first << " " << e.d_dependencies.size()
+                << " " << e.d_output.size() << "\n";
+            for (const auto& d : e.d_dependencies) {
+                out << d.d_size << " " << d.d_time << " " << d.d_hash << " "
+                    << d.d_path << "\n";
+            }
+            out << e.d_output << "\n";
+        }
+        out.close();
+        if (out.has_error()) {
+            out.clear_error();
+            sys::fs::remove(temp);
+            return false;                                             // RETURN
+        }
+    }
+    return !sys::fs::rename(temp, d_path);
+}
+
+std::string StampFile::key(ArrayRef<const char *> args)
+{
+    std::string all;
+    for (const char *arg : args) {
+        all += arg;
+        all += '\0';
+    }
+    return md5(all);
+}
+
+bool StampFile::lookup(std::string const& key, std::string *output)
+{
+    std::lock_guard<std::mutex> guard(d_mutex);
+
+    auto it = d_entries.find(key);
+    if (it == d_entries.end()) {
+        return false;                                                 // RETURN
+    }
+    for (const auto& dependency : it->second.d_dependencies) {
+        if (!current(dependency)) {
+            d_entries.erase(it);
+            return false;                                             // RETURN
+        }
+    }
+    *output = it->second.d_output;
+    return true;
+}
+
+void StampFile::record(std::string const&              key,
+                       std::vector<std::string> const& dependencies,
+                       std::string const&              output,
+                       int64_t                         started)
+{
+    std::lock_guard<std::mutex> guard(d_mutex);
+
+    Entry entry;
+    for (const auto& path : dependencies) {
+        Dependency dependency;
+        dependency.d_path = path;
+        if (!hash(&dependency) || dependency.d_time > started - granularity) {
+            // A translation unit with unreadable dependencies can't be
+            // validated later, and one with dependencies that may have
+            // changed while it was checked can't be trusted, so neither is
+            // recorded.
+            d_entries.erase(key);
+            return;                                                   // RETURN
+        }
+        entry.d_dependencies.push_back(dependency);
+    }
+    entry.d_output = output;
+    d_entries[key] = entry;
+}
+
+int64_t StampFile::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+void StampFile::collect_dependencies(std::vector<std::string> *files)
+{
+    s_dependencies = files;
+}
+
+void StampFile::note_dependency(StringRef file)
+{
+    if (s_dependencies) {
+        SmallString<256> path(file);
+        sys::fs::make_absolute(path);
+        sys::path::remove_dots(path, true);
+        s_dependencies->push_back(path.str());
+    }
+}
+
+bool StampFile::stat(std::string const& path, uint64_t *size, int64_t *time)
+{
+    sys::fs::file_status status;
+    if (sys::fs::status(path, status)) {
+        return false;                                                 // RETURN
+    }
+    *size = status.getSize();
+    *time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                status.getLastModificationTime().time_since_epoch())
+                .count();
+    return true;
+}
+
+bool StampFile::hash(Dependency *dependency)
+{
+    std::string const& path = dependency->d_path;
+    uint64_t           size;
+    int64_t            time;
+    if (!stat(path, &size, &time)) {
+        return false;                                                 // RETURN
+    }
+    auto it = d_hashes.find(path);
+    if (it != d_hashes.end() &&
+        it->second.d_size == size &&
+        it->second.d_time == time) {
+        *dependency = it->second;
+        return true;                                                  // RETURN
+    }
+
+    std::string value;
+    if (sys::fs::is_directory(path)) {
+        std::vector<std::string> names;
+        std::error_code          error;
+        for (sys::fs::directory_iterator entry(path, error), end;
+             !error && entry != end;
+             entry.increment(error)) {
+            names.push_back(sys::path::filename(entry->path()));
+        }
+        if (error) {
+            return false;                                             // RETURN
+        }
+        std::sort(names.begin(), names.end());
+        std::string all;
+        for (const auto& name : names) {
+            all += name;
+            all += '\n';
+        }
+        value = md5(all);
+    }
+    else {
+        ErrorOr<std::unique_ptr<MemoryBuffer>> file =
+            MemoryBuffer::getFile(path);
+        if (!file) {
+            return false;                                             // RETURN
+        }
+        value = md5((*file)->getBuffer());
+    }
+
+    // A file whose size or time differs after reading it changed while it
+    // was read, so the hash may describe neither version.
+    uint64_t after_size;
+    int64_t  after_time;
+    if (!stat(path, &after_size, &after_time) ||
+        after_size != size ||
+        after_time != time) {
+        return false;                                                 // RETURN
+    }
+
+    dependency->d_size = size;
+    dependency->d_time = time;
+    dependency->d_hash = value;
+    if (time <= now() - granularity) {
+        // A file modified more recently than that may change again without
+        // its time changing, so its hash is not reused.
+        d_hashes[path] = *dependency;
+    }
+    return true;
+}
+
+bool StampFile::current(Dependency const& dependency)
+{
+    uint64_t size;
+    int64_t  time;
+    if (!stat(dependency.d_path, &size, &time)) {
+        return false;                                                 // RETURN
+    }
+    if (size == dependency.d_size && time == dependency.d_time) {
+        return true;                                                  // RETURN
+    }
+    Dependency found;
+    found.d_path = dependency.d_path;
+    return hash(&found) &&
+           found.d_size == dependency.d_size &&
+           found.d_hash == dependency.d_hash;
+}
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
@@ -0,0 +1,147 @@
+// csabase_stampfile.h                                                -*-C++-*-
+
+#ifndef INCLUDED_CSABASE_STAMPFILE
+#define INCLUDED_CSABASE_STAMPFILE
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringRef.h>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace csabase
+{
+class StampFile
+{
+    // This class maintains a persistent record of the translation units that
+    // were checked successfully.  Each record is keyed by the compiler
+    // arguments of the translation unit, and holds the files it depended on
+    // (with their sizes, modification times, and content hashes) and the
+    // output it produced.  A translation unit whose key and dependencies are
+    // unchanged need not be checked again; its recorded output is replayed
+    // instead.  A dependency whose size and modification time are unchanged
+    // is assumed to be unchanged; otherwise its content hash is compared.
+    // Directories searched for headers are dependencies too, hashed by the
+    // names they contain, so that a header newly created where it shadows
+    // one that was found invalidates the record.
+
+  public:
+    StampFile(std::string const& path, std::string const& version);
+        // Create an object for the stamp file with the specified 'path'.
+        // Records written under a different specified 'version' (which
+        // should identify the checking program) are discarded when read.
+
+    bool read();
+        // Load the records of the stamp file, and return 'true' on success.
+        // A stamp file that does not exist is treated as being empty.
+
+    bool write();
+        // Replace the stamp file with the current set of records (written to
+        // a temporary file first, then renamed) and return 'true' on success.
+
+    static std::string key(llvm::ArrayRef<const char *> args);
+        // Return the key identifying a translation unit checked with the
+        // specified compiler 'args'.
+
+    bool lookup(std::string const& key, std::string *output);
+        // If the translation unit identified by the specified 'key' has a
+        // record and none of its dependencies have changed, load the
+        // specified 'output' with its recorded output and return 'true'.
+        // Otherwise, discard any record for 'key' and return 'false'.  This
+        // function is thread-safe.
+
+    void record(std::string const&              key,
+                std::vector<std::string> const& dependencies,
+                std::string const&              output,
+                int64_t                         started);
+        // Record that the translation unit identified by the specified 'key'
+        // was checked successfully, depending on the specified
+        // 'dependencies' (files and directories) and producing the specified
+        // 'output', unless a dependency was modified at or after the
+        // specified 'started' time (as returned by 'now()' before the
+        // translation unit was parsed), or so shortly before it that the
+        // file system may not tell the times apart.  Such a dependency may
+        // have changed while it was being read, so that its current size,
+        // time, and hash do not describe what was checked.  This function
+        // is thread-safe.
+
+    static int64_t now();
+        // Return the current time, in the units of the recorded modification
+        // times.
+
+    static void collect_dependencies(std::vector<std::string> *files);
+        // Set the vector to which 'note_dependency' appends on the calling
+        // thread to the specified 'files', or stop collecting if 'files' is
+        // null.
+
+    static void note_dependency(llvm::StringRef file);
+        // Note that the translation unit being checked on the calling thread
+        // depends on the specified 'file', if dependencies are being
+        // collected.  This is used for files (such as configuration files)
+        // that are read other than by the compiler.
+
+  private:
+    struct Dependency
+    {
+        std::string d_path;
+        uint64_t    d_size;
+        int64_t     d_time;
+        std::string d_hash;
+    };
+
+    struct Entry
+    {
+        std::vector<Dependency> d_dependencies;
+        std::string             d_output;
+    };
+
+    bool stat(std::string const& path, uint64_t *size, int64_t *time);
+        // Load the specified 'size' and modification 'time' of the file with
+        // the specified 'path' and return 'true', or return 'false' if the
+        // file cannot be examined.
+
+    bool hash(Dependency *dependency);
+        // Load the specified 'dependency' with the size, modification time,
+        // and content hash (or, for a directory, the hash of the sorted names
+        // of its entries) of the file at its path, and return 'true', or
+        // return 'false' if the file cannot be read or changes while it is
+        // read.  The size and time are those of the contents that were
+        // hashed.  A hash is computed again only if the size or time of the
+        // file differs from when it was last hashed.  The caller must hold
+        // 'd_mutex'.
+
+    bool current(Dependency const& dependency);
+        // Return 'true' if the file of the specified 'dependency' has not
+        // changed since it was recorded.  The caller must hold 'd_mutex'.
+
+    std::string                       d_path;
+    std::string                       d_version;
+    std::mutex                        d_mutex;
+    std::map<std::string, Entry>      d_entries;
+    std::map<std::string, Dependency> d_hashes;  // last hash of each path
+
+    static thread_local std::vector<std::string> *s_dependencies;
+};
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
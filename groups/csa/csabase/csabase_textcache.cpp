@@ -0,0 +1,443 @@
+// csabase_textcache.cpp                                              -*-C++-*-
+
+#include <csabase_textcache.h>
+#include <clang/Basic/FileManager.h>
+#include <clang/Basic/SourceManager.h>
+#include <csabase_analyser.h>
+#include <csabase_config.h>
+#include <csabase_filenames.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+
+using namespace csabase;
+using namespace clang;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+const char header[] = "bde_verify-text-cache 1";
+
+std::string md5(llvm::StringRef data)
+    // Return the MD5 hash of the specified 'data' as a hex string.
+{
+    llvm::MD5 hasher;
+    hasher.update(data);
+    llvm::MD5::MD5Result result;
+    hasher.final(result);
+    llvm::SmallString<32> hex;
+    llvm::MD5::stringifyResult(result, hex);
+    return hex.str();
+}
+
+std::string const& executable_version()
+    // Return a string identifying the build of the running executable, so
+    // that results recorded by other builds are not used.
+{
+    static std::once_flag once;
+    static std::string    version;
+    std::call_once(once, [] {
+        std::string path = llvm::sys::fs::getMainExecutable(
+            "bde_verify", (void *)(intptr_t)&executable_version);
+        llvm::sys::fs::file_status status;
+        version = path;
+        if (!llvm::sys::fs::status(path, status)) {
+            llvm::raw_string_ostream out(version);
+            out << " " << status.getSize() << " "
+                << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       status.getLastModificationTime().time_since_epoch())
+                       .count();
+        }
+    });
+    return version;
+}
+
+std::string content_hash(std::string const&     path,
+                         FileEntry const       *entry,
+                         llvm::StringRef        contents)
+    // Return the hash of the specified 'contents' of the file with the
+    // specified 'path' and 'entry', computing it only once per process for
+    // each version of the file.
+{
+    static std::mutex                         mutex;
+    static std::map<std::string, std::string> hashes;
+
+    std::string              key;
+    llvm::raw_string_ostream out(key);
+    out << entry->getSize() << " " << entry->getModificationTime() << " "
+        << path;
+    out.flush();
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto i = hashes.find(key);
+        if (i != hashes.end()) {
+            return i->second;                                         // RETURN
+        }
+    }
+    std::string hash = md5(contents);
+    std::lock_guard<std::mutex> guard(mutex);
+    return hashes.insert(std::make_pair(key, hash)).first->second;
+}
+
+bool next_line(llvm::StringRef *buffer, llvm::StringRef *line)
+    // Remove the first line of the specified 'buffer', load it without its
+    // newline into the specified 'line', and return 'true', or return
+    // 'false' if 'buffer' does not contain a complete line.
+{
+    size_t eol = buffer->find('\n');
+    if (eol == llvm::StringRef::npos) {
+        return false;                                                 // RETURN
+    }
+    *line = buffer->substr(0, eol);
+    *buffer = buffer->substr(eol + 1);
+    return true;
+}
+
+template <typename T>
+bool next_field(llvm::StringRef *line, T *value)
+    // Remove the first space-separated field of the specified 'line', load
+    // it as a decimal number into the specified 'value', and return 'true'
+    // on success.
+{
+    std::pair<llvm::StringRef, llvm::StringRef> split = line->split(' ');
+    *line = split.second;
+    return !split.first.getAsInteger(10, *value);
+}
+
+bool next_text(llvm::StringRef *buffer, size_t length, std::string *text)
+    // Remove the first specified 'length' characters and the following
+    // newline from the specified 'buffer', load the characters into the
+    // specified 'text', and return 'true' on success.
+{
+    if (buffer->size() < length + 1 || (*buffer)[length] != '\n') {
+        return false;                                                 // RETURN
+    }
+    *text = buffer->substr(0, length).str();
+    *buffer = buffer->substr(length + 1);
+    return true;
+}
+
+}
+
+// ----------------------------------------------------------------------------
+
+csabase::TextCache::TextCache(Analyser&                       analyser,
+                              std::string const&              check,
+                              FileID                          file,
+                              std::vector<std::string> const& keys)
+: d_analyser(analyser)
+, d_check(check)
+, d_file(file)
+, d_start(analyser.manager().getLocForStartOfFile(file))
+, d_replayed(false)
+, d_valid(true)
+, d_previous(analyser.text_cache())
+{
+    SourceManager&   m     = analyser.manager();
+    const FileEntry *entry = m.getFileEntryForID(file);
+    if (!analyser.text_cache_dir().empty() && entry) {
+        std::string path = FileName(entry->getName()).full();
+        std::string key  = std::string(header) + '\0' +
+                           executable_version() + '\0' +
+                           check + '\0' +
+                           path + '\0' +
+                           content_hash(path, entry, m.getBufferData(file));
+        for (const auto& name : keys) {
+            key += '\0' + name + '=' + analyser.config()->value(name);
+        }
+        llvm::SmallString<256> record(analyser.text_cache_dir());
+        llvm::sys::path::append(record, md5(key));
+        d_path = record.str();
+
+        llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+            llvm::MemoryBuffer::getFile(d_path);
+        if (buffer && read((*buffer)->getBuffer())) {
+            replay();
+            d_replayed = true;
+            return;                                                   // RETURN
+        }
+        d_entries.clear();
+    }
+    analyser.text_cache(this);
+}
+
+csabase::TextCache::~TextCache()
+{
+    if (d_replayed) {
+        return;                                                       // RETURN
+    }
+    d_analyser.text_cache(d_previous);
+    if (d_path.empty() || !d_valid) {
+        return;                                                       // RETURN
+    }
+
+    // Write the record to a temporary file and rename it, so that
+    // concurrent runs never see a partial record.
+    int                    fd;
+    llvm::SmallString<256> temp;
+    llvm::sys::fs::create_directories(d_analyser.text_cache_dir());
+    if (llvm::sys::fs::createUniqueFile(d_path + "-%%%%%%%%", fd, temp)) {
+        return;                                                       // RETURN
+    }
+    {
+        llvm::raw_fd_ostream out(fd, true);
+        write(out);
+        out.close();
+        if (out.has_error()) {
+            out.clear_error();
+            llvm::sys::fs::remove(temp);
+            return;                                                   // RETURN
+        }
+    }
+    if (llvm::sys::fs::rename(temp, d_path)) {
+        llvm::sys::fs::remove(temp);
+    }
+}
+
+bool csabase::TextCache::replayed() const
+{
+    return d_replayed;
+}
+
+diagnostic_builder::recorder *csabase::TextCache::diagnostic(
+                                          SourceLocation       where,
+                                          std::string const&   check,
+                                          std::string const&   tag,
+                                          std::string const&   message,
+                                          bool                 always,
+                                          DiagnosticIDs::Level level)
+{
+    Entry entry;
+    if (!d_valid || check != d_check || !offset(where, &entry.d_offset)) {
+        d_valid = false;
+        return 0;                                                     // RETURN
+    }
+    entry.d_kind   = 'd';
+    entry.d_length = 0;
+    entry.d_level  = level;
+    entry.d_always = always;
+    entry.d_tag    = tag;
+    entry.d_text   = message;
+    d_entries.push_back(entry);
+    return this;
+}
+
+void csabase::TextCache::replacement(llvm::StringRef file,
+                                     unsigned        offset,
+                                     unsigned        length,
+                                     llvm::StringRef text)
+{
+    if (file != d_analyser.manager().getFilename(d_start)) {
+        d_valid = false;
+        return;                                                       // RETURN
+    }
+    Entry entry;
+    entry.d_kind   = 'r';
+    entry.d_offset = offset;
+    entry.d_length = length;
+    entry.d_level  = 0;
+    entry.d_always = false;
+    entry.d_text   = text;
+    d_entries.push_back(entry);
+}
+
+void csabase::TextCache::argument(int value)
+{
+    Argument argument = { 'i', value, 0, std::string() };
+    d_entries.back().d_arguments.push_back(argument);
+}
+
+void csabase::TextCache::argument(llvm::StringRef value)
+{
+    Argument argument = { 's', 0, 0, value.str() };
+    d_entries.back().d_arguments.push_back(argument);
+}
+
+void csabase::TextCache::argument(SourceRange value)
+{
+    unsigned begin;
+    unsigned end;
+    if (!offset(value.getBegin(), &begin) || !offset(value.getEnd(), &end)) {
+        d_valid = false;
+        return;                                                       // RETURN
+    }
+    Argument argument = { 'r', int(begin), end, std::string() };
+    d_entries.back().d_arguments.push_back(argument);
+}
+
+void csabase::TextCache::other_argument()
+{
+    d_valid = false;
+}
+
+bool csabase::TextCache::offset(SourceLocation loc, unsigned *offset) const
+{
+    if (!loc.isFileID()) {
+        return false;                                                 // RETURN
+    }
+    std::pair<FileID, unsigned> decomposed =
+        d_analyser.manager().getDecomposedLoc(loc);
+    *offset = decomposed.second;
+    return decomposed.first == d_file;
+}
+
+bool csabase::TextCache::read(llvm::StringRef buffer)
+{
+    llvm::StringRef line;
+    if (!next_line(&buffer, &line) || line != header) {
+        return false;                                                 // RETURN
+    }
+    while (next_line(&buffer, &line)) {
+        Entry  entry;
+        size_t nargs  = 0;
+        size_t ntag   = 0;
+        size_t ntext  = 0;
+        int    always = 0;
+        entry.d_kind = line.empty() ? 0 : line[0];
+        line = line.drop_front(std::min<size_t>(2, line.size()));
+        if (entry.d_kind == 'd') {
+            entry.d_length = 0;
+            if (!next_field(&line, &entry.d_offset) ||
+                !next_field(&line, &entry.d_level) ||
+                !next_field(&line, &always) ||
+                !next_field(&line, &nargs) ||
+                !next_field(&line, &ntag) ||
+                !next_field(&line, &ntext) ||
+                !next_text(&buffer, ntag, &entry.d_tag) ||
+                !next_text(&buffer, ntext, &entry.d_text)) {
+                return false;                                         // RETURN
+            }
+            entry.d_always = always;
+            for (size_t i = 0; i < nargs; ++i) {
+                Argument argument = { 0, 0, 0, std::string() };
+                if (!next_line(&buffer, &line) || line.size() < 2) {
+                    return false;                                     // RETURN
+                }
+                argument.d_kind = line[0];
+                line = line.drop_front(2);
+                if (argument.d_kind == 'i') {
+                    if (!next_field(&line, &argument.d_value)) {
+                        return false;                                 // RETURN
+                    }
+                }
+                else if (argument.d_kind == 's') {
+                    if (!next_field(&line, &ntext) ||
+                        !next_text(&buffer, ntext, &argument.d_text)) {
+                        return false;                                 // RETURN
+                    }
+                }
+                else if (argument.d_kind == 'r') {
+                    if (!next_field(&line, &argument.d_value) ||
+                        !next_field(&line, &argument.d_end)) {
+                        return false;                                 // RETURN
+                    }
+                }
+                else {
+                    return false;                                     // RETURN
+                }
+                entry.d_arguments.push_back(argument);
+            }
+        }
+        else if (entry.d_kind == 'r') {
+            entry.d_level  = 0;
+            entry.d_always = false;
+            if (!next_field(&line, &entry.d_offset) ||
+                !next_field(&line, &entry.d_length) ||
+                !next_field(&line, &ntext) ||
+                !next_text(&buffer, ntext, &entry.d_text)) {
+                return false;                                         // RETURN
+            }
+        }
+        else {
+            return false;                                             // RETURN
+        }
+        d_entries.push_back(entry);
+    }
+    return buffer.empty();
+}
+
+void csabase::TextCache::write(llvm::raw_ostream& out) const
+{
+    out << header << "\n";
+    for (const auto& entry : d_entries) {
+        if (entry.d_kind == 'd') {
+            out << "d " << entry.d_offset << " " << entry.d_level << " "
+                << int(entry.d_always) << " " << entry.d_arguments.size()
+                << " " << entry.d_tag.size() << " " << entry.d_text.size()
+                << "\n" << entry.d_tag << "\n" << entry.d_text << "\n";
+            for (const auto& argument : entry.d_arguments) {
+                out << argument.d_kind << " ";
+                if (argument.d_kind == 'i') {
+                    out << argument.d_value << "\n";
+                }
+                else if (argument.d_kind == 's') {
+                    out << argument.d_text.size() << "\n"
+                        << argument.d_text << "\n";
+                }
+                else {
+                    out << argument.d_value << " " << argument.d_end << "\n";
+                }
+            }
+        }
+        else {
+            out << "r " << entry.d_offset << " " << entry.d_length << " "
+                << entry.d_text.size() << "\n" << entry.d_text << "\n";
+        }
+    }
+}
+
+void csabase::TextCache::replay()
+{
+    for (const auto& entry : d_entries) {
+        SourceLocation loc = d_start.getLocWithOffset(entry.d_offset);
+        if (entry.d_kind == 'r') {
+            d_analyser.ReplaceText(loc, entry.d_length, entry.d_text);
+            continue;
+        }
+        diagnostic_builder builder = d_analyser.report(
+            loc,
+            d_check,
+            entry.d_tag,
+            entry.d_text,
+            entry.d_always,
+            static_cast<DiagnosticIDs::Level>(entry.d_level));
+        for (const auto& argument : entry.d_arguments) {
+            if (argument.d_kind == 'i') {
+                builder << argument.d_value;
+            }
+            else if (argument.d_kind == 's') {
+                builder << argument.d_text;
+            }
+            else {
+                builder << SourceRange(
+                    d_start.getLocWithOffset(argument.d_value),
+                    d_start.getLocWithOffset(argument.d_end));
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
@@ -0,0 +1,141 @@
+// csabase_textcache.h                                                -*-C++-*-
+
+#ifndef INCLUDED_CSABASE_TEXTCACHE
+#define INCLUDED_CSABASE_TEXTCACHE
+
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/SourceLocation.h>
+#include <csabase_diagnostic_builder.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/raw_ostream.h>
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace csabase { class Analyser; }
+
+namespace csabase
+{
+class TextCache : private diagnostic_builder::recorder
+{
+    // This class lets a check whose results for a file depend only on the
+    // text of that file (and on some configuration values) share them across
+    // translation units.  A check opts in by creating a 'TextCache' object
+    // for each file before examining it, and skipping the examination if
+    // 'replayed()' is 'true'.  If the analyser has a text cache directory
+    // (set with the 'text-cache=dir' plugin argument) holding a record for
+    // the check, the file path and contents, and the configuration values,
+    // the diagnostics and rewriting actions in the record are reissued
+    // instead.  Otherwise those made by the check for the file, while the
+    // object exists, are recorded and saved when it is destroyed.  Reissued
+    // diagnostics are subject to suppression and filtering as usual.
+
+  public:
+    TextCache(Analyser&                       analyser,
+              std::string const&              check,
+              clang::FileID                   file,
+              std::vector<std::string> const& keys =
+                                                   std::vector<std::string>());
+        // Create an object for the specified 'check' examining the specified
+        // 'file' using the specified 'analyser', whose results also depend on
+        // the configuration values named by the optionally specified 'keys'.
+        // Replay the cached results if there are any.
+
+    ~TextCache();
+        // Save the recorded results, if any.
+
+    bool replayed() const;
+        // Return 'true' if cached results were replayed, so that the file
+        // need not be examined.
+
+    diagnostic_builder::recorder *diagnostic(
+                                          clang::SourceLocation       where,
+                                          std::string const&          check,
+                                          std::string const&          tag,
+                                          std::string const&          message,
+                                          bool                        always,
+                                          clang::DiagnosticIDs::Level level);
+        // Record a diagnostic reported by the analyser, and return the
+        // recorder for its arguments.  This is called by 'Analyser::report'.
+
+    void replacement(llvm::StringRef file,
+                     unsigned        offset,
+                     unsigned        length,
+                     llvm::StringRef text);
+        // Record a rewriting action made by the analyser.  This is called by
+        // 'Analyser::ReplaceText'.
+
+  private:
+    TextCache(TextCache const&);
+    void operator=(TextCache const&);
+
+    struct Argument
+    {
+        char        d_kind;    // 'i' (integer), 's' (string), 'r' (range)
+        int         d_value;   // integer, or range start offset
+        unsigned    d_end;     // range end offset
+        std::string d_text;    // string
+    };
+
+    struct Entry
+    {
+        char                  d_kind;     // 'd' (diagnostic), 'r' (rewrite)
+        unsigned              d_offset;   // location within the file
+        unsigned              d_length;   // length of rewritten text
+        int                   d_level;    // diagnostic level
+        bool                  d_always;   // diagnostic is always emitted
+        std::string           d_tag;      // diagnostic tag
+        std::string           d_text;     // message or replacement text
+        std::vector<Argument> d_arguments;
+    };
+
+    void argument(int value) override;
+    void argument(llvm::StringRef value) override;
+    void argument(clang::SourceRange value) override;
+    void other_argument() override;
+
+    bool offset(clang::SourceLocation loc, unsigned *offset) const;
+        // Load the specified 'offset' with the position of the specified
+        // 'loc' within the file and return 'true', or return 'false' if
+        // 'loc' is not a location within the file.
+
+    bool read(llvm::StringRef buffer);
+        // Load the entries from the specified 'buffer' and return 'true' on
+        // success.
+
+    void write(llvm::raw_ostream& out) const;
+        // Write the entries to the specified 'out'.
+
+    void replay();
+        // Reissue the diagnostics and rewriting actions in the entries.
+
+    Analyser&             d_analyser;
+    std::string           d_check;
+    clang::FileID         d_file;
+    clang::SourceLocation d_start;     // start of the file
+    std::string           d_path;      // cache record, empty if not caching
+    bool                  d_replayed;
+    bool                  d_valid;     // results are recordable
+    TextCache            *d_previous;  // enclosing recording
+    std::vector<Entry>    d_entries;
+};
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+// Copyright (C) 2017 Bloomberg Finance L.P.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------- END-OF-FILE ----------------------------------
@@ -3,17 +3,25 @@
 #include <csabase_tool.h>
 #include <csabase_debug.h>
 #include <csabase_diagnostic_builder.h>
+#include <csabase_diagnosticfilter.h>
+#include <csabase_rewritefile.h>
+#include <csabase_stampfile.h>
+#include <llvm/Option/Arg.h>
 #include <llvm/Option/ArgList.h>
 #include <llvm/Support/Allocator.h>
+#include <llvm/Support/CommandLine.h>
 #include <llvm/Support/Host.h>
 #include <llvm/Support/ManagedStatic.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/Path.h>
 #include <llvm/Support/Process.h>
 #include <llvm/Support/Program.h>
 #include <llvm/Support/Signals.h>
 #include <llvm/Support/StringSaver.h>
 #include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/ThreadPool.h>
 #include <llvm/Support/Timer.h>
+#include <llvm/Support/raw_ostream.h>
 #include <clang/Driver/Compilation.h>
 #include <clang/Driver/Driver.h>
 #include <clang/Driver/Options.h>
@@ -24,11 +32,23 @@
 #include <clang/Frontend/TextDiagnosticBuffer.h>
 #include <clang/Frontend/TextDiagnosticPrinter.h>
 #include <clang/FrontendTool/Utils.h>
+#include <clang/Basic/FileManager.h>
+#include <clang/Lex/HeaderSearch.h>
+#include <clang/Lex/Preprocessor.h>
+#include <clang/Tooling/ArgumentsAdjusters.h>
+#include <clang/Tooling/JSONCompilationDatabase.h>
 #include <clang/Tooling/Tooling.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <system_error>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 using namespace clang;
 using namespace clang::driver;
@@ -132,6 +152,465 @@ static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool)
     return cc1_main(argv.slice(2), argv[0], GetExecutablePathVP);
 }
 
+// ----------------------------------------------------------------------------
+// Batch mode: every input named on the command line or in a batch list is
+// compiled in this process by a pool of worker threads, rather than by a
+// separate '-cc1' process per file.  When the batch list is a compilation
+// database, each of its files is compiled with its own recorded flags, and
+// files named on the command line restrict which ones are checked.
+
+static bool ExtractBatchOptions(SmallVectorImpl<const char *>& argv,
+                                std::string&                   list,
+                                unsigned&                      jobs,
+                                std::string&                   stamp)
+    // Remove the batch mode options '--batch=<file>', '-j <n>', and
+    // '--stamp=<file>' (with the alternative spellings '--batch <file>',
+    // '-j<n>', '--jobs <n>', '--jobs=<n>', and '--stamp <file>') from the
+    // specified 'argv', loading the specified 'list', 'jobs', and 'stamp'
+    // from them.  Return 'true' if any such option was present.
+{
+    bool found = false;
+    size_t out = 1;
+    for (size_t i = 1; i < argv.size(); ++i) {
+        if (argv[i] == nullptr) {
+            argv[out++] = argv[i];
+            continue;
+        }
+        StringRef arg(argv[i]);
+        StringRef name;
+        StringRef value;
+        if (arg == "--batch" || arg == "--stamp" ||
+            arg == "-j" || arg == "--jobs") {
+            if (i + 1 >= argv.size() || argv[i + 1] == nullptr) {
+                errs() << "error: missing argument to '" << arg << "'\n";
+                exit(1);
+            }
+            name = arg;
+            value = argv[++i];
+        }
+        else if (arg.startswith("--batch=") ||
+                 arg.startswith("--stamp=") ||
+                 arg.startswith("--jobs=")) {
+            std::tie(name, value) = arg.split('=');
+        }
+        else if (arg.startswith("-j") &&
+                 arg.size() > 2 &&
+                 std::isdigit(static_cast<unsigned char>(arg[2]))) {
+            name = "-j";
+            value = arg.drop_front(2);
+        }
+        else {
+            argv[out++] = argv[i];
+            continue;
+        }
+        found = true;
+        if (name == "--batch") {
+            list = value;
+        }
+        else if (name == "--stamp") {
+            stamp = value;
+        }
+        else if (value.getAsInteger(10, jobs)) {
+            errs() << "error: invalid number of jobs '" << value << "'\n";
+            exit(1);
+        }
+    }
+    argv.resize(out);
+    return found;
+}
+
+static bool ReadBatchList(StringRef list, std::vector<std::string>& files)
+    // Append to the specified 'files' the source files named in the
+    // specified 'list', and return 'true' on success.  The 'list' names one
+    // file per line, ignoring blank lines and lines starting with '#', and
+    // '-' refers to the standard input.
+{
+    ErrorOr<std::unique_ptr<MemoryBuffer>> buffer =
+        MemoryBuffer::getFileOrSTDIN(list);
+    if (!buffer) {
+        errs() << "error: cannot read batch list " << list << ": "
+               << buffer.getError().message() << "\n";
+        return false;                                                 // RETURN
+    }
+    SmallVector<StringRef, 64> lines;
+    (*buffer)->getBuffer().split(lines, '\n', -1, false);
+    for (StringRef line : lines) {
+        line = line.trim();
+        if (!line.empty() && !line.startswith("#")) {
+            files.emplace_back(line);
+        }
+    }
+    return true;
+}
+
+static std::string AbsolutePath(StringRef directory, StringRef file)
+    // Return the absolute form, without '.' or '..' components, of the
+    // specified 'file' taken relative to the specified 'directory' (or to
+    // the current directory if 'directory' is empty).
+{
+    SmallString<256> path(file);
+    if (!sys::path::is_absolute(path)) {
+        if (directory.empty()) {
+            sys::fs::make_absolute(path);
+        }
+        else {
+            path = directory;
+            sys::path::append(path, file);
+            sys::fs::make_absolute(path);
+        }
+    }
+    sys::path::remove_dots(path, true);
+    return path.str();
+}
+
+static bool BuildDatabaseCompilations(
+                 StringRef                                  database,
+                 ArrayRef<const char *>                     argv,
+                 const InputArgList&                        Args,
+                 StringRef                                  Path,
+                 bool                                       CanonicalPrefixes,
+                 DiagnosticsEngine&                         Diags,
+                 StringSaver&                               Saver,
+                 std::vector<std::unique_ptr<Driver>>&      drivers,
+                 std::vector<std::unique_ptr<Compilation>>& compilations)
+    // Append to the specified 'compilations' (built by new 'drivers' for the
+    // executable at the specified 'Path', with the specified
+    // 'CanonicalPrefixes' and 'Diags') one compilation for each entry of the
+    // specified compilation 'database' whose file is among the inputs in
+    // the specified 'Args' (or for every entry if there are no inputs).
+    // Each compilation uses the flags recorded in 'database', preceded by
+    // the options (but not the inputs) of the specified 'argv', and is run
+    // as if from the directory recorded for it.  Use the specified 'Saver'
+    // to hold the constructed arguments.  Return 'true' on success.
+{
+    std::string error;
+    std::unique_ptr<JSONCompilationDatabase> db =
+        JSONCompilationDatabase::loadFromFile(
+            database, error, JSONCommandLineSyntax::AutoDetect);
+    if (!db) {
+        errs() << "error: " << error << "\n";
+        return false;                                                 // RETURN
+    }
+
+    std::set<std::string> wanted;
+    std::set<unsigned>    inputs;
+    for (const Arg *A : Args.filtered(options::OPT_INPUT)) {
+        if (A->getIndex() != 0) {
+            wanted.insert(AbsolutePath(StringRef(), A->getValue()));
+            inputs.insert(A->getIndex());
+        }
+    }
+
+    std::vector<std::string> options;
+    for (unsigned i = 1; i < argv.size(); ++i) {
+        if (argv[i] && !inputs.count(i)) {
+            options.emplace_back(argv[i]);
+        }
+    }
+
+    ArgumentsAdjuster adjust = combineAdjusters(
+        combineAdjusters(getClangStripOutputAdjuster(),
+                         getClangSyntaxOnlyAdjuster()),
+        getInsertArgumentAdjuster(options, ArgumentInsertPosition::BEGIN));
+
+    for (const CompileCommand& command : db->getAllCompileCommands()) {
+        std::string file = AbsolutePath(command.Directory, command.Filename);
+        if (!wanted.empty() && !wanted.count(file)) {
+            continue;
+        }
+        CommandLineArguments args =
+            adjust(command.CommandLine, command.Filename);
+        SmallVector<const char *, 256> cmd;
+        cmd.push_back(argv[0]);
+        cmd.push_back(Saver.save("-working-directory=" + command.Directory));
+        cmd.push_back("-Qunused-arguments");
+        for (size_t i = 1; i < args.size(); ++i) {
+            cmd.push_back(Saver.save(args[i]));
+        }
+        drivers.emplace_back(
+            new Driver(Path, sys::getDefaultTargetTriple(), Diags));
+        SetInstallDir(cmd, *drivers.back(), CanonicalPrefixes);
+        compilations.emplace_back(drivers.back()->BuildCompilation(cmd));
+        if (!compilations.back()) {
+            return false;                                             // RETURN
+        }
+    }
+
+    if (compilations.empty()) {
+        errs() << "error: no files to check in " << database << "\n";
+        return false;                                                 // RETURN
+    }
+    return true;
+}
+
+static bool IsStampable(ArrayRef<const char *> args)
+    // Return 'true' if the output of the '-cc1' invocation with the
+    // specified 'args' is determined by its files and arguments, so that it
+    // can be replayed from a stamp file.  Runs that rewrite files, read a
+    // diff from the standard input, or trace their progress are not.
+{
+    for (size_t i = 0; i + 1 < args.size(); ++i) {
+        if (StringRef(args[i]) == "-plugin-arg-bde_verify") {
+            StringRef arg(args[++i]);
+            if (arg.startswith("rewrite-") ||
+                arg == "diff=-" ||
+                arg == "debug-on" ||
+                arg.startswith("debug-ring=")) {
+                return false;                                         // RETURN
+            }
+        }
+    }
+    return true;
+}
+
+static std::string ExecutableVersion(StringRef Path)
+    // Return a string identifying the build of the executable at the
+    // specified 'Path', so that stamps made by other builds are ignored.
+{
+    sys::fs::file_status status;
+    if (sys::fs::status(Path, status)) {
+        return Path;                                                  // RETURN
+    }
+    std::string version;
+    raw_string_ostream out(version);
+    out << status.getSize() << "-"
+        << std::chrono::duration_cast<std::chrono::nanoseconds>(
+               status.getLastModificationTime().time_since_epoch()).count();
+    return out.str();
+}
+
+static int BatchCC1(ArrayRef<const char *>    Argv,
+                    const char               *Argv0,
+                    raw_ostream&              out,
+                    std::vector<std::string> *dependencies)
+    // Run the '-cc1' invocation described by the specified 'Argv' (which
+    // does not include the '-cc1' itself) in the calling thread, sending all
+    // diagnostics to the specified 'out', and return 0 on success and 1
+    // otherwise.  If the specified 'dependencies' is not null, append to it
+    // the absolute names of the files the invocation read, and of the
+    // directories in which a header created later could be found instead of
+    // one of them: those of the header search path, and those holding the
+    // files read (which are searched for quoted includes).  Unlike
+    // 'cc1_main', this leaves process-wide state alone; the caller parses
+    // any '-mllvm' options once for the whole batch.
+{
+    std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
+    IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+
+    IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+    TextDiagnosticBuffer *DiagsBuffer = new TextDiagnosticBuffer;
+    DiagnosticsEngine     Diags(DiagID, &*DiagOpts, DiagsBuffer);
+    bool                  Success = CompilerInvocation::CreateFromArgs(
+        Clang->getInvocation(), Argv.begin(), Argv.end(), Diags);
+
+    if (Clang->getHeaderSearchOpts().UseBuiltinIncludes &&
+        Clang->getHeaderSearchOpts().ResourceDir.empty())
+        Clang->getHeaderSearchOpts().ResourceDir =
+            CompilerInvocation::GetResourcesPath(
+                Argv0, (void *)(intptr_t)GetExecutablePath);
+
+    // A batch may be long, so translation units are freed as they finish.
+    Clang->getFrontendOpts().DisableFree = false;
+
+    // These set global LLVM options, which the caller has already done.
+    Clang->getFrontendOpts().LLVMArgs.clear();
+
+    csabase::DiagnosticFilter::set_output(&out);
+    Clang->createDiagnostics(
+        new TextDiagnosticPrinter(out, &Clang->getDiagnosticOpts()));
+    if (!Clang->hasDiagnostics()) {
+        csabase::DiagnosticFilter::set_output(nullptr);
+        return 1;                                                     // RETURN
+    }
+
+    DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
+    if (Success) {
+        Success = ExecuteCompilerInvocation(Clang.get());
+    }
+
+    if (dependencies && Clang->hasFileManager()) {
+        FileManager&                        fm = Clang->getFileManager();
+        std::set<std::string>               directories;
+        SmallVector<const FileEntry *, 256> files;
+        fm.GetUniqueIDMapping(files);
+        for (const FileEntry *file : files) {
+            if (file) {
+                SmallString<256> path(file->getName());
+                fm.makeAbsolutePath(path);
+                sys::path::remove_dots(path, true);
+                dependencies->push_back(path.str());
+                directories.insert(sys::path::parent_path(path));
+            }
+        }
+        if (Clang->hasPreprocessor()) {
+            HeaderSearch& search =
+                Clang->getPreprocessor().getHeaderSearchInfo();
+            for (auto d = search.search_dir_begin();
+                 d != search.search_dir_end();
+                 ++d) {
+                const DirectoryEntry *dir =
+                    d->isFramework() ? d->getFrameworkDir() : d->getDir();
+                if (dir) {
+                    SmallString<256> path(dir->getName());
+                    fm.makeAbsolutePath(path);
+                    sys::path::remove_dots(path, true);
+                    directories.insert(path.str());
+                }
+            }
+        }
+        dependencies->insert(
+            dependencies->end(), directories.begin(), directories.end());
+    }
+
+    Clang.reset();
+    csabase::DiagnosticFilter::set_output(nullptr);
+    return !Success;
+}
+
+static bool SameProcessOptions(ArrayRef<const Command *>  commands,
+                               std::vector<const char *> *llvm_args)
+    // Return 'true' if the specified 'commands' all have the same '-cc1'
+    // options for process-wide state, which batch mode cannot set per file:
+    // the LLVM options given with '-mllvm', the plugins given with '-load',
+    // and the debugging arguments of this plugin.  If so, append the values
+    // of the '-mllvm' options to the specified 'llvm_args'; otherwise report
+    // the first file whose options differ and return 'false'.
+{
+    std::vector<StringRef> first;
+    StringRef              first_file;
+    for (const Command *command : commands) {
+        const ArgStringList&   args = command->getArguments();
+        std::vector<StringRef> process;
+        StringRef              file;
+        for (size_t i = 1; i + 1 < args.size(); ++i) {
+            StringRef arg(args[i]);
+            StringRef value(args[i + 1]);
+            if (arg == "-main-file-name") {
+                file = value;
+                ++i;
+            }
+            else if (arg == "-mllvm" ||
+                     arg == "-load" ||
+                     (arg == "-plugin-arg-bde_verify" &&
+                      value.startswith("debug"))) {
+                process.push_back(arg);
+                process.push_back(value);
+                ++i;
+            }
+        }
+        if (command == commands.front()) {
+            first.swap(process);
+            first_file = file;
+        }
+        else if (process != first) {
+            errs() << "error: batch mode cannot check " << file
+                   << " with '-mllvm', '-load', or debugging options that "
+                   << "differ from those of " << first_file << "\n";
+            return false;                                             // RETURN
+        }
+    }
+    for (size_t i = 0; i < first.size(); i += 2) {
+        if (first[i] == "-mllvm") {
+            llvm_args->push_back(first[i + 1].data());
+        }
+    }
+    return true;
+}
+
+static int ExecuteBatch(
+             const std::vector<std::unique_ptr<Compilation>>& compilations,
+             const char                                      *Argv0,
+             unsigned                                         jobs,
+             csabase::StampFile                              *stamps)
+    // Run the '-cc1' jobs of the specified 'compilations' on a pool of the
+    // specified number of 'jobs' worker threads (one per hardware thread if
+    // 'jobs' is 0), writing the output of each job to the standard error in
+    // the order of the jobs once it and all jobs before it are complete.  If
+    // the specified 'stamps' is not null, replay the output of jobs it shows
+    // to be unchanged rather than running them, and record the jobs that
+    // succeed.  Return 0 if all jobs succeed and 1 otherwise, running none
+    // of them if their process-wide options differ.
+{
+    std::vector<const Command *> commands;
+    for (const auto& C : compilations) {
+        for (const auto& job : C->getJobs()) {
+            const ArgStringList& args = job.getArguments();
+            if (!args.empty() && StringRef(args[0]) == "-cc1") {
+                commands.push_back(&job);
+            }
+        }
+    }
+    if (commands.empty()) {
+        return 0;                                                     // RETURN
+    }
+
+    std::vector<const char *> llvm_args(1, "clang (LLVM option parsing)");
+    if (!SameProcessOptions(commands, &llvm_args)) {
+        return 1;                                                     // RETURN
+    }
+    if (llvm_args.size() > 1) {
+        // As 'ExecuteCompilerInvocation' would for each job, but only once.
+        llvm_args.push_back(nullptr);
+        cl::ParseCommandLineOptions(llvm_args.size() - 1, llvm_args.data());
+    }
+
+    if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::mutex               mutex;
+    std::vector<std::string> outputs(commands.size());
+    std::vector<bool>        done(commands.size());
+    size_t                   next = 0;
+    int                      Res = 0;
+
+    {
+        ThreadPool pool(std::min<size_t>(jobs, commands.size()));
+        for (size_t i = 0; i < commands.size(); ++i) {
+            pool.async([&, i] {
+                ArrayRef<const char *> args =
+                    makeArrayRef(commands[i]->getArguments()).slice(1);
+                std::string            output;
+                int                    result = 0;
+                bool                   stamped = stamps && IsStampable(args);
+                std::string            key;
+                if (stamped) {
+                    key = csabase::StampFile::key(args);
+                }
+                if (!stamped || !stamps->lookup(key, &output)) {
+                    std::vector<std::string> dependencies;
+                    raw_string_ostream       out(output);
+                    int64_t                  started =
+                        csabase::StampFile::now();
+                    csabase::StampFile::collect_dependencies(
+                        stamped ? &dependencies : nullptr);
+                    result = BatchCC1(
+                        args, Argv0, out, stamped ? &dependencies : nullptr);
+                    csabase::StampFile::collect_dependencies(nullptr);
+                    out.flush();
+                    if (stamped && result == 0) {
+                        stamps->record(key, dependencies, output, started);
+                    }
+                }
+
+                std::lock_guard<std::mutex> guard(mutex);
+                outputs[i].swap(output);
+                done[i] = true;
+                if (result) {
+                    Res = 1;
+                }
+                for (; next < commands.size() && done[next]; ++next) {
+                    errs() << outputs[next];
+                    std::string().swap(outputs[next]);
+                }
+            });
+        }
+        pool.wait();
+    }
+
+    return Res;
+}
+
 int csabase::run(int argc_, const char **argv_)
 {
     sys::PrintStackTraceOnErrorSignal(argv_[0], true);
@@ -170,6 +649,29 @@ int csabase::run(int argc_, const char **argv_)
         return ExecuteCC1Tool(argv, argv[1] + 4);
     }
 
+    if (argv.size() == 3 && argv[1] && argv[2] &&
+        StringRef(argv[1]).startswith("--apply-rewrites=")) {
+        // Apply the actions collected in a rewrite file by earlier runs.
+        return RewriteFile::apply(
+            StringRef(argv[1]).substr(17), argv[2], errs());          // RETURN
+    }
+
+    std::string BatchList;
+    unsigned    BatchJobs = 0;
+    std::string BatchStamp;
+    bool        Batch =
+        ExtractBatchOptions(argv, BatchList, BatchJobs, BatchStamp);
+    bool        Database = StringRef(BatchList).endswith(".json");
+    if (!BatchList.empty() && !Database) {
+        std::vector<std::string> files;
+        if (!ReadBatchList(BatchList, files)) {
+            return 1;                                                 // RETURN
+        }
+        for (const auto& file : files) {
+            argv.push_back(Saver.save(file));
+        }
+    }
+
     bool CanonicalPrefixes = true;
     for (int i = 1, size = argv.size(); i < size; ++i) {
         // Skip end-of-line response file markers
@@ -218,11 +720,58 @@ int csabase::run(int argc_, const char **argv_)
 
     SetInstallDir(argv, TheDriver, CanonicalPrefixes);
 
-    std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(argv));
+    std::unique_ptr<Compilation> C;
     int                          Res = 0;
     SmallVector<std::pair<int, const Command *>, 4> FailingCommands;
-    if (C.get())
-        Res = TheDriver.ExecuteCompilation(*C, FailingCommands);
+    if (Batch) {
+        std::vector<std::unique_ptr<Driver>>      Drivers;
+        std::vector<std::unique_ptr<Compilation>> Compilations;
+        bool                                      Built = true;
+        if (Database) {
+            Built = BuildDatabaseCompilations(BatchList,
+                                              argv,
+                                              Args,
+                                              Path,
+                                              CanonicalPrefixes,
+                                              Diags,
+                                              Saver,
+                                              Drivers,
+                                              Compilations);
+        }
+        else {
+            Compilations.emplace_back(TheDriver.BuildCompilation(argv));
+            Built = Compilations.back() != nullptr;
+        }
+
+        std::unique_ptr<csabase::StampFile> Stamps;
+        if (!BatchStamp.empty()) {
+            Stamps.reset(
+                new csabase::StampFile(BatchStamp, ExecutableVersion(Path)));
+            if (!Stamps->read()) {
+                errs() << "warning: ignoring unreadable stamp file "
+                       << BatchStamp << "\n";
+            }
+        }
+
+        if (!Built || Diags.hasErrorOccurred()) {
+            Res = 1;
+        }
+        else {
+            install_fatal_error_handler(LLVMErrorHandler,
+                                        static_cast<void *>(&Diags));
+            Res = ExecuteBatch(Compilations, argv[0], BatchJobs, Stamps.get());
+            remove_fatal_error_handler();
+            if (Stamps && !Stamps->write()) {
+                errs() << "warning: cannot write stamp file " << BatchStamp
+                       << "\n";
+            }
+        }
+    }
+    else {
+        C.reset(TheDriver.BuildCompilation(argv));
+        if (C.get())
+            Res = TheDriver.ExecuteCompilation(*C, FailingCommands);
+    }
 
     for (const auto& P : FailingCommands) {
         int            CommandRes = P.first;
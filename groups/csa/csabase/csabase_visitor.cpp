@@ -12,6 +12,33 @@ using namespace clang;
 
 // -----------------------------------------------------------------------------
 
+csabase::Visitor::Visitor()
+: d_skipped(0)
+{
+}
+
+void csabase::Visitor::skip(
+                           std::function<bool(Decl const*)> const& predicate)
+{
+    d_skip = predicate;
+}
+
+unsigned csabase::Visitor::skipped() const
+{
+    return d_skipped;
+}
+
+bool csabase::Visitor::prune(Decl const* decl)
+{
+    if (d_skip && d_skip(decl)) {
+        ++d_skipped;
+        return true;                                                  // RETURN
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
 #define DECL(CLASS, BASE)                                    \
     void csabase::Visitor::do_visit(CLASS##Decl const* decl) \
     {                                                        \
@@ -23,10 +50,14 @@ using namespace clang;
 DECL(,)
 #include "clang/AST/DeclNodes.inc"  // IWYU pragma: keep
 
+// Statements are visited far more often than declarations, and most kinds
+// have no subscribers, so test for those before raising the event.
 #define STMT(CLASS, PARENT)                            \
     void csabase::Visitor::do_visit(CLASS const* stmt) \
     {                                                  \
-        on##CLASS(stmt);                               \
+        if (on##CLASS) {                               \
+            on##CLASS(stmt);                           \
+        }                                              \
     }
 STMT(Stmt,)
 #include "clang/AST/StmtNodes.inc"  // IWYU pragma: keep
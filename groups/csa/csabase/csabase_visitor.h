@@ -5,6 +5,7 @@
 
 #include <csabase_abstractvisitor.h>
 #include <utils/event.hpp>
+#include <functional>
 
 namespace clang { class Decl; }
 namespace clang { class Stmt; }
@@ -16,6 +17,17 @@ namespace csabase
 class Visitor : public AbstractVisitor
 {
 public:
+    Visitor();
+
+    void skip(std::function<bool(clang::Decl const*)> const& predicate);
+        // Do not visit declarations, or anything within them, for which the
+        // specified 'predicate' returns 'true'.
+
+    unsigned skipped() const;
+        // Return the number of declarations not visited because of 'skip'.
+
+    bool prune(clang::Decl const* decl) override;
+
 #define DECL(CLASS, BASE)                                                     \
     utils::event<void(clang::CLASS##Decl const*)> on##CLASS##Decl;            \
     void do_visit(clang::CLASS##Decl const*);
@@ -27,6 +39,10 @@ DECL(,)
     void do_visit(clang::CLASS const*);
 STMT(Stmt,)
 #include "clang/AST/StmtNodes.inc"  // IWYU pragma: keep
+
+private:
+    std::function<bool(clang::Decl const*)> d_skip;
+    unsigned                                d_skipped;
 };
 }
 
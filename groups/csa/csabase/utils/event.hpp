@@ -3,8 +3,9 @@
 #ifndef INCLUDED_UTILS_EVENT_HPP
 #define INCLUDED_UTILS_EVENT_HPP
 
-#include <utils/function.hpp>
-#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
 
 // -----------------------------------------------------------------------------
 
@@ -15,29 +16,70 @@ class event;
 
 template <typename...T>
 class event<void(T...)>
+    // An event holds the functors subscribed to it and calls each of them, in
+    // the order in which they were added, when it is raised.  Each functor is
+    // moved once into its own allocation, which is never copied, and the
+    // subscribers are kept in a contiguous list of object pointers and plain
+    // functions that call and destroy them, so raising an event costs one
+    // indirect call per subscriber.
 {
   public:
+    event() = default;
+
+    event(event const&) = delete;
+    event& operator=(event const&) = delete;
+
+    ~event()
+    {
+        for (const auto &s : subscribers_) {
+            s.destroy_(s.object_);
+        }
+    }
+
     template <typename Functor>
     event& operator+=(Functor functor)
     {
-        functions_.push_back(function<void(T...)>(functor));
+        std::unique_ptr<Functor> object(new Functor(std::move(functor)));
+        subscriber s = { object.get(), &call<Functor>, &destroy<Functor> };
+        subscribers_.push_back(s);
+        object.release();
         return *this;
     }
 
     void operator()(T...a) const
     {
-        for (const auto &f : functions_) {
-            f(a...);
+        // Subscribers added while the event is being raised are called too.
+        for (size_t i = 0; i < subscribers_.size(); ++i) {
+            subscribers_[i].call_(subscribers_[i].object_, a...);
         }
     }
 
     operator bool() const
     {
-        return !functions_.empty();
+        return !subscribers_.empty();
     }
 
 private:
-    std::deque<function<void(T...)>> functions_;
+    struct subscriber
+    {
+        void  *object_;
+        void (*call_)(void *, T...);
+        void (*destroy_)(void *);
+    };
+
+    template <typename Functor>
+    static void call(void *object, T...a)
+    {
+        (*static_cast<Functor *>(object))(a...);
+    }
+
+    template <typename Functor>
+    static void destroy(void *object)
+    {
+        delete static_cast<Functor *>(object);
+    }
+
+    std::vector<subscriber> subscribers_;
 };
 
 // This allows using decltype(function pointer) as the type parameter.
@@ -432,13 +432,11 @@ static internal::DynTypedMatcher nested_allocator_trait_matcher()
     // out in the AST matcher; instead the matcher looks for a superset of
     // methods and the callback looks for further structure.
 {
-    return decl(forEachDescendant(
-        cxxMethodDecl(
-            matchesName("::operator NestedTraitDeclaration($|<)"),
-            returns(qualType().bind("type")),
-            ofClass(recordDecl().bind("class"))
-        ).bind("trait")
-    ));
+    return cxxMethodDecl(
+               matchesName("::operator NestedTraitDeclaration($|<)"),
+               returns(qualType().bind("type")),
+               ofClass(recordDecl().bind("class"))
+           ).bind("trait");
 }
 
 void report::match_nested_allocator_trait(const BoundNodes& nodes)
@@ -507,12 +505,12 @@ static internal::DynTypedMatcher class_using_allocator_matcher()
     // is a pointer or reference to an allocator or a reference to a class that
     // has such a constructor.
 {
-    return decl(forEachDescendant(recordDecl(
+    return recordDecl(
         has(cxxConstructorDecl(hasLastParameter(parmVarDecl(anyOf(
             hasType(pointerType(isAllocator())),
             hasType(referenceType(isAllocator()))
         )))))
-    ).bind("class")));
+    ).bind("class");
 }
 
 void report::match_class_using_allocator(const BoundNodes& nodes)
@@ -525,16 +523,15 @@ void report::match_class_using_allocator(const BoundNodes& nodes)
 
 static internal::DynTypedMatcher allocator_trait_matcher(int value)
 {
-    return decl(forEachDescendant(
-        classTemplateSpecializationDecl(
-            hasName("::BloombergLP::bslma::UsesBslmaAllocator"),
-            templateArgumentCountIs(1),
-            isDerivedFrom(classTemplateSpecializationDecl(
-                hasName("::bsl::integral_constant"),
-                templateArgumentCountIs(2),
-                hasTemplateArgument(0, refersToType(asString("_Bool"))),
-                hasTemplateArgument(1, equalsIntegral(value)))))
-            .bind("class")));
+    return classTemplateSpecializationDecl(
+               hasName("::BloombergLP::bslma::UsesBslmaAllocator"),
+               templateArgumentCountIs(1),
+               isDerivedFrom(classTemplateSpecializationDecl(
+                   hasName("::bsl::integral_constant"),
+                   templateArgumentCountIs(2),
+                   hasTemplateArgument(0, refersToType(asString("_Bool"))),
+                   hasTemplateArgument(1, equalsIntegral(value)))))
+        .bind("class");
 }
 
 void report::match_allocator_trait(data::DeclsWithAllocatorTrait* set,
@@ -572,17 +569,16 @@ void report::match_positive_allocator_trait(const BoundNodes& nodes)
 
 static internal::DynTypedMatcher dependent_allocator_trait_matcher()
 {
-    return decl(forEachDescendant(
-        classTemplateSpecializationDecl(
-            hasName("::BloombergLP::bslma::UsesBslmaAllocator"),
-            templateArgumentCountIs(1),
-            unless(isDerivedFrom(classTemplateSpecializationDecl(
-                hasName("::bsl::integral_constant"),
-                templateArgumentCountIs(2),
-                hasTemplateArgument(0, refersToType(asString("_Bool"))),
-                anyOf(hasTemplateArgument(1, equalsIntegral(0)),
-                      hasTemplateArgument(1, equalsIntegral(1)))))))
-            .bind("class")));
+    return classTemplateSpecializationDecl(
+               hasName("::BloombergLP::bslma::UsesBslmaAllocator"),
+               templateArgumentCountIs(1),
+               unless(isDerivedFrom(classTemplateSpecializationDecl(
+                   hasName("::bsl::integral_constant"),
+                   templateArgumentCountIs(2),
+                   hasTemplateArgument(0, refersToType(asString("_Bool"))),
+                   anyOf(hasTemplateArgument(1, equalsIntegral(0)),
+                         hasTemplateArgument(1, equalsIntegral(1)))))))
+        .bind("class");
 }
 
 void report::match_dependent_allocator_trait(const BoundNodes& nodes)
@@ -592,42 +588,41 @@ void report::match_dependent_allocator_trait(const BoundNodes& nodes)
 
 static internal::DynTypedMatcher should_return_by_value_matcher()
 {
-    return decl(forEachDescendant(
-        functionDecl(
-            returns(asString("void")),
-            hasParameter(
-                0,
-                parmVarDecl(
-                    hasType(pointerType(unless(pointee(isConstQualified())),
-                                        unless(pointee(asString("void"))),
-                                        unless(pointee(functionType())),
-                                        unless(pointee(memberPointerType())))
-                                .bind("type")))
-                    .bind("parm")),
-            anyOf(parameterCountIs(1),
-                  hasParameter(
-                      1,
-                      unless(
-                          anyOf(hasType(isInteger()),
-                                hasType(pointerType(
+    return functionDecl(
+        returns(asString("void")),
+        hasParameter(
+            0,
+            parmVarDecl(
+                hasType(pointerType(unless(pointee(isConstQualified())),
                                     unless(pointee(asString("void"))),
                                     unless(pointee(functionType())),
-                                    unless(pointee(memberPointerType())))))))),
-            anyOf(hasDescendant(binaryOperator(
-                      hasOperatorName("="),
-                      hasLHS(unaryOperator(
+                                    unless(pointee(memberPointerType())))
+                            .bind("type")))
+                .bind("parm")),
+        anyOf(parameterCountIs(1),
+              hasParameter(
+                  1,
+                  unless(
+                      anyOf(hasType(isInteger()),
+                            hasType(pointerType(
+                                unless(pointee(asString("void"))),
+                                unless(pointee(functionType())),
+                                unless(pointee(memberPointerType())))))))),
+        anyOf(hasDescendant(binaryOperator(
+                  hasOperatorName("="),
+                  hasLHS(unaryOperator(
+                      hasOperatorName("*"),
+                      hasUnaryOperand(ignoringImpCasts(declRefExpr(
+                          to(decl(equalsBoundNode("parm")))))))))),
+              hasDescendant(cxxOperatorCallExpr(
+                  hasOverloadedOperatorName("="),
+                  hasArgument(
+                      0,
+                      ignoringImpCasts(unaryOperator(
                           hasOperatorName("*"),
                           hasUnaryOperand(ignoringImpCasts(declRefExpr(
-                              to(decl(equalsBoundNode("parm")))))))))),
-                  hasDescendant(cxxOperatorCallExpr(
-                      hasOverloadedOperatorName("="),
-                      hasArgument(
-                          0,
-                          ignoringImpCasts(unaryOperator(
-                              hasOperatorName("*"),
-                              hasUnaryOperand(ignoringImpCasts(declRefExpr(
-                                  to(decl(equalsBoundNode("parm")))))))))))))
-            .bind("func")));
+                              to(decl(equalsBoundNode("parm")))))))))))))
+        .bind("func");
 }
 
 bool report::hasRVCognate(const FunctionDecl *func)
@@ -688,7 +683,7 @@ void report::match_should_return_by_value(const BoundNodes& nodes)
 
 static internal::DynTypedMatcher ctor_expr_matcher()
 {
-    return decl(forEachDescendant(cxxConstructExpr(anything()).bind("e")));
+    return cxxConstructExpr(anything()).bind("e");
 }
 
 void report::match_ctor_expr(const BoundNodes& nodes)
@@ -699,9 +694,8 @@ void report::match_ctor_expr(const BoundNodes& nodes)
 
 static internal::DynTypedMatcher return_stmt_matcher()
 {
-    return decl(forEachDescendant(
-        functionDecl(forEachDescendant(returnStmt(anything()).bind("r")))
-            .bind("f")));
+    return functionDecl(forEachDescendant(returnStmt(anything()).bind("r")))
+        .bind("f");
 }
 
 void report::match_return_stmt(const BoundNodes& nodes)
@@ -715,7 +709,7 @@ void report::match_return_stmt(const BoundNodes& nodes)
 
 static internal::DynTypedMatcher var_decl_matcher()
 {
-    return decl(forEachDescendant(varDecl(anything()).bind("v")));
+    return varDecl(anything()).bind("v");
 }
 
 void report::match_var_decl(const BoundNodes& nodes)
@@ -730,7 +724,7 @@ void report::match_var_decl(const BoundNodes& nodes)
 
 static internal::DynTypedMatcher ctor_decl_matcher()
 {
-    return decl(forEachDescendant(cxxConstructorDecl(anything()).bind("c")));
+    return cxxConstructorDecl(anything()).bind("c");
 }
 
 void report::match_ctor_decl(const BoundNodes& nodes)
@@ -741,40 +735,6 @@ void report::match_ctor_decl(const BoundNodes& nodes)
 
 void report::operator()()
 {
-    MatchFinder mf;
-
-    OnMatch<report, &report::match_nested_allocator_trait> m2(this);
-    mf.addDynamicMatcher(nested_allocator_trait_matcher(), &m2);
-
-    OnMatch<report, &report::match_negative_allocator_trait> m4(this);
-    mf.addDynamicMatcher(allocator_trait_matcher(0), &m4);
-
-    OnMatch<report, &report::match_positive_allocator_trait> m6(this);
-    mf.addDynamicMatcher(allocator_trait_matcher(1), &m6);
-
-    OnMatch<report, &report::match_dependent_allocator_trait> m5(this);
-    mf.addDynamicMatcher(dependent_allocator_trait_matcher(), &m5);
-
-    OnMatch<report, &report::match_class_using_allocator> m3(this);
-    mf.addDynamicMatcher(class_using_allocator_matcher(), &m3);
-
-    OnMatch<report, &report::match_should_return_by_value> m7(this);
-    mf.addDynamicMatcher(should_return_by_value_matcher(), &m7);
-
-    OnMatch<report, &report::match_ctor_expr> m1(this);
-    mf.addDynamicMatcher(ctor_expr_matcher(), &m1);
-
-    OnMatch<report, &report::match_return_stmt> m8(this);
-    mf.addDynamicMatcher(return_stmt_matcher(), &m8);
-
-    OnMatch<report, &report::match_var_decl> m9(this);
-    mf.addDynamicMatcher(var_decl_matcher(), &m9);
-
-    OnMatch<report, &report::match_ctor_decl> m10(this);
-    mf.addDynamicMatcher(ctor_decl_matcher(), &m10);
-
-    mf.match(*a.context()->getTranslationUnitDecl(), *a.context());
-
     check_not_forwarded(d.ctors_.begin(), d.ctors_.end());
     check_wrong_parm(d.cexprs_.begin(), d.cexprs_.end());
     check_uses_allocator(d.cexprs_.begin(), d.cexprs_.end());
@@ -1286,10 +1246,46 @@ void report::check_alloc_return(const ReturnStmt *stmt)
     }
 }
 
+template <void (report::*Method)(const BoundNodes&)>
+void add_matcher(Analyser& analyser, internal::DynTypedMatcher const& matcher)
+    // Arrange for the specified 'Method' of a 'report' object to be invoked
+    // for each match of the specified 'matcher' within the specified
+    // 'analyser'.  The matchers see template instantiations, since whether a
+    // type uses an allocator, and so how it must be constructed, is often
+    // known only there.
+{
+    analyser.add_matcher(check_name,
+                         matcher,
+                         [&analyser](const BoundNodes& nodes) {
+                             (report(analyser).*Method)(nodes);
+                         },
+                         Analyser::e_Instantiations);
+}
+
 void subscribe(Analyser& analyser, Visitor&, PPObserver&)
-    // Create a callback within the specified 'analyser' which will be invoked
-    // after a translation unit has been processed.
+    // Register the matchers with the specified 'analyser', and create a
+    // callback within it which will be invoked after a translation unit has
+    // been processed.  The matches of each matcher are delivered in the
+    // order the matchers are added, which the checks rely upon.
 {
+    add_matcher<&report::match_nested_allocator_trait>(
+        analyser, nested_allocator_trait_matcher());
+    add_matcher<&report::match_negative_allocator_trait>(
+        analyser, allocator_trait_matcher(0));
+    add_matcher<&report::match_positive_allocator_trait>(
+        analyser, allocator_trait_matcher(1));
+    add_matcher<&report::match_dependent_allocator_trait>(
+        analyser, dependent_allocator_trait_matcher());
+    add_matcher<&report::match_class_using_allocator>(
+        analyser, class_using_allocator_matcher());
+    add_matcher<&report::match_should_return_by_value>(
+        analyser, should_return_by_value_matcher());
+    add_matcher<&report::match_ctor_expr>(analyser, ctor_expr_matcher());
+    add_matcher<&report::match_return_stmt>(analyser, return_stmt_matcher());
+    add_matcher<&report::match_var_decl>(analyser, var_decl_matcher());
+    add_matcher<&report::match_ctor_decl>(analyser, ctor_decl_matcher());
+
+    analyser.index_parents();
     analyser.onTranslationUnitDone += report(analyser);
 }
 
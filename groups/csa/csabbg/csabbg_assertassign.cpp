@@ -35,39 +35,39 @@ struct report : Report<data>
 {
     INHERIT_REPORT_CTOR(report, Report, data);
 
-    void operator()();
+    void match_assign(const BoundNodes &nodes);
 };
 
-void report::operator()()
+void report::match_assign(const BoundNodes &nodes)
 {
-    MatchFinder mf;
-    OnMatch<> m1([&](const BoundNodes &nodes) {
-        auto parent = nodes.getNodeAs<FunctionDecl>("parent");
-        auto negate = nodes.getNodeAs<UnaryOperator>("!");
-        auto assign = nodes.getNodeAs<BinaryOperator>("=");
-        if (m.getFileID(parent->getLocStart()) ==
-            m.getFileID(m.getSpellingLoc(assign->getOperatorLoc())) &&
-            negate->getOperatorLoc().isMacroID()) {
-            a.report(assign->getOperatorLoc(), check_name, "AE01",
-                     "Assignment appears as top-level macro condition")
-                << SourceRange(assign->getLocStart(),
-                               assign->getLocEnd());
-        }
-    });
-    mf.addDynamicMatcher(decl(forEachDescendant(unaryOperator(
-        hasOperatorName("!"),
-        hasUnaryOperand(ignoringParenImpCasts(
-            binaryOperator(hasOperatorName("=")).bind("=")
-        )),
-        hasAncestor(decl(functionDecl()).bind("parent"))
-    ).bind("!"))), &m1);
-    mf.match(*a.context()->getTranslationUnitDecl(), *a.context());
+    auto parent = nodes.getNodeAs<FunctionDecl>("parent");
+    auto negate = nodes.getNodeAs<UnaryOperator>("!");
+    auto assign = nodes.getNodeAs<BinaryOperator>("=");
+    if (m.getFileID(parent->getLocStart()) ==
+        m.getFileID(m.getSpellingLoc(assign->getOperatorLoc())) &&
+        negate->getOperatorLoc().isMacroID()) {
+        a.report(assign->getOperatorLoc(), check_name, "AE01",
+                 "Assignment appears as top-level macro condition")
+            << SourceRange(assign->getLocStart(),
+                           assign->getLocEnd());
+    }
 }
 
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
     // Hook up the callback functions.
 {
-    analyser.onTranslationUnitDone += report(analyser);
+    analyser.add_matcher(
+        check_name,
+        unaryOperator(
+            hasOperatorName("!"),
+            hasUnaryOperand(ignoringParenImpCasts(
+                binaryOperator(hasOperatorName("=")).bind("=")
+            )),
+            hasAncestor(decl(functionDecl()).bind("parent"))
+        ).bind("!"),
+        [&analyser](const BoundNodes &nodes) {
+            report(analyser).match_assign(nodes);
+        });
 }
 
 }  // close anonymous namespace
@@ -18,6 +18,7 @@
 #include <csabase_debug.h>
 #include <csabase_diagnostic_builder.h>
 #include <csabase_filenames.h>
+#include <csabase_headerindex.h>
 #include <csabase_location.h>
 #include <csabase_ppobserver.h>
 #include <csabase_registercheck.h>
@@ -61,13 +62,6 @@ namespace
 
 enum FileType { e_UNK = -1, e_NIL, e_BSL, e_STD, e_SPC };
 
-struct file_info {
-    const char *bsl;
-    const char *bsl_guard;
-    const char *std;
-    const char *std_guard;
-};
-
 const char bsl_ns[] = "namespace bsl { }";
 
 struct data
@@ -90,7 +84,7 @@ struct data
     std::map<FileID,
              std::vector<std::tuple<std::string, SourceLocation, bool> > >
                                                          d_includes;
-    std::map<std::string, std::pair<std::vector<const file_info *>, FileType>>
+    std::map<std::string, std::pair<HeaderIndex::Pairs, FileType>>
                                                          d_file_info;
     std::map<FileID, SourceLocation>                     d_top_for_insert;
     std::map<FileID, llvm::StringRef>                    d_guards;
@@ -109,379 +103,6 @@ data::data()
 {
 }
 
-const file_info include_pairs[] = {
-    { "bsl_algorithm.h",     "INCLUDED_BSL_ALGORITHM",
-      "algorithm",           "INCLUDED_ALGORITHM"          },
-    { "bsl_bitset.h",        "INCLUDED_BSL_BITSET",
-      "bitset",              "INCLUDED_BITSET"             },
-    { "bsl_cassert.h",       "INCLUDED_BSL_CASSERT",
-      "cassert",             "INCLUDED_CASSERT"            },
-    { "bsl_cctype.h",        "INCLUDED_BSL_CCTYPE",
-      "cctype",              "INCLUDED_CCTYPE"             },
-    { "bsl_cerrno.h",        "INCLUDED_BSL_CERRNO",
-      "cerrno",              "INCLUDED_CERRNO"             },
-    { "bsl_cfloat.h",        "INCLUDED_BSL_CFLOAT",
-      "cfloat",              "INCLUDED_CFLOAT"             },
-    { "bsl_ciso646.h",       "INCLUDED_BSL_CISO646",
-      "ciso646",             "INCLUDED_CISO646"            },
-    { "bsl_climits.h",       "INCLUDED_BSL_CLIMITS",
-      "climits",             "INCLUDED_CLIMITS"            },
-    { "bsl_clocale.h",       "INCLUDED_BSL_CLOCALE",
-      "clocale",             "INCLUDED_CLOCALE"            },
-    { "bsl_cmath.h",         "INCLUDED_BSL_CMATH",
-      "cmath",               "INCLUDED_CMATH"              },
-    { "bsl_complex.h",       "INCLUDED_BSL_COMPLEX",
-      "complex",             "INCLUDED_COMPLEX"            },
-    { "bsl_csetjmp.h",       "INCLUDED_BSL_CSETJMP",
-      "csetjmp",             "INCLUDED_CSETJMP"            },
-    { "bsl_csignal.h",       "INCLUDED_BSL_CSIGNAL",
-      "csignal",             "INCLUDED_CSIGNAL"            },
-    { "bsl_cstdarg.h",       "INCLUDED_BSL_CSTDARG",
-      "cstdarg",             "INCLUDED_CSTDARG"            },
-    { "bsl_cstddef.h",       "INCLUDED_BSL_CSTDDEF",
-      "cstddef",             "INCLUDED_CSTDDEF"            },
-    { "bsl_cstdio.h",        "INCLUDED_BSL_CSTDIO",
-      "cstdio",              "INCLUDED_CSTDIO"             },
-    { "bsl_cstdlib.h",       "INCLUDED_BSL_CSTDLIB",
-      "cstdlib",             "INCLUDED_CSTDLIB"            },
-    { "bsl_cstring.h",       "INCLUDED_BSL_CSTRING",
-      "cstring",             "INCLUDED_CSTRING"            },
-    { "bsl_ctime.h",         "INCLUDED_BSL_CTIME",
-      "ctime",               "INCLUDED_CTIME"              },
-    { "bsl_cwchar.h",        "INCLUDED_BSL_CWCHAR",
-      "cwchar",              "INCLUDED_CWCHAR"             },
-    { "bsl_cwctype.h",       "INCLUDED_BSL_CWCTYPE",
-      "cwctype",             "INCLUDED_CWCTYPE"            },
-    { "bsl_deque.h",         "INCLUDED_BSL_DEQUE",
-      "deque",               "INCLUDED_DEQUE"              },
-    { "bsl_exception.h",     "INCLUDED_BSL_EXCEPTION",
-      "exception",           "INCLUDED_EXCEPTION"          },
-    { "bsl_fstream.h",       "INCLUDED_BSL_FSTREAM",
-      "fstream",             "INCLUDED_FSTREAM"            },
-    { "bsl_functional.h",    "INCLUDED_BSL_FUNCTIONAL",
-      "functional",          "INCLUDED_FUNCTIONAL"         },
-    { "bsl_hash_map.h",      "INCLUDED_BSL_HASH_MAP",
-      "hash_map",            "INCLUDED_HASH_MAP"           },
-    { "bsl_hash_set.h",      "INCLUDED_BSL_HASH_SET",
-      "hash_set",            "INCLUDED_HASH_SET"           },
-    { "bsl_iomanip.h",       "INCLUDED_BSL_IOMANIP",
-      "iomanip",             "INCLUDED_IOMANIP"            },
-    { "bsl_ios.h",           "INCLUDED_BSL_IOS",
-      "ios",                 "INCLUDED_IOS"                },
-    { "bsl_iosfwd.h",        "INCLUDED_BSL_IOSFWD",
-      "iosfwd",              "INCLUDED_IOSFWD"             },
-    { "bsl_iostream.h",      "INCLUDED_BSL_IOSTREAM",
-      "iostream",            "INCLUDED_IOSTREAM"           },
-    { "bsl_istream.h",       "INCLUDED_BSL_ISTREAM",
-      "istream",             "INCLUDED_ISTREAM"            },
-    { "bsl_iterator.h",      "INCLUDED_BSL_ITERATOR",
-      "iterator",            "INCLUDED_ITERATOR"           },
-    { "bsl_limits.h",        "INCLUDED_BSL_LIMITS",
-      "limits",              "INCLUDED_LIMITS"             },
-    { "bsl_list.h",          "INCLUDED_BSL_LIST",
-      "list",                "INCLUDED_LIST"               },
-    { "bsl_locale.h",        "INCLUDED_BSL_LOCALE",
-      "locale",              "INCLUDED_LOCALE"             },
-    { "bsl_map.h",           "INCLUDED_BSL_MAP",
-      "map",                 "INCLUDED_MAP"                },
-    { "bsl_memory.h",        "INCLUDED_BSL_MEMORY",
-      "memory",              "INCLUDED_MEMORY"             },
-    { "bsl_new.h",           "INCLUDED_BSL_NEW",
-      "new",                 "INCLUDED_NEW"                },
-    { "bsl_numeric.h",       "INCLUDED_BSL_NUMERIC",
-      "numeric",             "INCLUDED_NUMERIC"            },
-    { "bsl_ostream.h",       "INCLUDED_BSL_OSTREAM",
-      "ostream",             "INCLUDED_OSTREAM"            },
-    { "bsl_queue.h",         "INCLUDED_BSL_QUEUE",
-      "queue",               "INCLUDED_QUEUE"              },
-    { "bsl_set.h",           "INCLUDED_BSL_SET",
-      "set",                 "INCLUDED_SET"                },
-    { "bsl_slist.h",         "INCLUDED_BSL_SLIST",
-      "slist",               "INCLUDED_SLIST"              },
-    { "bsl_sstream.h",       "INCLUDED_BSL_SSTREAM",
-      "sstream",             "INCLUDED_SSTREAM"            },
-    { "bsl_stack.h",         "INCLUDED_BSL_STACK",
-      "stack",               "INCLUDED_STACK"              },
-    { "bsl_stdexcept.h",     "INCLUDED_BSL_STDEXCEPT",
-      "stdexcept",           "INCLUDED_STDEXCEPT"          },
-    { "bsl_streambuf.h",     "INCLUDED_BSL_STREAMBUF",
-      "streambuf",           "INCLUDED_STREAMBUF"          },
-    { "bsl_string.h",        "INCLUDED_BSL_STRING",
-      "string",              "INCLUDED_STRING"             },
-    { "bsl_strstream.h",     "INCLUDED_BSL_STRSTREAM",
-      "strstream",           "INCLUDED_STRSTREAM"          },
-    { "bsl_typeinfo.h",      "INCLUDED_BSL_TYPEINFO",
-      "typeinfo",            "INCLUDED_TYPEINFO"           },
-    { "bsl_unordered_map.h", "INCLUDED_BSL_UNORDERED_MAP",
-      "unordered_map",       "INCLUDED_UNORDERED_MAP"      },
-    { "bsl_unordered_set.h", "INCLUDED_BSL_UNORDERED_SET",
-      "unordered_set",       "INCLUDED_UNORDERED_SET"      },
-    { "bsl_utility.h",       "INCLUDED_BSL_UTILITY",
-      "utility",             "INCLUDED_UTILITY"            },
-    { "bsl_valarray.h",      "INCLUDED_BSL_VALARRAY",
-      "valarray",            "INCLUDED_VALARRAY"           },
-    { "bsl_vector.h",        "INCLUDED_BSL_VECTOR",
-      "vector",              "INCLUDED_VECTOR"             },
-
-    // bsl_ versions of standard C headers
-
-    { "bsl_cassert.h",      "INCLUDED_BSL_CASSERT",
-      "assert.h",            "_ASSERT_H"                   },
-    { "bsl_cctype.h",       "INCLUDED_BSL_CCTYPE",
-      "ctype.h",             "_CTYPE_H"                    },
-    { "bsl_cerrno.h",       "INCLUDED_BSL_CERRNO",
-      "errno.h",             "_ERRNO_H"                    },
-    { "bsl_cfloat.h",       "INCLUDED_BSL_CFLOAT",
-      "float.h",             "_FLOAT_H"                    },
-    { "bsl_ciso646.h",      "INCLUDED_BSL_CISO646",
-      "iso646.h",            "_ISO646_H"                   },
-    { "bsl_climits.h",      "INCLUDED_BSL_CLIMITS",
-      "limits.h",            "_LIBC_LIMITS_H_"             },
-    { "bsl_clocale.h",      "INCLUDED_BSL_CLOCALE",
-      "locale.h",            "_LOCALE_H"                   },
-    { "bsl_cmath.h",        "INCLUDED_BSL_CMATH",
-      "math.h",              "_MATH_H"                     },
-    { "bsl_csetjmp.h",      "INCLUDED_BSL_CSETJMP",
-      "setjmp.h",            "_SETJMP_H"                   },
-    { "bsl_csignal.h",      "INCLUDED_BSL_CSIGNAL",
-      "signal.h",            "_SIGNAL_H"                   },
-    { "bsl_cstdarg.h",      "INCLUDED_BSL_CSTDARG",
-      "stdarg.h",            "_STDARG_H"                   },
-    { "bsl_cstddef.h",      "INCLUDED_BSL_CSTDDEF",
-      "stddef.h",            "_STDDEF_H"                   },
-    { "bsl_cstdio.h",       "INCLUDED_BSL_CSTDIO",
-      "stdio.h",             "_STDIO_H"                    },
-    { "bsl_cstdlib.h",      "INCLUDED_BSL_CSTDLIB",
-      "stdlib.h",            "_STDLIB_H"                   },
-    { "bsl_cstring.h",      "INCLUDED_BSL_CSTRING",
-      "string.h",            "_STRING_H"                   },
-    { "bsl_c_sys_time.h",    "INCLUDED_BSL_C_SYS_TIME",
-      "sys/time.h",          "_SYS_TIME_H"                 },
-    { "bsl_ctime.h",        "INCLUDED_BSL_CTIME",
-      "time.h",              "_TIME_H"                     },
-    { "bsl_cwchar.h",       "INCLUDED_BSL_CWCHAR",
-      "wchar.h",             "_WCHAR_H"                    },
-    { "bsl_cwctype.h",      "INCLUDED_BSL_CWCTYPE",
-      "wctype.h",            "_WCTYPE_H"                   },
-
-    { "bsl_c_assert.h",     "INCLUDED_BSL_C_ASSERT",
-      "bsl_cassert.h",      "INCLUDED_BSL_CASSERT"         },
-    { "bsl_c_ctype.h",      "INCLUDED_BSL_C_CTYPE",
-      "bsl_cctype.h",       "INCLUDED_BSL_CCTYPE"          },
-    { "bsl_c_errno.h",      "INCLUDED_BSL_C_ERRNO",
-      "bsl_cerrno.h",       "INCLUDED_BSL_CERRNO"          },
-    { "bsl_c_float.h",      "INCLUDED_BSL_C_FLOAT",
-      "bsl_cfloat.h",       "INCLUDED_BSL_CFLOAT"          },
-    { "bsl_c_iso646.h",     "INCLUDED_BSL_C_ISO646",
-      "bsl_ciso646.h",      "INCLUDED_BSL_CISO646"         },
-    { "bsl_c_limits.h",     "INCLUDED_BSL_C_LIMITS",
-      "bsl_climits.h",      "INCLUDED_BSL_CLIMITS"         },
-    { "bsl_c_locale.h",     "INCLUDED_BSL_C_LOCALE",
-      "bsl_clocale.h",      "INCLUDED_BSL_CLOCALE"         },
-    { "bsl_c_math.h",       "INCLUDED_BSL_C_MATH",
-      "bsl_cmath.h",        "INCLUDED_BSL_CMATH"           },
-    { "bsl_c_setjmp.h",     "INCLUDED_BSL_C_SETJMP",
-      "bsl_csetjmp.h",      "INCLUDED_BSL_CSETJMP"         },
-    { "bsl_c_signal.h",     "INCLUDED_BSL_C_SIGNAL",
-      "bsl_csignal.h",      "INCLUDED_BSL_CSIGNAL"         },
-    { "bsl_c_stdarg.h",     "INCLUDED_BSL_C_STDARG",
-      "bsl_cstdarg.h",      "INCLUDED_BSL_CSTDARG"         },
-    { "bsl_c_stddef.h",     "INCLUDED_BSL_C_STDDEF",
-      "bsl_cstddef.h",      "INCLUDED_BSL_CSTDDEF"         },
-    { "bsl_c_stdio.h",      "INCLUDED_BSL_C_STDIO",
-      "bsl_cstdio.h",       "INCLUDED_BSL_CSTDIO"          },
-    { "bsl_c_stdlib.h",     "INCLUDED_BSL_C_STDLIB",
-      "bsl_cstdlib.h",      "INCLUDED_BSL_CSTDLIB"         },
-    { "bsl_c_string.h",     "INCLUDED_BSL_C_STRING",
-      "bsl_cstring.h",      "INCLUDED_BSL_CSTRING"         },
-    { "bsl_c_time.h",       "INCLUDED_BSL_C_TIME",
-      "bsl_ctime.h",        "INCLUDED_BSL_CTIME"           },
-    { "bsl_c_wchar.h",      "INCLUDED_BSL_C_WCHAR",
-      "bsl_cwchar.h",       "INCLUDED_BSL_CWCHAR"          },
-    { "bsl_c_wctype.h",     "INCLUDED_BSL_C_WCTYPE",
-      "bsl_cwctype.h",      "INCLUDED_BSL_CWCTYPE"         },
-
-    // GCC has some cross-includes that cause problems.  For example, <ios>
-    // includes <stl_algobase.h> without going through <algorithm>, so the
-    // replacement of std::max with bsl::max fails when <ios> is replaced with
-    // <bsl_ios.h>.  This section will include these sepcial non-standard
-    // headers.
-
-    { "bsl_algorithm.h",  "INCLUDED_BSL_ALGORITHM",
-      "stl_algo.h",       "_ALGO_H"                  },
-    { "bsl_algorithm.h",  "INCLUDED_BSL_ALGORITHM",
-      "stl_algobase.h",   "_ALGOBASE_H"              },
-    { "bsl_functional.h", "INCLUDED_BSL_FUNCTIONAL",
-      "stl_function.h",   "_FUNCTION_H"              },
-    { "bsl_utility.h",    "INCLUDED_BSL_UTILITY",
-      "stl_pair.h",       "_PAIR_H"                  },
-    { "bsl_ios.h",        "INCLUDED_BSL_IOS",
-      "postypes.h",       "_GLIBCXX_POSTYPES_H"      },
-    { "bsl_ios.h",        "INCLUDED_BSL_IOS",
-      "ios_base.h",       "_IOS_BASE_H"              },
-    { "bsl_memory.h",     "INCLUDED_BSL_MEORY",
-      "auto_ptr.h",       "_BACKWARD_AUTO_PTR_H"     },
-
-    // 'bsl_' equivalents for 'bslstl_' files
-    { "bsl_algorithm.h",                  "INCLUDED_BSL_ALGORITHM",
-      "bslstl_algorithmworkaround.h",  "INCLUDED_BSLSTL_ALGORITHMWORKAROUND" },
-    { "bsl_memory.h",                     "INCLUDED_BSL_MEMORY",
-      "bslstl_allocator.h",               "INCLUDED_BSLSTL_ALLOCATOR"        },
-    { "bsl_memory.h",                     "INCLUDED_BSL_MEMORY",
-      "bslstl_allocatortraits.h",         "INCLUDED_BSLSTL_ALLOCATORTRAITS"  },
-    { "bsl_memory.h",                     "INCLUDED_BSL_MEMORY",
-      "bslstl_badweakptr.h",              "INCLUDED_BSLSTL_BADWEAKPTR"       },
-    { "bsl_iterator.h",                   "INCLUDED_BSL_ITERATOR",
-      "bslstl_bidirectionaliterator.h",
-                                     "INCLUDED_BSLSTL_BIDIRECTIONALITERATOR" },
-    { "bsl_set.h",                        "INCLUDED_BSL_SET",
-      "bslstl_bidirectionalnodepool.h",
-                                     "INCLUDED_BSLSTL_BIDIRECTIONALNODEPOOL" },
-    { "bsl_bitset.h",                     "INCLUDED_BSL_BITSET",
-      "bslstl_bitset.h",                  "INCLUDED_BSLSTL_BITSET"           },
-    { "bsl_deque.h",                      "INCLUDED_BSL_DEQUE",
-      "bslstl_deque.h",                   "INCLUDED_BSLSTL_DEQUE"            },
-    { "bsl_functional.h",                 "INCLUDED_BSL_FUNCTIONAL",
-      "bslstl_equalto.h",                 "INCLUDED_BSLSTL_EQUALTO"          },
-    { "bsl_iterator.h",                   "INCLUDED_BSL_ITERATOR",
-      "bslstl_forwarditerator.h",         "INCLUDED_BSLSTL_FORWARDITERATOR"  },
-    { "bsl_functional.h",                 "INCLUDED_BSL_FUNCTIONAL",
-      "bslstl_hash.h",                    "INCLUDED_BSLSTL_HASH"             },
-    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
-      "bslstl_hashtable.h",               "INCLUDED_BSLSTL_HASHTABLE"        },
-    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
-      "bslstl_hashtablebucketiterator.h",
-                                   "INCLUDED_BSLSTL_HASHTABLEBUCKETITERATOR" },
-    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
-      "bslstl_hashtableiterator.h",      "INCLUDED_BSLSTL_HASHTABLEITERATOR" },
-    { "bsl_iosfwd.h"                      "INCLUDED_BSL_IOSFWD",
-      "bslstl_iosfwd.h",                  "INCLUDED_BSLSTL_IOSFWD"           },
-    { "bsl_sstream.h",                    "INCLUDED_BSL_SSTREAM",
-      "bslstl_istringstream.h",           "INCLUDED_BSLSTL_ISTRINGSTREAM"    },
-    { "bsl_iterator.h",                   "INCLUDED_BSL_ITERATOR",
-      "bslstl_iterator.h",                "INCLUDED_BSLSTL_ITERATOR"         },
-    { "bsl_unordered_set.h",              "INCLUDED_BSL_UNORDERED_SET",
-      "bslstl_iteratorutil.h",            "INCLUDED_BSLSTL_ITERATORUTIL"     },
-    { "bsl_list.h",                       "INCLUDED_BSL_LIST",
-      "bslstl_list.h",                    "INCLUDED_BSLSTL_LIST"             },
-    { "bsl_map.h",                        "INCLUDED_BSL_MAP",
-      "bslstl_map.h",                     "INCLUDED_BSLSTL_MAP"              },
-    { "bsl_map.h",                        "INCLUDED_BSL_MAP",
-      "bslstl_mapcomparator.h",           "INCLUDED_BSLSTL_MAPCOMPARATOR"    },
-    { "bsl_map.h",                        "INCLUDED_BSL_MAP",
-      "bslstl_multimap.h",                "INCLUDED_BSLSTL_MULTIMAP"         },
-    { "bsl_set.h",                        "INCLUDED_BSL_SET",
-      "bslstl_multiset.h",                "INCLUDED_BSLSTL_MULTISET"         },
-    { "bsl_sstream.h",                    "INCLUDED_BSL_SSTREAM",
-      "bslstl_ostringstream.h",           "INCLUDED_BSLSTL_OSTRINGSTREAM"    },
-    { "bsl_utility.h",                    "INCLUDED_BSL_UTILITY",
-      "bslstl_pair.h",                    "INCLUDED_BSLSTL_PAIR"             },
-    { "bsl_queue.h",                      "INCLUDED_BSL_QUEUE",
-      "bslstl_queue.h",                   "INCLUDED_BSLSTL_QUEUE"            },
-    { "bsl_iterator.h",                   "INCLUDED_BSL_ITERATOR",
-      "bslstl_randomaccessiterator.h",
-                                      "INCLUDED_BSLSTL_RANDOMACCESSITERATOR" },
-    { "bsl_set.h",                        "INCLUDED_BSL_SET",
-      "bslstl_set.h",                     "INCLUDED_BSLSTL_SET"              },
-    { "bsl_set.h",                        "INCLUDED_BSL_SET",
-      "bslstl_setcomparator.h",           "INCLUDED_BSLSTL_SETCOMPARATOR"    },
-    { "bsl_memory.h",                     "INCLUDED_BSL_MEMORY",
-      "bslstl_sharedptr.h",               "INCLUDED_BSLSTL_SHAREDPTR"        },
-    { "bsl_set.h",                        "INCLUDED_BSL_SET",
-      "bslstl_simplepool.h",              "INCLUDED_BSLSTL_SIMPLEPOOL"       },
-    { "bsl_sstream.h",                    "INCLUDED_BSL_SSTREAM",
-      "bslstl_sstream.h",                 "INCLUDED_BSLSTL_SSTREAM"          },
-    { "bsl_stack.h",                      "INCLUDED_BSL_STACK",
-      "bslstl_stack.h",                   "INCLUDED_BSLSTL_STACK"            },
-    { "bsl_bitset.h",                     "INCLUDED_BSL_BITSET",
-      "bslstl_stdexceptutil.h",           "INCLUDED_BSLSTL_STDEXCEPTUTIL"    },
-    { "bsl_string.h",                     "INCLUDED_BSL_STRING",
-      "bslstl_string.h",                  "INCLUDED_BSLSTL_STRING"           },
-    { "bsl_sstream.h",                    "INCLUDED_BSL_SSTREAM",
-      "bslstl_stringbuf.h",               "INCLUDED_BSLSTL_STRINGBUF"        },
-    { "bsl_string.h",                     "INCLUDED_BSL_STRING",
-      "bslstl_stringref.h",               "INCLUDED_BSLSTL_STRINGREF"        },
-    { "bsl_string.h",                     "INCLUDED_BSL_STRING",
-      "bslstl_stringrefdata.h",           "INCLUDED_BSLSTL_STRINGREFDATA"    },
-    { "bsl_sstream.h",                    "INCLUDED_BSL_SSTREAM",
-      "bslstl_stringstream.h",            "INCLUDED_BSLSTL_STRINGSTREAM"     },
-    { "bsl_set.h",                        "INCLUDED_BSL_SET",
-      "bslstl_treeiterator.h",            "INCLUDED_BSLSTL_TREEITERATOR"     },
-    { "bsl_set.h",                        "INCLUDED_BSL_SET",
-      "bslstl_treenode.h",                "INCLUDED_BSLSTL_TREENODE"         },
-    { "bsl_set.h",                        "INCLUDED_BSL_SET",
-      "bslstl_treenodepool.h",            "INCLUDED_BSLSTL_TREENODEPOOL"     },
-    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
-      "bslstl_unorderedmap.h",            "INCLUDED_BSLSTL_UNORDEREDMAP"     },
-    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
-      "bslstl_unorderedmapkeyconfiguration.h",
-                              "INCLUDED_BSLSTL_UNORDEREDMAPKEYCONFIGURATION" },
-    { "bsl_unordered_map.h",              "INCLUDED_BSL_UNORDERED_MAP",
-      "bslstl_unorderedmultimap.h",      "INCLUDED_BSLSTL_UNORDEREDMULTIMAP" },
-    { "bsl_unordered_set.h",              "INCLUDED_BSL_UNORDERED_SET",
-      "bslstl_unorderedmultiset.h",      "INCLUDED_BSLSTL_UNORDEREDMULTISET" },
-    { "bsl_unordered_set.h",              "INCLUDED_BSL_UNORDERED_SET",
-      "bslstl_unorderedset.h",            "INCLUDED_BSLSTL_UNORDEREDSET"     },
-    { "bsl_unordered_set.h",              "INCLUDED_BSL_UNORDERED_SET",
-      "bslstl_unorderedsetkeyconfiguration.h",
-                              "INCLUDED_BSLSTL_UNORDEREDSETKEYCONFIGURATION" },
-    { "bsl_vector.h",                     "INCLUDED_BSL_VECTOR",
-      "bslstl_vector.h",                  "INCLUDED_BSLSTL_VECTOR"           },
-
-    // 'bsl_' equivalents for 'bslstp_' files
-    { "bsl_algorithm.h",       "INCLUDED_BSL_ALGORITHM",
-      "bslstp_exalgorithm.h",  "INCLUDE_BSLSTP_EXALGORITHM"   },
-    { "bsl_functional.h",      "INCLUDED_BSL_FUNCTIONAL",
-      "bslstp_exfunctional.h", "INCLUDE_BSLSTP_EXFUNCTIONAL"  },
-    { "bsl_cstddef.h",         "INCLUDED_BSL_CSTDDEF",
-      "bslstp_hash.h",         "INCLUDE_BSLSTP_HASH"          },
-    { "bsl_functional.h",      "INCLUDED_BSL_FUNCTIONAL",
-      "bslstp_hashmap.h",      "INCLUDE_BSLSTP_HASHMAP"       },
-    { "bsl_functional.h",      "INCLUDED_BSL_FUNCTIONAL",
-      "bslstp_hashset.h",      "INCLUDE_BSLSTP_HASHSET"       },
-    { "bsl_algorithm.h",       "INCLUDED_BSL_ALGORITHM",
-      "bslstp_hashtable.h",    "INCLUDE_BSLSTP_HASHTABLE"     },
-    { "bsl_functional.h",      "INCLUDED_BSL_FUNCTIONAL",
-      "bslstp_hashtable.h",    "INCLUDE_BSLSTP_HASHTABLE"     },
-    { "bsl_iterator.h",        "INCLUDED_BSL_ITERATOR",
-      "bslstp_hashtable.h",    "INCLUDE_BSLSTP_HASHTABLE"     },
-    { "bsl_cstddef.h",         "INCLUDED_BSL_CSTDDEF",
-      "bslstp_iterator.h",     "INCLUDE_BSLSTP_ITERATOR"      },
-    { "bsl_algorithm.h",       "INCLUDED_BSL_ALGORITHM",
-      "bslstp_slist.h",        "INCLUDE_BSLSTP_SLIST"         },
-    { "bsl_cstddef.h",         "INCLUDED_BSL_CSTDDEF",
-      "bslstp_slist.h",        "INCLUDE_BSLSTP_SLIST"         },
-    { "bsl_iterator.h",        "INCLUDED_BSL_ITERATOR",
-      "bslstp_slist.h",        "INCLUDE_BSLSTP_SLIST"         },
-    { "bsl_cstddef.h",         "INCLUDED_BSL_CSTDDEF",
-      "bslstp_slistbase.h",    "INCLUDE_BSLSTP_SLISTBASE"     },
-
-    // There are some bsls_ files that include headers transitively in override
-    // mode only, so if we see those headers we may need to include the
-    // transitive header explicitly.
-
-    { "bsl_cstddef.h",          "INCLUDED_BSL_CSTDDEF",
-      "bsls_alignment.h",       "INCLUDED_BSLS_ALIGNMENT"        },
-    { "bsl_limits.h",           "INCLUDED_BSL_LIMITS",
-      "bsls_alignmentutil.h",   "INCLUDED_BSLS_ALIGNMENTUTIL"    },
-    { "bsl_cstddef.h",          "INCLUDED_BSL_CSTDDEF",
-      "bsls_platformutil.h",    "INCLUDED_BSLS_PLATFORMUTIL"     },
-    { "bsl_iosfwd.h",           "INCLUDED_BSL_IOSFWD",
-      "bsls_systemclocktype.h", "INCLUDED_BSLS_SYSTEMCLOCK_TYPE" },
-    { "bsl_ostream.h",          "INCLUDED_BSL_OSTREAM",
-      "bsls_timeinterval.h",    "INCLUDED_BSLS_TIMEINTERVAL"     },
-    { "bsl_cstddef.h",          "INCLUDED_BSL_CSTDDEF",
-      "bsls_types.h",           "INCLUDED_BSLS_TYPES"            },
-    { "bslalg_typetraits.h",    "INCLUDED_BSLALG_TYPETRAITS",
-      "bsl_string.h",           "INCLUDED_BSL_STRING"            },
-    { "bsls_atomic.h",          "INCLUDED_BSLS_ATOMIC",
-      "bslma_sharedptrrep.h",   "INCLUDED_BSLMA_SHAREDPTRREP"    },
-    { "bslma_managedptr.h",     "INCLUDED_BSLMA_MANAGEDPTR",
-      "bslalg_swaputil.h",      "INCLUDED_BSLALG_SWAPUTIL"       },
-    { "bsls_types.h",           "INCLUDED_BSLS_TYPES",
-      "bdet_packedcalendar.h",  "INCLUDED_BDET_PACKEDCALENDAR"   },
-};
-
 const char *good_bsl[] = {
 #if 0
     "baea_",    "baecs_",   "baedb_",   "baejsn_",  "bael_",    "baelu_",
@@ -520,7 +141,7 @@ struct report : public RecursiveASTVisitor<report>
         // signature.
 
     FileType classify(llvm::StringRef name,
-                      const std::vector<const file_info *> **pfvi = 0);
+                      const HeaderIndex::Pairs **pfvi = 0);
         // Return one of the 'FileType' enumerators describing the specified
         // 'name'.  Optionally specify 'pfvi' to receive the corresponding file
         // data.
@@ -672,7 +293,7 @@ report::report(Analyser& analyser, PPObserver::CallbackType type)
 }
 
 FileType report::classify(llvm::StringRef name,
-                          const std::vector<const file_info *> **pfvi)
+                          const HeaderIndex::Pairs **pfvi)
 {
     FileName fn(name);
 
@@ -682,7 +303,8 @@ FileType report::classify(llvm::StringRef name,
     }
 
     if (d_data.d_file_info.find(name) == d_data.d_file_info.end()) {
-        d_data.d_file_info[name].second = e_UNK;
+        d_data.d_file_info[name] = std::make_pair(HeaderIndex::pairs(name),
+                                                  e_UNK);
     }
     auto& p = d_data.d_file_info[name];
     if (pfvi) {
@@ -708,8 +330,8 @@ FileType report::classify(llvm::StringRef name,
         }
     }
 
-    for (const file_info *f : p.first) {
-        if (name == f->std) {
+    for (const HeaderPair *f : p.first) {
+        if (name == f->d_std) {
             return p.second = e_STD;                                  // RETURN
         }
     }
@@ -849,42 +471,42 @@ void report::operator()(SourceLocation   where,
     push_include(
         fid, name, d_data.d_guard_pos.isValid() ? d_data.d_guard_pos : where);
 
-    const std::vector<const file_info *> *pfvi;
+    const HeaderIndex::Pairs *pfvi;
 
     if (!d_data.d_in_bsl &&
         !d_data.d_in_std &&
         ft == e_NIL &&
         !m.isInSystemHeader(where) &&
         classify(name, &pfvi) == e_STD) {
-        for (const file_info *fi : *pfvi) {
-            if (d_data.d_guard == fi->std_guard) {
+        for (const HeaderPair *fi : *pfvi) {
+            if (d_data.d_guard == fi->d_std_guard) {
                 SourceRange r = d_analyser.get_line_range(d_data.d_guard_pos);
                 llvm::StringRef s = d_analyser.get_source(r);
                 size_t pos = s.find(d_data.d_guard);
                 if (pos != s.npos) {
                     d_analyser.report(r.getBegin(), check_name, "SB02",
                                       "Replacing include guard %0 with %1")
-                        << fi->std_guard
-                        << fi->bsl_guard;
+                        << fi->d_std_guard
+                        << fi->d_bsl_guard;
                     d_analyser.ReplaceText(
                         getOffsetRange(r, pos, d_data.d_guard.size()),
-                        fi->bsl_guard);
+                        fi->d_bsl_guard);
                 }
             }
             d_analyser.report(where, check_name, "SB01",
                               "Replacing header %2%0%3 with <%1>")
-                << fi->std
-                << fi->bsl
+                << fi->d_std
+                << fi->d_bsl
                 << (angled ? "<" : "\"")
                 << (angled ? ">" : "\"");
             SourceRange r = d_analyser.get_trim_line_range(where);
-            std::string s = "#include <" + std::string(fi->bsl) + ">";
+            std::string s = "#include <" + std::string(fi->d_bsl) + ">";
             if (d_data.d_insert_extcpp && d_analyser.is_header(loc.file())) {
                 s = "extern \"C++\" {\n" + s + "\n}";
             }
             d_analyser.ReplaceText(r, s);
-            change_include(fid, fi->bsl);
-            if (d_data.d_guard == fi->std_guard) {
+            change_include(fid, fi->d_bsl);
+            if (d_data.d_guard == fi->d_std_guard) {
                 SourceRange r = d_analyser.get_line_range(d_data.d_guard_pos);
                 r = d_analyser.get_line_range(
                     r.getEnd().getLocWithOffset(1));
@@ -1187,37 +809,38 @@ void report::operator()(SourceRange range)
                          matches[2],
                          d_data.d_guard_pos.isValid() ? d_data.d_guard_pos :
                                                         range.getBegin());
-            const std::vector<const file_info *> *pfvi;
+            const HeaderIndex::Pairs *pfvi;
             FileType ft = classify(matches[2], &pfvi);
             if (ft == e_STD) {
-                for (const file_info *fi : *pfvi) {
+                for (const HeaderPair *fi : *pfvi) {
                     std::pair<size_t, size_t> m;
                     SourceLocation rbm =
                         range.getBegin().getLocWithOffset(m.first);
-                    if (d_data.d_guard == fi->std_guard) {
+                    if (d_data.d_guard == fi->d_std_guard) {
                         m = mid_match(source, matches[1]);
                         d_analyser.report(rbm, check_name, "SB02",
                                           "Replacing include guard %0 with %1")
-                            << fi->std_guard
-                            << fi->bsl_guard;
+                            << fi->d_std_guard
+                            << fi->d_bsl_guard;
                         d_analyser.ReplaceText(
                             getOffsetRange(range, m.first, matches[1].size()),
-                            fi->bsl_guard);
+                            fi->d_bsl_guard);
                     }
                     m = mid_match(source, matches[2]);
                     rbm = range.getBegin().getLocWithOffset(m.first);
                     d_analyser.report(rbm, check_name, "SB01",
                                       "Replacing header <%0> with <%1>")
                         << matches[2]
-                        << fi->bsl;
-                    std::string s = "#include <" + std::string(fi->bsl) + ">";
+                        << fi->d_bsl;
+                    std::string s =
+                        "#include <" + std::string(fi->d_bsl) + ">";
                     if (d_data.d_insert_extcpp &&
                         d_analyser.is_header(loc.file())) {
                         s = "extern \"C++\" {\n" + s + "\n}";
                     }
                     d_analyser.ReplaceText(
                         d_analyser.get_trim_line_range(rbm), s);
-                    change_include(fid, fi->bsl);
+                    change_include(fid, fi->d_bsl);
                     if (matches[3].size() > 0) {
                         m = mid_match(source, matches[3]);
                         rbm = range.getBegin().getLocWithOffset(m.first);
@@ -1309,17 +932,17 @@ void report::add_include(FileID             fid,
     }
 
     Location loc(m, sl);
-    const std::vector<const file_info *> *pfvi_name;
+    const HeaderIndex::Pairs *pfvi_name;
     classify(name, &pfvi_name);
     std::string guard;
     if (d_analyser.is_header(loc.file())) {
-        for (const file_info *fi_name : *pfvi_name) {
-            if (name == fi_name->std) {
-                guard = fi_name->std_guard;
+        for (const HeaderPair *fi_name : *pfvi_name) {
+            if (name == fi_name->d_std) {
+                guard = fi_name->d_std_guard;
                 break;
             }
-            if (name == fi_name->bsl) {
-                guard = fi_name->bsl_guard;
+            if (name == fi_name->d_bsl) {
+                guard = fi_name->d_bsl_guard;
                 break;
             }
         }
@@ -1330,7 +953,7 @@ void report::add_include(FileID             fid,
     }
     SourceLocation ip = sl;
     for (const auto& p : d_data.d_includes[fid]) {
-        const std::vector<const file_info *> *pfvi_inc;
+        const HeaderIndex::Pairs *pfvi_inc;
         llvm::StringRef pn = std::get<0>(p);
         SourceLocation pl = std::get<1>(p);
         bool local = std::get<2>(p);
@@ -1347,12 +970,12 @@ void report::add_include(FileID             fid,
             in_noinc_region(pl)) {
             continue;
         }
-        llvm::StringRef inc = pfvi_inc->size() ? pfvi_inc->front()->bsl : pn;
+        llvm::StringRef inc = pfvi_inc->size() ? pfvi_inc->front()->d_bsl : pn;
         if (!d_analyser.is_component_header(inc) &&
             !inc.endswith("_version.h") &&
             !inc.endswith("_ident.h") &&
             (pfvi_inc->size() && pfvi_name->size() ?
-                 pfvi_inc->front()->bsl > pfvi_name->front()->bsl :
+                 pfvi_inc->front()->d_bsl > pfvi_name->front()->d_bsl :
                  inc > name)) {
             ip = pl;
         }
@@ -1426,11 +1049,11 @@ void report::require_file(std::string     name,
     FileName fn(name);
     name = fn.name();
 
-    const std::vector<const file_info *> *pfvi;
+    const HeaderIndex::Pairs *pfvi;
     FileType ft = classify(name, &pfvi);
     if (ft == e_STD) {
-        for (const file_info *fi : *pfvi) {
-            name = fi->bsl;
+        for (const HeaderPair *fi : *pfvi) {
+            name = fi->d_bsl;
         }
     }
 
@@ -1619,8 +1242,6 @@ bool report::VisitUnresolvedLookupExpr(UnresolvedLookupExpr *expr)
 // TranslationUnitDone
 void report::operator()()
 {
-    TraverseDecl(d_analyser.context()->getTranslationUnitDecl());
-
     for (const auto& rp : d_data.d_std_names) {
         llvm::StringRef r = rp.first;
         SourceLocation sl = rp.second;
@@ -1646,13 +1267,9 @@ void report::operator()()
 void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
     // Hook up the callback functions.
 {
+    // Includes are needed for what is used in headers too.
+    analyser.keep_function_bodies();
     data &d = analyser.attachment<data>();
-    for (const auto& f : include_pairs) {
-        d.d_file_info[f.std].first.push_back(&f);
-        d.d_file_info[f.std].second = e_UNK;
-        d.d_file_info[f.bsl].first.push_back(&f);
-        d.d_file_info[f.bsl].second = e_UNK;
-    }
     d.d_insert_guard =
         llvm::StringRef(analyser.config()->value("bslovrstd_guard")) == "on";
     d.d_insert_extcpp =
@@ -1677,6 +1294,7 @@ void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
     observer.onPPElif               += report(analyser, observer.e_Elif);
     observer.onPPElse               += report(analyser, observer.e_Else);
     observer.onPPEndif              += report(analyser, observer.e_Endif);
+    analyser.add_pass(check_name, report(analyser));
     analyser.onTranslationUnitDone  += report(analyser);
 }
 
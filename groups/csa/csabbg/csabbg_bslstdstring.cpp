@@ -35,52 +35,53 @@ struct report : Report<data>
 {
     INHERIT_REPORT_CTOR(report, Report, data);
 
-    void operator()();
+    void match_to_bsl(const BoundNodes &nodes);
+    void match_to_std(const BoundNodes &nodes);
 };
 
-void report::operator()()
+void report::match_to_bsl(const BoundNodes &nodes)
 {
-    auto tu = a.context()->getTranslationUnitDecl();
-    MatchFinder mf;
-
-    OnMatch<> m1([&](const BoundNodes &nodes) {
-        auto e = nodes.getNodeAs<Expr>("e");
-        a.report(e, check_name, "ST01",
-                 "Converting std::string to bsl::string");
-    });
-    mf.addDynamicMatcher(
-        decl(forEachDescendant(
-            cxxConstructExpr(
-                hasDeclaration(cxxConstructorDecl(
-                    matchesName("::bsl::basic_string<"),
-                    hasParameter(
-                        0,
-                        parmVarDecl(hasType(referenceType(
-                            pointee(hasDeclaration(namedDecl(matchesName(
-                                "::(native_)?std(::__cxx11)?::basic_string"))))
-            ))))))).bind("e"))),
-        &m1);
-
-    OnMatch<> m2([&](const BoundNodes &nodes) {
-        auto e = nodes.getNodeAs<Expr>("e");
-        a.report(e, check_name, "ST02",
-                 "Converting bsl::string to std::string");
-    });
-    mf.addDynamicMatcher(
-        decl(forEachDescendant(
-            cxxMemberCallExpr(
-                on(hasType(recordDecl(matchesName("::bsl::basic_string")))),
-                callee(cxxMethodDecl(matchesName("operator basic_string"))))
-                .bind("e"))),
-        &m2);
-
-    mf.match(*tu, *a.context());
+    auto e = nodes.getNodeAs<Expr>("e");
+    a.report(e, check_name, "ST01",
+             "Converting std::string to bsl::string");
+}
+
+void report::match_to_std(const BoundNodes &nodes)
+{
+    auto e = nodes.getNodeAs<Expr>("e");
+    a.report(e, check_name, "ST02",
+             "Converting bsl::string to std::string");
 }
 
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
     // Hook up the callback functions.
 {
-    analyser.onTranslationUnitDone += report(analyser);
+    analyser.add_matcher(
+        check_name,
+        cxxConstructExpr(
+            hasDeclaration(cxxConstructorDecl(
+                matchesName("::bsl::basic_string<"),
+                hasParameter(
+                    0,
+                    parmVarDecl(hasType(referenceType(
+                        pointee(hasDeclaration(namedDecl(matchesName(
+                            "::(native_)?std(::__cxx11)?::basic_string"))))
+        ))))))).bind("e"),
+        [&analyser](const BoundNodes &nodes) {
+            report(analyser).match_to_bsl(nodes);
+        },
+        Analyser::e_Instantiations);
+
+    analyser.add_matcher(
+        check_name,
+        cxxMemberCallExpr(
+            on(hasType(recordDecl(matchesName("::bsl::basic_string")))),
+            callee(cxxMethodDecl(matchesName("operator basic_string"))))
+            .bind("e"),
+        [&analyser](const BoundNodes &nodes) {
+            report(analyser).match_to_std(nodes);
+        },
+        Analyser::e_Instantiations);
 }
 
 }  // close anonymous namespace
@@ -27,7 +27,7 @@ static void enum_value(Analyser& analyser, EnumDecl const *decl)
 
 // ----------------------------------------------------------------------------
 
-static RegisterCheck c0(check_name, &enum_value);
+static RegisterCheck c0(check_name, &enum_value, CheckRegistry::e_Diagnosable);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
@@ -10,6 +10,7 @@
 #include <clang/Basic/SourceManager.h>
 #include <clang/Basic/Specifiers.h>
 #include <csabase_analyser.h>
+#include <csabase_commentindex.h>
 #include <csabase_config.h>
 #include <csabase_debug.h>
 #include <csabase_diagnostic_builder.h>
@@ -18,6 +19,7 @@
 #include <csabase_registercheck.h>
 #include <csabase_util.h>
 #include <ctype.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Casting.h>
@@ -26,8 +28,9 @@
 #include <stdlib.h>
 #include <utils/event.hpp>
 #include <utils/function.hpp>
+#include <algorithm>
 #include <cctype>
-#include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -49,87 +52,109 @@ namespace
 struct data
     // Data attached to analyzer for this check.
 {
-    typedef std::vector<SourceRange> Ranges;
-    typedef std::map<std::string, Ranges> Comments;
-    Comments d_comments;  // Comment blocks per file.
+    typedef CommentIndex::Ranges Ranges;
 
     typedef std::vector<std::pair<const FunctionDecl*, SourceRange> > FunDecls;
     FunDecls d_fundecls;  // FunDecl, comment
 };
 
-struct fmap
+struct cognates
+    // The function declarations of one declaration context, indexed by name
+    // and by the lines they span, for finding the cognates of a function.
 {
-    typedef std::multimap<unsigned, data::FunDecls::iterator> FMap;
-    FMap fmap_;
+    typedef std::vector<std::pair<unsigned, unsigned> > Lines;
 
-    enum Status { e_Empty, e_Found, e_NotFound };
+    std::set<std::string> d_named;  // names of functions with contracts
+    Lines d_runs;                   // runs of lines spanned by declarations
+    Lines d_found;                  // lines of declarations with contracts
 
-    Status find_contract(unsigned line) const;
-        // Return the status of finding a function contract at the specified
-        // 'line'.  The status is 'e_Empty' if there are no functions there,
-        // 'e_Found' if a function has a contract, and 'e_NotFound' if none do.
+    void insert(unsigned from, unsigned to, bool found);
+        // Note a declaration spanning the lines inclusively between the
+        // specified 'from' and 'to', having a contract iff the specified
+        // 'found' is 'true'.
 
-    void insert(unsigned from, unsigned to, data::FunDecls::iterator itr);
-        // Insert the specified 'itr' into the function map for all keys
-        // inclusively between the specified 'from' and 'to'.
+    void merge();
+        // Sort the noted lines and coalesce them into disjoint runs.
+
+    bool find_contract(unsigned from, unsigned to) const;
+        // Return 'true' iff a declaration with a contract spans a line of the
+        // unbroken run of declarations that starts just after the specified
+        // line 'to' or ends just before the specified line 'from'.
 };
 
-fmap::Status fmap::find_contract(unsigned line) const
+void cognates::insert(unsigned from, unsigned to, bool found)
 {
-    std::pair<FMap::const_iterator, FMap::const_iterator> itrs =
-        fmap_.equal_range(line);
-    if (itrs.first == itrs.second) {
-        return e_Empty;                                               // RETURN
+    d_runs.push_back(std::make_pair(from, to));
+    if (found) {
+        d_found.push_back(std::make_pair(from, to));
     }
-    while (itrs.first != itrs.second) {
-        if (itrs.first++->second->second.isValid()) {
-            return e_Found;                                           // RETURN
+}
+
+void coalesce(cognates::Lines *lines)
+    // Sort the specified 'lines' and merge the adjacent and overlapping ones.
+{
+    std::sort(lines->begin(), lines->end());
+    size_t n = 0;
+    for (size_t i = 0; i < lines->size(); ++i) {
+        if (n > 0 && (*lines)[i].first <= (*lines)[n - 1].second + 1) {
+            (*lines)[n - 1].second =
+                std::max((*lines)[n - 1].second, (*lines)[i].second);
+        }
+        else {
+            (*lines)[n++] = (*lines)[i];
         }
     }
-    return e_NotFound;
+    lines->resize(n);
 }
 
-void fmap::insert(unsigned from, unsigned to, data::FunDecls::iterator itr)
+void cognates::merge()
 {
-    while (from <= to) {
-        fmap_.insert(std::make_pair(from++, itr));
-    }
+    coalesce(&d_runs);
+    coalesce(&d_found);
 }
 
-struct comments
-    // Callback object for inspecting comments.
+bool cognates::find_contract(unsigned from, unsigned to) const
 {
-    Analyser& d_analyser;         // Analyser object.
-    SourceManager& d_manager;     // SourceManager within Analyser.
-    data::Comments& d_comments;   // Analyser's comment data.
+    typedef std::pair<unsigned, unsigned> Span;
+    auto by_first = [](unsigned line, Span const& s) {
+        return line < s.first;
+    };
 
-    comments(Analyser& analyser);
-        // Create a 'comments' object, accessing the specified 'analyser'.
+    // Look at the declarations following the lines.
+    unsigned line = to + 1;
+    Lines::const_iterator r =
+        std::upper_bound(d_runs.begin(), d_runs.end(), line, by_first);
+    if (r != d_runs.begin() && (--r)->second >= line) {
+        Lines::const_iterator f = std::lower_bound(
+            d_found.begin(), d_found.end(), line,
+            [](Span const& s, unsigned line) { return s.second < line; });
+        if (f != d_found.end() && f->first <= r->second) {
+            return true;                                              // RETURN
+        }
+    }
 
-    bool areConsecutive(const SourceRange& r1, const SourceRange& r2) const;
-        // Return true iff the specified 'r1' is immediately followed by the
-        // specified 'r2', i.e., 'r2' begins in the same file in which 'r1'
-        // ends, either on the same line or the line after.  Note that there
-        // might be code (not comments) between the ranges, but this check is
-        // good enough for the purpose of considering multi-line "//" comments
-        // as single comment blocks.
+    // Look at the declarations preceding the lines.
+    line = from - 1;
+    r = std::upper_bound(d_runs.begin(), d_runs.end(), line, by_first);
+    if (r != d_runs.begin() && (--r)->second >= line) {
+        Lines::const_iterator f =
+            std::upper_bound(d_found.begin(), d_found.end(), line, by_first);
+        if (f != d_found.begin() && (--f)->second >= r->first) {
+            return true;                                              // RETURN
+        }
+    }
 
+    return false;
+}
+
+struct comments
+    // Namespace for comment utilities.
+{
     static bool isDirective(llvm::StringRef comment);
         // Return wehether the specified 'comment' is a "// = default/delete"
         // comment.
-
-    void operator()(SourceRange range);
-        // The specified 'range', representing a comment, is either appended to
-        // the previous comment or added separately to the comments list.
 };
 
-comments::comments(Analyser& analyser)
-: d_analyser(analyser)
-, d_manager(analyser.manager())
-, d_comments(analyser.attachment<data>().d_comments)
-{
-}
-
 bool comments::isDirective(llvm::StringRef comment)
 {
     // Look for a variety of directives in comments.
@@ -149,27 +174,6 @@ bool comments::isDirective(llvm::StringRef comment)
     return re.match(comment);
 }
 
-bool
-comments::areConsecutive(const SourceRange& r1, const SourceRange& r2) const
-{
-    return csabase::areConsecutive(d_manager, r1, r2) &&
-           !comments::isDirective(d_analyser.get_source(r1)) &&
-           !comments::isDirective(d_analyser.get_source(r2));
-}
-
-void comments::operator()(SourceRange range)
-{
-    Location location(d_analyser.get_location(range.getBegin()));
-    if (d_analyser.is_component(location.file())) {
-        data::Ranges& c = d_comments[location.file()];
-        if (c.size() == 0 || !areConsecutive(c.back(), range)) {
-            c.push_back(range);
-        } else {
-            c.back().setEnd(range.getEnd());
-        }
-    }
-}
-
 struct ParmInfo
 {
     bool is_matched    : 1;
@@ -236,7 +240,7 @@ bool correctly_spelled(llvm::StringRef word)
 
 bool correctly_spelled(llvm::StringRef word)
 {
-    static AspellSpeller *spell_checker = 0;
+    static thread_local AspellSpeller *spell_checker = 0;
     if (!spell_checker) {
         AspellConfig *spell_config = new_aspell_config();
         aspell_config_replace(spell_config, "lang", "en_US");
@@ -417,6 +421,13 @@ struct report
     Analyser& d_analyser;       // Analyser object.
     SourceManager& d_manager;   // SourceManager within Analyser.
     data& d;                    // Analyser's data for this module.
+    CommentIndex& d_index;      // Analyser's comment index.
+    llvm::DenseMap<FileID, data::Ranges> d_comments;
+                                // Comment blocks per file, as needed.
+    llvm::DenseMap<const FunctionDecl *, data::FunDecls::iterator>
+        d_positions;            // Entry of each function in 'd_fundecls'.
+    llvm::DenseMap<const DeclContext *, cognates> d_cognates;
+                                // Declarations per context, as needed.
 
     report(Analyser& analyser);
         // Create a 'report' object, accessing the specified 'analyser'.
@@ -437,12 +448,16 @@ struct report
         //: o Private assignment operator declaration.
         //: o Template method specialization.
 
+    data::Ranges const& commentBlocks(FileID file);
+        // Return the comment blocks of the specified 'file', with directive
+        // comments kept apart, or an empty sequence if 'file' is not part of
+        // the component.
+
     SourceRange getContract(const FunctionDecl *func,
-                            data::Ranges::iterator comments_begin,
-                            data::Ranges::iterator comments_end);
+                            data::Ranges const& comments);
         // Return the 'SourceRange' of the function contract of the specified
-        // 'func' if it is present in the specified range of 'comments_begin'
-        // up to 'comments_end', and return an invalid 'SourceRange' otherwise.
+        // 'func' if it is present in the specified 'comments' of its file, and
+        // return an invalid 'SourceRange' otherwise.
 
     void note_double_tick(SourceLocation *dt, llvm::StringRef tag);
         // If the specified 'dt' is a valid location, issue a note with the
@@ -453,16 +468,17 @@ struct report
         // Issue diagnostics for deficiencies in the specified 'comment' with
         // respect to being a contract for the specified 'func'.
 
-    bool hasCommentedCognate(const FunctionDecl *func, data::FunDecls& decls);
+    bool hasCommentedCognate(const FunctionDecl *func);
         // Return 'true' iff the specified function declaration 'decl' can be
         // satisfied by a function contract appearing on a declaration in the
-        // specified 'decls' container.
+        // 'd_positions' index.
 };
 
 report::report(Analyser& analyser)
 : d_analyser(analyser)
 , d_manager(analyser.manager())
 , d(analyser.attachment<data>())
+, d_index(analyser.comment_index())
 {
 }
 
@@ -471,67 +487,59 @@ void report::operator()()
     processAllFunDecls(d.d_fundecls);
 }
 
-bool report::hasCommentedCognate(const FunctionDecl *func,
-                                 data::FunDecls& decls)
+bool report::hasCommentedCognate(const FunctionDecl *func)
 {
     const DeclContext *parent = func->getLookupParent();
-    std::string name = func->getNameAsString();
-    fmap fm;
-
-    DeclContext::decl_iterator declsb = parent->decls_begin();
-    DeclContext::decl_iterator declse = parent->decls_end();
-    while (declsb != declse) {
-        const Decl *decl = *declsb++;
-        const FunctionDecl* cfunc =
-            llvm::dyn_cast<FunctionDecl>(decl);
-        const FunctionTemplateDecl* ctplt =
-            llvm::dyn_cast<FunctionTemplateDecl>(decl);
-        if (ctplt) {
-            cfunc = ctplt->getTemplatedDecl();
-        }
-        data::FunDecls::iterator itr = decls.begin();
-        while (itr != decls.end() && itr->first != cfunc) {
-            ++itr;
-        }
-        if (itr != decls.end()) {
-            if (itr->second.isValid() && cfunc->getNameAsString() == name) {
-                // Functions in the same scope with the same name are cognates.
-                // (This is, perhaps, simplistic.)
-                return true;                                          // RETURN
+    bool indexed = d_cognates.count(parent);
+    cognates& cg = d_cognates[parent];
+
+    if (!indexed) {
+        DeclContext::decl_iterator declsb = parent->decls_begin();
+        DeclContext::decl_iterator declse = parent->decls_end();
+        while (declsb != declse) {
+            const Decl *decl = *declsb++;
+            const FunctionDecl* cfunc =
+                llvm::dyn_cast<FunctionDecl>(decl);
+            const FunctionTemplateDecl* ctplt =
+                llvm::dyn_cast<FunctionTemplateDecl>(decl);
+            if (ctplt) {
+                cfunc = ctplt->getTemplatedDecl();
             }
-            if (cfunc != func) {
-                fm.insert(d_manager.getPresumedLineNumber(decl->getLocStart()),
-                          d_manager.getPresumedLineNumber(decl->getLocEnd()),
-                          itr);
+            auto itr = d_positions.find(cfunc);
+            if (itr != d_positions.end()) {
+                bool found = itr->second->second.isValid();
+                if (found) {
+                    cg.d_named.insert(cfunc->getNameAsString());
+                }
+                cg.insert(
+                    d_manager.getPresumedLineNumber(decl->getLocStart()),
+                    d_manager.getPresumedLineNumber(decl->getLocEnd()),
+                    found);
             }
         }
+        cg.merge();
     }
 
-    // A consecutive set of function declarations with nothing else intervening
-    // are cognates.
-    unsigned el = d_manager.getPresumedLineNumber(func->getLocEnd());
-    while (fmap::Status status = fm.find_contract(++el)) {
-        if (status == fmap::e_Found) {
-            return true;                                              // RETURN
-        }
+    // Functions in the same scope with the same name are cognates.  (This is,
+    // perhaps, simplistic.)
+    if (cg.d_named.count(func->getNameAsString())) {
+        return true;                                                  // RETURN
     }
 
-    unsigned bl = d_manager.getPresumedLineNumber(func->getLocStart());
-    while (fmap::Status status = fm.find_contract(--bl)) {
-        if (status == fmap::e_Found) {
-            return true;                                              // RETURN
-        }
-    }
-
-    return false;
+    // A consecutive set of function declarations with nothing else intervening
+    // are cognates.
+    return cg.find_contract(
+        d_manager.getPresumedLineNumber(func->getLocStart()),
+        d_manager.getPresumedLineNumber(func->getLocEnd()));
 }
 
 void report::processAllFunDecls(data::FunDecls& decls)
 {
     for (data::FunDecls::iterator it = decls.begin(); it != decls.end(); ++it) {
-        Location location(d_analyser.get_location(it->first->getLocStart()));
-        data::Ranges& c = d.d_comments[location.file()];
-        it->second = getContract(it->first, c.begin(), c.end());
+        FileID fid = d_manager.getFileID(
+            d_manager.getExpansionLoc(it->first->getLocStart()));
+        it->second = getContract(it->first, commentBlocks(fid));
+        d_positions.insert(std::make_pair(it->first, it));
     }
 
     for (data::FunDecls::iterator it = decls.begin(); it != decls.end(); ++it) {
@@ -540,7 +548,7 @@ void report::processAllFunDecls(data::FunDecls& decls)
         else if (it->second.isValid()) {
             critiqueContract(it->first, it->second);
         }
-        else if (!hasCommentedCognate(it->first, decls)) {
+        else if (!hasCommentedCognate(it->first)) {
             d_analyser.report(it->first->getNameInfo().getLoc(),
                               check_name, "FD01",
                               "Function declaration requires contract")
@@ -565,9 +573,23 @@ bool report::doesNotNeedContract(const FunctionDecl *func)
             && func->getNameAsString() == "aSsErT");
 }
 
-SourceRange report::getContract(const FunctionDecl     *func,
-                                data::Ranges::iterator  comments_begin,
-                                data::Ranges::iterator  comments_end)
+data::Ranges const& report::commentBlocks(FileID file)
+{
+    llvm::DenseMap<FileID, data::Ranges>::iterator it = d_comments.find(file);
+    if (it == d_comments.end()) {
+        data::Ranges& c = d_comments[file];
+        if (d_analyser.is_component(d_manager.getLocForStartOfFile(file))) {
+            c = d_index.blocks(file, [this](SourceRange r) {
+                return comments::isDirective(d_analyser.get_source(r));
+            });
+        }
+        return c;                                                     // RETURN
+    }
+    return it->second;
+}
+
+SourceRange report::getContract(const FunctionDecl  *func,
+                                data::Ranges const&  comments)
 {
     SourceRange declarator = func->getSourceRange();
     declarator.setEnd(declarator.getEnd().getLocWithOffset(1));
@@ -586,8 +608,9 @@ SourceRange report::getContract(const FunctionDecl     *func,
         // and a colon between itself and that initializer.
         SourceLocation initloc = (*ctor->init_begin())->getSourceLocation();
         if (initloc.isValid()) {
-            data::Ranges::iterator it;
-            for (it = comments_begin; it != comments_end; ++it) {
+            data::Ranges::const_iterator it =
+                d_index.first_not_before(comments, declarator.getBegin());
+            for (; it != comments.end(); ++it) {
                 if (d_manager.isBeforeInTranslationUnit(
                         initloc, it->getBegin())) {
                     break;
@@ -611,8 +634,10 @@ SourceRange report::getContract(const FunctionDecl     *func,
         // the function declarator and has only whitespace between itself and 
         // the open brace of the function.
         SourceLocation bodyloc = func->getBody()->getLocStart();
-        data::Ranges::iterator it;
-        for (it = comments_begin; it != comments_end; ++it) {
+        data::Ranges::const_iterator it;
+        for (it = d_index.first_not_before(comments, declarator.getBegin());
+             it != comments.end();
+             ++it) {
             if (d_manager.isBeforeInTranslationUnit(bodyloc, it->getBegin())) {
                 break;
             }
@@ -633,8 +658,10 @@ SourceRange report::getContract(const FunctionDecl     *func,
         // Function without body or one-liner - look for a comment following
         // the declaration separated from it by only whitespace and semicolon.
         SourceLocation endloc = declarator.getEnd();
-        data::Ranges::iterator it;
-        for (it = comments_begin; it != comments_end; ++it) {
+        data::Ranges::const_iterator it;
+        for (it = d_index.first_not_before(comments, endloc);
+             it != comments.end();
+             ++it) {
             if (d_manager.isBeforeInTranslationUnit(it->getEnd(), endloc)) {
                 continue;
             }
@@ -888,7 +915,6 @@ void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
     // Hook up the callback functions.
 {
     analyser.onTranslationUnitDone += report(analyser);
-    observer.onComment += comments(analyser);
 }
 
 }  // close anonymous namespace
@@ -77,12 +77,6 @@ struct comments
     }
 };
 
-internal::DynTypedMatcher return_matcher()
-    // Return an AST matcher which looks for return statements.
-{
-    return decl(forEachDescendant(returnStmt().bind("return")));
-}
-
 // Callback object invoked upon completion.
 struct report : Report<data>
 {
@@ -139,12 +133,6 @@ struct report : Report<data>
 
     void operator()()
     {
-        MatchFinder mf;
-        OnMatch<report, &report::match_return> m1(this);
-        mf.addDynamicMatcher(return_matcher(), &m1);
-        mf.match(*d_analyser.context()->getTranslationUnitDecl(),
-                 *d_analyser.context());
-
         process_all_returns(
             d_data.d_all_returns.begin(), d_data.d_all_returns.end());
     }
@@ -273,6 +261,12 @@ struct report : Report<data>
 
 void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
 {
+    analyser.add_matcher(check_name,
+                         returnStmt().bind("return"),
+                         [&analyser](const BoundNodes &nodes) {
+                             report(analyser).match_return(nodes);
+                         });
+    analyser.index_parents();
     analyser.onTranslationUnitDone += report(analyser);
     observer.onComment += comments(analyser);
     observer.onPPMacroExpands += report(analyser);
@@ -35,6 +35,7 @@
 #include <stddef.h>
 #include <utils/event.hpp>
 #include <utils/function.hpp>
+#include <algorithm>
 #include <cctype>
 #include <limits>
 #include <map>
@@ -135,6 +136,16 @@ struct data
     std::map<std::string, unsigned> d_names_in_plan;   // method namess tested
 };
 
+struct case_matches
+    // The matches found within one case of the main switch statement.
+{
+    typedef std::vector<BoundNodes> Matches;
+    Matches d_noisy;   // 'noisy_print_matcher' matches
+    Matches d_quiet;   // 'no_print_matcher' matches
+    Matches d_print;   // 'print_matcher' matches
+    Matches d_status;  // 'set_status_matcher' matches
+};
+
 data::data()
 : d_main(0)
 , d_return(0)
@@ -278,7 +289,9 @@ llvm::Regex tested_method(
     ")" "[[:space:]]*[(]",
     llvm::Regex::Newline);  // Match a method name in a test item.
 
-internal::DynTypedMatcher print_matcher()
+StatementMatcher print_matcher()
+    // Return an AST matcher which looks for verbose printing of the banner in
+    // a test case statement.
 {
     return caseStmt(has(compoundStmt(has(ifStmt(
         hasCondition(
@@ -303,10 +316,11 @@ internal::DynTypedMatcher print_matcher()
             cxxOperatorCallExpr(
                 hasOverloadedOperatorName("<<"),
                 hasArgument(1, ignoringImpCasts(
-                                   characterLiteral().bind("cc"))))))))))));
+                                   characterLiteral().bind("cc")))))))))))
+        .bind("case");
 }
 
-internal::DynTypedMatcher noisy_print_matcher()
+StatementMatcher noisy_print_matcher()
     // Return an AST matcher which looks for (not very) verbose output inside
     // loops in a test case statement.
 {
@@ -319,10 +333,11 @@ internal::DynTypedMatcher noisy_print_matcher()
                                hasCondition(integerLiteral(equals(0))),
                                hasCondition(cxxNullPtrLiteralExpr()))))),
                      hasAncestor(forStmt()),
-                     hasAncestor(whileStmt()))).bind("noisy")))));
+                     hasAncestor(whileStmt()))).bind("noisy")))))
+        .bind("case");
 }
 
-internal::DynTypedMatcher no_print_matcher()
+StatementMatcher no_print_matcher()
     // Return an AST matcher which looks for missing verbose output inside
     // loops in a test statement.
 {
@@ -344,7 +359,8 @@ internal::DynTypedMatcher no_print_matcher()
                                        hasName("veryVerbose"),
                                        hasName("veryVeryVerbose"),
                                        hasName("veryVeryVeryVerbose")))))))))))
-                .bind("loop")))));
+                .bind("loop")))))
+        .bind("case");
 }
 
 internal::DynTypedMatcher return_status_matcher()
@@ -360,7 +376,7 @@ void report::match_return_status(const BoundNodes& nodes)
     d.d_return = nodes.getNodeAs<Stmt>("good");
 }
 
-internal::DynTypedMatcher set_status_matcher()
+StatementMatcher set_status_matcher()
     // Return an AST matcher which looks for 'testStatus = -1;'.
 {
     return defaultStmt(anyOf(
@@ -378,7 +394,15 @@ internal::DynTypedMatcher set_status_matcher()
                         hasRHS(unaryOperator(hasOperatorName("-"),
                                              hasUnaryOperand(integerLiteral(
                                                  equals(1)))))))).bind("good"),
-        defaultStmt().bind("bad")));
+        defaultStmt().bind("bad")))
+        .bind("case");
+}
+
+internal::DynTypedMatcher cases_matcher(StatementMatcher matcher)
+    // Return an AST matcher which applies the specified case 'matcher' to
+    // every case below the statement it is given.
+{
+    return stmt(forEachDescendant(matcher));
 }
 
 void report::match_set_status(const BoundNodes& nodes)
@@ -655,8 +679,34 @@ void report::operator()()
         return;                                                       // RETURN
     }
 
+    // Match all the cases in one traversal of the switch statement, keeping
+    // the matches of each case to act upon, in their original order, when
+    // that case is examined.  Cases of nested switch statements also match,
+    // but are never examined.
+    std::map<const SwitchCase *, case_matches> matches_of_cases;
+    auto collect = [&](case_matches::Matches case_matches::*kind) {
+        return [&, kind](const BoundNodes &nodes) {
+            (matches_of_cases[nodes.getNodeAs<SwitchCase>("case")].*kind)
+                .push_back(nodes);
+        };
+    };
+    {
+        MatchFinder mf;
+        OnMatch<> m1(collect(&case_matches::d_status));
+        mf.addDynamicMatcher(cases_matcher(set_status_matcher()), &m1);
+        OnMatch<> m2(collect(&case_matches::d_noisy));
+        mf.addDynamicMatcher(cases_matcher(noisy_print_matcher()), &m2);
+        OnMatch<> m3(collect(&case_matches::d_quiet));
+        mf.addDynamicMatcher(cases_matcher(no_print_matcher()), &m3);
+        OnMatch<> m4(collect(&case_matches::d_print));
+        mf.addDynamicMatcher(cases_matcher(print_matcher()), &m4);
+        mf.match(*ss, *a.context());
+    }
+
     const SwitchCase* sc;
     for (sc = ss->getSwitchCaseList(); sc; sc = sc->getNextSwitchCase()) {
+        const case_matches& cm = matches_of_cases[sc];
+
         size_t line = Location(m, sc->getColonLoc()).line() + 1;
 
         // Skip over preprocessor conditionals.
@@ -673,10 +723,9 @@ void report::operator()()
         const CaseStmt* cs = llvm::dyn_cast<CaseStmt>(sc);
         if (!cs) {
             // Default case.
-            MatchFinder mf;
-            OnMatch<report, &report::match_set_status> m1(this);
-            mf.addDynamicMatcher(set_status_matcher(), &m1);
-            mf.match(*sc, *a.context());
+            for (const auto& nodes : cm.d_status) {
+                match_set_status(nodes);
+            }
             continue;
         }
 
@@ -685,14 +734,15 @@ void report::operator()()
         bool negative = 0 >  case_value.getSExtValue();
         bool zero     = 0 == case_value.getSExtValue();
 
-        MatchFinder mf;
-        OnMatch<report, &report::match_noisy_print> m2(this);
-        mf.addDynamicMatcher(noisy_print_matcher(), &m2);
-        OnMatch<report, &report::match_no_print> m3(this);
-        mf.addDynamicMatcher(no_print_matcher(), &m3);
+        for (const auto& nodes : cm.d_noisy) {
+            match_noisy_print(nodes);
+        }
+        for (const auto& nodes : cm.d_quiet) {
+            match_no_print(nodes);
+        }
         std::string banner;
         SourceLocation bl;
-        OnMatch<> m4([&](const BoundNodes &nodes) {
+        for (const auto& nodes : cm.d_print) {
             if (auto sl = nodes.getNodeAs<DeclRefExpr>("ce")) {
                 banner = "\n" + banner;
                 bl = sl->getExprLoc();
@@ -713,10 +763,7 @@ void report::operator()()
                 banner = char(sl->getValue()) + banner;
                 bl = sl->getExprLoc();
             }
-        });
-        mf.addDynamicMatcher(print_matcher(), &m4);
-
-        mf.match(*cs, *a.context());
+        }
 
         if (!zero) {
             check_banner(bl, banner);
@@ -1221,6 +1268,47 @@ static llvm::StringRef squash(std::string &out, llvm::StringRef in)
     return out;
 }
 
+static size_t bounded_edit_distance(llvm::StringRef a,
+                                    llvm::StringRef b,
+                                    size_t          bound)
+    // Return the edit distance between the specified 'a' and 'b' if it is no
+    // more than the specified 'bound', and 'bound + 1' otherwise.  Only the
+    // diagonal band of width '2 * bound + 1' is computed, and the computation
+    // stops as soon as a whole row exceeds 'bound'.
+{
+    size_t n = a.size();
+    size_t m = b.size();
+    bound = std::min(bound, std::max(n, m));
+    size_t inf = bound + 1;
+    if ((n > m ? n - m : m - n) > bound) {
+        return inf;                                                   // RETURN
+    }
+
+    std::vector<size_t> prev(m + 2, inf);
+    std::vector<size_t> cur(m + 2, inf);
+    for (size_t j = 0; j <= m && j <= bound; ++j) {
+        prev[j] = j;
+    }
+    for (size_t i = 1; i <= n; ++i) {
+        size_t lo = i > bound ? i - bound : 1;
+        size_t hi = std::min(m, i + bound);
+        size_t row_min = inf;
+        cur[lo - 1] = lo == 1 && i <= bound ? i : inf;
+        for (size_t j = lo; j <= hi; ++j) {
+            size_t d = std::min(prev[j - 1] + (a[i - 1] != b[j - 1]),
+                                std::min(prev[j], cur[j - 1]) + 1);
+            cur[j] = std::min(d, inf);
+            row_min = std::min(row_min, cur[j]);
+        }
+        cur[hi + 1] = inf;
+        if (row_min > bound && (lo > 1 || cur[0] > bound)) {
+            return inf;                                               // RETURN
+        }
+        std::swap(prev, cur);
+    }
+    return prev[m];
+}
+
 std::string report::addCR(llvm::StringRef s)
 {
     std::string r;
@@ -1288,34 +1376,60 @@ void report::search(SourceLocation *best_loc,
 
     *best_distance = ~size_t(0);
 
+    // Squash each needle once.
+    std::vector<std::string> squashed_needles(ns);
+    for (size_t n = 0; n < ns; ++n) {
+        squash(squashed_needles[n], needles[n]);
+    }
+
+    // Find line starts in the line index of the file, unless the file has
+    // carriage returns that the source manager counts as line ends.
+    const LineIndex& li = a.line_index(fid);
+    auto line_offset = [&](size_t line) -> size_t {
+        if (li.has_lone_cr()) {
+            return m.getFileOffset(m.translateLineCol(fid, line, 1));
+                                                                      // RETURN
+        }
+        if (line - 1 < li.lines()) {
+            return li.line_start(line - 1);                           // RETURN
+        }
+        return haystack.empty() ? 0 : haystack.size() - 1;
+    };
+
     // For each line to be examined...
     std::set<size_t>::const_iterator bl = lines.begin();
     std::set<size_t>::const_iterator el = lines.end();
-    std::string squashed_needle;
-    std::string squashed_haystack;
+    std::map<size_t, std::string> squashed_haystacks;
     for (std::set<size_t>::const_iterator il = bl; il != el; ++il) {
         size_t line = *il;
-        SourceLocation begin = m.translateLineCol(fid, line, 1);
+        size_t begin = line_offset(line);
+        squashed_haystacks.clear();
         // For each needle...
         for (size_t n = 0; n < ns; ++n) {
             llvm::StringRef needle = needles[n];
-            squash(squashed_needle, needle);
             size_t nl = needle_lines[n];
             size_t nbl = needle_blank_lines[n];
             // Examine successively smaller ranges of lines from the starting
             // line, beginning with the number of lines in the needle down to
             // that number less the number of blank lines in the needle.
             for (size_t nn = nl; nn >= nl - nbl; --nn) {
-                SourceLocation end = m.translateLineCol(fid, line + nn, 1);
-                SourceRange r(begin, end);
-                llvm::StringRef s = a.get_source(r, true);
-                size_t distance = squash(squashed_haystack, s)
-                                      .edit_distance(squashed_needle);
+                size_t end = line_offset(line + nn);
+                llvm::StringRef s = begin <= end ? haystack.slice(begin, end)
+                                                 : llvm::StringRef();
+                auto sh = squashed_haystacks.find(nn);
+                if (sh == squashed_haystacks.end()) {
+                    sh = squashed_haystacks.insert(
+                        std::make_pair(nn, std::string())).first;
+                    squash(sh->second, s);
+                }
+                // Only a distance better than the best so far is of interest.
+                size_t distance = bounded_edit_distance(
+                    sh->second, squashed_needles[n], *best_distance - 1);
                 // Record a better match whenever one is found.
                 if (distance < *best_distance) {
                     *best_distance = distance;
                     std::pair<size_t, size_t> mm = mid_mismatch(s, needle);
-                    *best_loc = r.getBegin().getLocWithOffset(mm.first);
+                    *best_loc = top.getLocWithOffset(begin + mm.first);
                     *best_needle = needle;
                     // Return on an exact match.
                     if (distance == 0 || mm.first == s.size()) {
@@ -1375,6 +1489,7 @@ void report::check_boilerplate()
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
     // Hook up the callback functions.
 {
+    analyser.index_parents();
     analyser.onTranslationUnitDone += report(analyser);
     visitor.onFunctionDecl += report(analyser);
     visitor.onExpr += report(analyser);
@@ -332,18 +332,26 @@ void files::operator()(const FunctionDecl *func)
 }
 
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
-    // Hook up the callback functions.
+    // Hook up the callback functions that need only the comments.
 {
     analyser.onTranslationUnitDone += files(analyser);
-    visitor.onFunctionDecl         += files(analyser);
     observer.onComment             += files(analyser);
 }
 
+void subscribe_definitions(Analyser&   analyser,
+                           Visitor&    visitor,
+                           PPObserver& observer)
+    // Hook up the callback function that finds inline definitions.
+{
+    visitor.onFunctionDecl += files(analyser);
+}
+
 }  // close anonymous namespace
 
 // ----------------------------------------------------------------------------
 
-static RegisterCheck c1(check_name, &subscribe);
+static RegisterCheck c1(check_name, &subscribe, CheckRegistry::e_Preprocessor);
+static RegisterCheck c2(check_name, &subscribe_definitions);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
@@ -4,6 +4,7 @@
 #include <clang/Basic/SourceLocation.h>
 #include <clang/Basic/SourceManager.h>
 #include <csabase_analyser.h>
+#include <csabase_commentindex.h>
 #include <csabase_config.h>
 #include <csabase_diagnostic_builder.h>
 #include <csabase_location.h>
@@ -40,29 +41,12 @@ namespace
 {
 
 struct comments
-    // Data holding seen comments.
+    // Data holding reported comments.
 {
-    typedef std::vector<SourceRange> Ranges;
-    typedef std::map<std::string, Ranges> Comments;
-    Comments d_comments;
-
     typedef std::set<Range> Reported;
     Reported d_reported;
-
-    void append(Analyser& analyser, SourceRange range);
 };
 
-void comments::append(Analyser& analyser, SourceRange range)
-{
-    SourceManager& m = analyser.manager();
-    comments::Ranges& c = d_comments[m.getFilename(range.getBegin())];
-    if (c.size() != 0 && areConsecutive(m, c.back(), range)) {
-        c.back().setEnd(range.getEnd());
-    } else {
-        c.push_back(range);
-    }
-}
-
 struct files
     // Callback object for inspecting files.
 {
@@ -71,9 +55,6 @@ struct files
     files(Analyser& analyser);
         // Create a 'files' object, accessing the specified 'analyser'.
 
-    void operator()(SourceRange range);
-        // The specified comment 'range' is added to the stored data.
-
     void operator()();
         // Inspect all comments.
 
@@ -108,27 +89,26 @@ files::files(Analyser& analyser)
 {
 }
 
-void files::operator()(SourceRange range)
-{
-    d_analyser.attachment<comments>().append(d_analyser, range);
-}
-
 void files::operator()()
 {
-    comments::Comments& file_comments =
-        d_analyser.attachment<comments>().d_comments;
-
-    for (comments::Comments::iterator file_begin = file_comments.begin(),
-                                      file_end   = file_comments.end(),
-                                      file_itr   = file_begin;
-         file_itr != file_end;
-         ++file_itr) {
-        const std::string &file_name = file_itr->first;
+    CommentIndex&  index = d_analyser.comment_index();
+    SourceManager& m     = d_analyser.manager();
+
+    // Visit the files in name order.
+    std::multimap<std::string, FileID> file_comments;
+    for (FileID fid : index.files()) {
+        file_comments.insert(
+            std::make_pair(m.getFilename(m.getLocForStartOfFile(fid)), fid));
+    }
+
+    for (const auto& file : file_comments) {
+        const std::string &file_name = file.first;
         if (!d_analyser.is_component(file_name)) {
             continue;
         }
-        comments::Ranges& comments = file_itr->second;
-        for (comments::Ranges::iterator comments_begin = comments.begin(),
+        const CommentIndex::Ranges& comments = index.blocks(file.second);
+        for (CommentIndex::Ranges::const_iterator
+                                        comments_begin = comments.begin(),
                                         comments_end   = comments.end(),
                                         comments_itr   = comments_begin;
              comments_itr != comments_end;
@@ -595,8 +575,8 @@ void files::check_description(SourceRange range)
 void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
     // Hook up the callback functions.
 {
+    analyser.comment_index();
     analyser.onTranslationUnitDone += files(analyser);
-    observer.onComment             += files(analyser);
 }
 
 }  // close anonymous namespace
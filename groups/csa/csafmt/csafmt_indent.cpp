@@ -755,8 +755,6 @@ int report::process(Location l, bool greater, int lastdiff)
 
 void report::operator()()
 {
-    TraverseDecl(a.context()->getTranslationUnitDecl());
-
     // Process remnant declarators.
     add_consecutive(0, SourceRange());
 
@@ -769,6 +767,10 @@ void report::operator()()
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
     // Hook up the callback functions.
 {
+    analyser.add_pass(check_name,
+                      report(analyser),
+                      CheckRegistry::e_Diagnosable);
+    analyser.index_parents();
     analyser.onTranslationUnitDone += report(analyser);
     observer.onMacroExpands += report(analyser);
     observer.onComment += report(analyser);
@@ -4,11 +4,11 @@
 #include <clang/Basic/SourceManager.h>
 #include <csabase_analyser.h>
 #include <csabase_debug.h>
+#include <csabase_lineindex.h>
 #include <csabase_ppobserver.h>
 #include <csabase_registercheck.h>
 #include <csabase_report.h>
-#include <llvm/ADT/StringRef.h>
-#include <stddef.h>
+#include <csabase_textcache.h>
 #include <utils/event.hpp>
 #include <utils/function.hpp>
 #include <set>
@@ -60,25 +60,22 @@ void report::operator()()
     d.d_files.insert(m.getMainFileID());
 
     for (auto fid : d.d_files) {
-        SourceLocation loc = m.getLocForStartOfFile(fid);
-        llvm::StringRef b  = m.getBufferData(fid);
-
-        size_t prev = ~size_t(0);
-        size_t next;
-        size_t cr;
-        do {
-            if ((cr = next = b.find('\n', prev + 1)) == b.npos) {
-                cr = next = b.size();
+        TextCache cache(d_analyser, check_name, fid);
+        if (cache.replayed()) {
+            continue;
+        }
+
+        SourceLocation   loc   = m.getLocForStartOfFile(fid);
+        LineIndex const& index = d_analyser.line_index(fid);
+
+        for (unsigned line = 0; line < index.lines(); ++line) {
+            if (index.line_length(line) > 79) {
+                d_analyser.report(
+                    loc.getLocWithOffset(index.line_start(line) + 79),
+                    check_name, "LL01",
+                    "Line exceeds 79 characters in length");
             }
-            else if (b.find('\r', prev + 1) == cr - 1) {
-                --cr;
-            }
-            if (cr - prev > 80) {
-                d_analyser.report(loc.getLocWithOffset(prev + 80), check_name,
-                                  "LL01",
-                                  "Line exceeds 79 characters in length");
-            }
-        } while ((prev = next) < b.size());
+        }
     }
 }
 
@@ -93,7 +90,7 @@ void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
 
 // ----------------------------------------------------------------------------
 
-static RegisterCheck c1(check_name, &subscribe);
+static RegisterCheck c1(check_name, &subscribe, CheckRegistry::e_Preprocessor);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
@@ -4,10 +4,11 @@
 #include <clang/Basic/SourceManager.h>
 #include <csabase_analyser.h>
 #include <csabase_diagnostic_builder.h>
+#include <csabase_lineindex.h>
 #include <csabase_ppobserver.h>
 #include <csabase_registercheck.h>
+#include <csabase_textcache.h>
 #include <csabase_util.h>
-#include <llvm/Support/MemoryBuffer.h>
 #include <utils/event.hpp>
 #include <utils/function.hpp>
 #include <string>
@@ -50,25 +51,17 @@ void files::operator()(SourceLocation     loc,
                        std::string const &file)
 {
     const SourceManager &m = d_analyser.manager();
-    const llvm::MemoryBuffer *buf = m.getBuffer(m.getFileID(loc));
-    const char *b = buf->getBufferStart();
-    const char *e = buf->getBufferEnd();
-
-    const char *begin = 0;
-    for (const char *s = b; s <= e; ++s) {
-        if (!(*s & 0x80)) {
-            if (begin != 0) {
-                SourceRange bad(getOffsetRange(loc, begin - b, s - begin - 1));
-                d_analyser.report(bad.getBegin(), check_name, "NA01",
-                                  "Non-ASCII characters")
-                    << bad;
-                begin = 0;
-            }
-        } else {
-            if (begin == 0) {
-                begin = s;
-            }
-        }
+    FileID fid = m.getFileID(loc);
+    TextCache cache(d_analyser, check_name, fid);
+    if (cache.replayed()) {
+        return;                                                       // RETURN
+    }
+
+    for (const auto& run : d_analyser.line_index(fid).non_ascii()) {
+        SourceRange bad(getOffsetRange(loc, run.d_offset, run.d_length - 1));
+        d_analyser.report(bad.getBegin(), check_name, "NA01",
+                          "Non-ASCII characters")
+            << bad;
     }
 }
 
@@ -82,7 +75,7 @@ void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
 
 // ----------------------------------------------------------------------------
 
-static RegisterCheck c1(check_name, &subscribe);
+static RegisterCheck c1(check_name, &subscribe, CheckRegistry::e_Preprocessor);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
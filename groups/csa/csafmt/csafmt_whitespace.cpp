@@ -4,17 +4,15 @@
 #include <clang/Basic/SourceManager.h>
 #include <csabase_analyser.h>
 #include <csabase_diagnostic_builder.h>
+#include <csabase_lineindex.h>
 #include <csabase_ppobserver.h>
 #include <csabase_registercheck.h>
-#include <csabase_util.h>
-#include <llvm/ADT/SmallVector.h>
-#include <llvm/ADT/StringRef.h>
-#include <llvm/Support/Regex.h>
+#include <csabase_textcache.h>
 #include <stddef.h>
 #include <utils/event.hpp>
 #include <utils/function.hpp>
 #include <string>
-#include <utility>
+#include <vector>
 
 namespace csabase { class Visitor; }
 
@@ -50,33 +48,34 @@ files::files(Analyser& analyser)
 {
 }
 
-llvm::Regex bad_ws("\t+| +\r*\n", llvm::Regex::NoFlags);
-
 void files::operator()(SourceLocation loc,
                        std::string const &,
                        std::string const &)
 {
+    if (!d_analyser.is_component(loc)) {
+        return;                                                       // RETURN
+    }
+
     const SourceManager &m = d_analyser.manager();
-    llvm::StringRef buf = m.getBufferData(m.getFileID(loc));
-    if (d_analyser.is_component(loc) &&
-        (buf.find('\t') != buf.npos ||
-         buf.find(" \n") != buf.npos ||
-         buf.find(" \r\n") != buf.npos)) {
-        loc = m.getLocForStartOfFile(m.getFileID(loc));
-        size_t offset = 0;
-        llvm::StringRef s;
-        llvm::SmallVector<llvm::StringRef, 7> matches;
-        while (bad_ws.match(s = buf.drop_front(offset), &matches)) {
-            llvm::StringRef text = matches[0];
-            size_t n = text.size();
-            if (text.endswith("\r\n")) {
-                --n;
-            }
-            std::pair<size_t, size_t> m = mid_match(s, text);
-            size_t matchpos = offset + m.first;
-            offset = matchpos + n;
-            SourceLocation sloc = loc.getLocWithOffset(matchpos);
-            if (text[0] == '\t') {
+    FileID fid = m.getFileID(loc);
+    LineIndex const& index = d_analyser.line_index(fid);
+    const std::vector<LineIndex::Run>& tabs = index.tabs();
+    const std::vector<LineIndex::Run>& spaces = index.trailing_spaces();
+    if (!tabs.empty() || !spaces.empty()) {
+        TextCache cache(d_analyser, check_name, fid);
+        if (cache.replayed()) {
+            return;                                                   // RETURN
+        }
+
+        // Report the tab and trailing space runs in file order.
+        loc = m.getLocForStartOfFile(fid);
+        size_t t = 0;
+        size_t s = 0;
+        while (t < tabs.size() || s < spaces.size()) {
+            if (s == spaces.size() ||
+                (t < tabs.size() && tabs[t].d_offset < spaces[s].d_offset)) {
+                unsigned n = tabs[t].d_length;
+                SourceLocation sloc = loc.getLocWithOffset(tabs[t++].d_offset);
                 d_analyser.report(sloc, check_name, "TAB01",
                         "Tab character%s0 in source")
                     << static_cast<long>(n);
@@ -84,11 +83,13 @@ void files::operator()(SourceLocation loc,
                     sloc, n, std::string(n, ' '));
             }
             else {
-                d_analyser.report(loc.getLocWithOffset(matchpos),
-                        check_name, "ESP01",
+                unsigned n = spaces[s].d_length;
+                SourceLocation sloc =
+                    loc.getLocWithOffset(spaces[s++].d_offset);
+                d_analyser.report(sloc, check_name, "ESP01",
                         "Space%s0 at end of line")
-                    << static_cast<long>(n - 1);
-                d_analyser.RemoveText(sloc, n - 1);
+                    << static_cast<long>(n);
+                d_analyser.RemoveText(sloc, n);
             }
         }
     }
@@ -104,7 +105,7 @@ void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
 
 // ----------------------------------------------------------------------------
 
-static RegisterCheck c1(check_name, &subscribe);
+static RegisterCheck c1(check_name, &subscribe, CheckRegistry::e_Preprocessor);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
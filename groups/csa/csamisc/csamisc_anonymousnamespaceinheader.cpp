@@ -23,7 +23,9 @@ static void anonymous_namespace_in_header(Analyser& analyser,
 
 // -----------------------------------------------------------------------------
 
-static RegisterCheck check(check_name, &anonymous_namespace_in_header);
+static RegisterCheck check(check_name,
+                           &anonymous_namespace_in_header,
+                           CheckRegistry::e_Diagnosable);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
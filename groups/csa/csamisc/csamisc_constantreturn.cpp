@@ -72,7 +72,9 @@ static void check(Analyser& analyser, FunctionDecl const* decl)
 
 // -----------------------------------------------------------------------------
 
-static RegisterCheck register_check(check_name, &check);
+static RegisterCheck register_check(check_name,
+                                    &check,
+                                    CheckRegistry::e_Diagnosable);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
@@ -29,35 +29,35 @@ struct report : Report<data>
 {
     INHERIT_REPORT_CTOR(report, Report, data);
 
-    void operator()();
+    void match_endl(const BoundNodes &nodes);
 };
 
-void report::operator()()
+void report::match_endl(const BoundNodes &nodes)
 {
     if (a.is_test_driver()) {
         return;                                                       // RETURN
     }
 
-    MatchFinder mf;
-    OnMatch<> m1([&](const BoundNodes &nodes) {
-        const auto *c = nodes.getNodeAs<CXXOperatorCallExpr>("c");
-        a.report(c->getOperatorLoc(), check_name, "NE01",
-                 "Prefer ... << '\\n', and ... << flush if needed");
-    });
-    mf.addDynamicMatcher(
-        decl(forEachDescendant(cxxOperatorCallExpr(
-            hasOverloadedOperatorName("<<"),
-            hasAnyArgument(ignoringImpCasts(declRefExpr(
-                to(namedDecl(hasName("std::endl")))
-            )))
-        ).bind("c"))), &m1);
-    mf.match(*a.context()->getTranslationUnitDecl(), *a.context());
+    const auto *c = nodes.getNodeAs<CXXOperatorCallExpr>("c");
+    a.report(c->getOperatorLoc(), check_name, "NE01",
+             "Prefer ... << '\\n', and ... << flush if needed");
 }
 
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
     // Hook up the callback functions.
 {
-    analyser.onTranslationUnitDone += report(analyser);
+    analyser.add_matcher(
+        check_name,
+        cxxOperatorCallExpr(
+            hasOverloadedOperatorName("<<"),
+            hasAnyArgument(ignoringImpCasts(declRefExpr(
+                to(namedDecl(hasName("std::endl")))
+            )))
+        ).bind("c"),
+        [&analyser](const BoundNodes &nodes) {
+            report(analyser).match_endl(nodes);
+        },
+        Analyser::e_Instantiations);
 }
 
 }  // close anonymous namespace
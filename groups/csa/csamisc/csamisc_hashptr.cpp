@@ -43,9 +43,6 @@ struct report
     report(Analyser& analyser);
         // Initialize an object of this type.
 
-    void operator()();
-        // Callback for the end of the translation unit.
-
     void match_hash_char_ptr(const BoundNodes &nodes);
         // Callback when matching calls are found.
 };
@@ -58,19 +55,18 @@ report::report(Analyser& analyser)
 internal::DynTypedMatcher hash_char_ptr_matcher()
     // Return an AST matcher which looks for calls to std::hash<Type *>.
 {
-    return decl(forEachDescendant(
-        callExpr(
-            callee(functionDecl(
-                hasName("operator()"),
-                parameterCountIs(1),
-                hasParent(recordDecl(hasName("std::hash"))),
-                hasParameter(
-                    0, hasType(pointerType(unless(anyOf(
-                           pointee(asString("void")),
-                           pointee(asString("const void")),
-                           pointee(asString("volatile void")),
-                           pointee(asString("const volatile void"))))))))))
-            .bind("hash")));
+    return callExpr(
+               callee(functionDecl(
+                   hasName("operator()"),
+                   parameterCountIs(1),
+                   hasParent(recordDecl(hasName("std::hash"))),
+                   hasParameter(
+                       0, hasType(pointerType(unless(anyOf(
+                              pointee(asString("void")),
+                              pointee(asString("const void")),
+                              pointee(asString("volatile void")),
+                              pointee(asString("const volatile void"))))))))))
+        .bind("hash");
 }
 
 void report::match_hash_char_ptr(const BoundNodes &nodes)
@@ -82,19 +78,15 @@ void report::match_hash_char_ptr(const BoundNodes &nodes)
                       "contents, of the argument");
 }
 
-void report::operator()()
-{
-    MatchFinder mf;
-    OnMatch<report, &report::match_hash_char_ptr> m1(this);
-    mf.addDynamicMatcher(hash_char_ptr_matcher(), &m1);
-    mf.match(*d_analyser.context()->getTranslationUnitDecl(),
-             *d_analyser.context());
-}
-
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
     // Hook up the callback functions.
 {
-    analyser.onTranslationUnitDone += report(analyser);
+    analyser.add_matcher(check_name,
+                         hash_char_ptr_matcher(),
+                         [&analyser](const BoundNodes &nodes) {
+                             report(analyser).match_hash_char_ptr(nodes);
+                         },
+                         Analyser::e_Instantiations);
 }
 
 }  // close anonymous namespace
@@ -45,17 +45,21 @@ namespace
 
 struct data
 {
-    std::string d_mr;
+    std::string d_mr;     // Qualified name of 'MovableRef'
+    bool        d_found;  // Whether 'd_mr' names a declaration
+
+    data();
 };
 
+data::data() : d_found(false)
+{
+}
+
 struct report : Report<data>
     // Callback object for detecting references to MovableRef.
 {
     INHERIT_REPORT_CTOR(report, Report, data);
 
-    void operator()();
-        // Callback for the end of the translation unit.
-
     void match_ref_to_movableref(const BoundNodes &nodes);
         // Callback when references to MovableRef are found.
 };
@@ -64,16 +68,23 @@ internal::DynTypedMatcher ref_to_movableref_matcher()
     // Return an AST matcher which looks for function parameters that are
     // references to MovableRef.
 {
-    return decl(forEachDescendant(functionDecl(
+    return functionDecl(
         unless(isTemplateInstantiation()),
         forEachDescendant(parmVarDecl(hasType(referenceType(pointee(
             type(anything()).bind("pt")
         )))).bind("mrr"))
-    )));
+    );
 }
 
 void report::match_ref_to_movableref(const BoundNodes &nodes)
 {
+    if (d.d_mr.empty()) {
+        d.d_mr = a.config()->toplevel_namespace() + "::bslmf::MovableRef";
+        d.d_found = a.lookup_name(d.d_mr);
+    }
+    if (!d.d_found) {
+        return;                                                       // RETURN
+    }
     auto parm = nodes.getNodeAs<ParmVarDecl>("mrr");
     if (!a.is_component(parm)) {
         return;
@@ -95,21 +106,14 @@ void report::match_ref_to_movableref(const BoundNodes &nodes)
     }
 }
 
-void report::operator()()
-{
-    d.d_mr = a.config()->toplevel_namespace() + "::bslmf::MovableRef";
-    if (a.lookup_name(d.d_mr)) {
-        MatchFinder mf;
-        OnMatch<report, &report::match_ref_to_movableref> m1(this);
-        mf.addDynamicMatcher(ref_to_movableref_matcher(), &m1);
-        mf.match(*a.context()->getTranslationUnitDecl(), *a.context());
-    }
-}
-
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
     // Hook up the callback functions.
 {
-    analyser.onTranslationUnitDone += report(analyser);
+    analyser.add_matcher(check_name,
+                         ref_to_movableref_matcher(),
+                         [&analyser](const BoundNodes &nodes) {
+                             report(analyser).match_ref_to_movableref(nodes);
+                         });
 }
 
 }  // close anonymous namespace
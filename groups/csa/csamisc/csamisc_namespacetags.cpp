@@ -45,7 +45,9 @@ static void namespace_tags(Analyser& analyser, NamespaceDecl const *decl)
 
 // -----------------------------------------------------------------------------
 
-static RegisterCheck check(check_name, &namespace_tags);
+static RegisterCheck check(check_name,
+                           &namespace_tags,
+                           CheckRegistry::e_Diagnosable);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
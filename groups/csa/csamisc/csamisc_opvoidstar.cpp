@@ -46,7 +46,9 @@ void conversions(Analyser& analyser, const CXXConversionDecl* conv)
 
 // ----------------------------------------------------------------------------
 
-static RegisterCheck c1(check_name, &conversions);
+static RegisterCheck c1(check_name,
+                        &conversions,
+                        CheckRegistry::e_Diagnosable);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
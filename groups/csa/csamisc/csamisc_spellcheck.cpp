@@ -9,6 +9,7 @@
 #include <clang/Basic/SourceLocation.h>
 #include <clang/Basic/SourceManager.h>
 #include <csabase_analyser.h>
+#include <csabase_commentindex.h>
 #include <csabase_config.h>
 #include <csabase_debug.h>
 #include <csabase_diagnostic_builder.h>
@@ -53,37 +54,20 @@ namespace
 {
 
 struct data
-    // Data holding seen comments.
+    // Data holding seen parameters.
 {
-    typedef std::vector<SourceRange> Ranges;
-    typedef std::map<std::string, Ranges> Comments;
-    Comments d_comments;
+    typedef std::vector<const ParmVarDecl*> Parms;
+    Parms d_parms;
 
     typedef std::map<std::string, std::set<Location>> BadParms;
     BadParms d_bad_parms;
-
-    void append(Analyser& analyser, SourceRange range);
 };
 
-void data::append(Analyser& analyser, SourceRange range)
-{
-    SourceManager& m = analyser.manager();
-    data::Ranges& c = d_comments[m.getFilename(range.getBegin())];
-    if (c.size() != 0 && areConsecutive(m, c.back(), range)) {
-        c.back().setEnd(range.getEnd());
-    } else {
-        c.push_back(range);
-    }
-}
-
 struct report : Report<data>
     // Callback object for inspecting files.
 {
     INHERIT_REPORT_CTOR(report, Report, data);
 
-    void operator()(SourceRange range);
-        // The specified comment 'range' is added to the stored data.
-
     void operator()();
         // Inspect all comments.
 
@@ -98,8 +82,12 @@ struct report : Report<data>
     void check_parameters();
         // Check that function parameters consist of real words.
 
+    void check_parameter(const ParmVarDecl *parm);
+        // Check that the specified 'parm' consists of real words.
+
     void match_parameter(const BoundNodes &nodes);
-        // Callback for named function parameters.
+        // Callback for named function parameters, saved for checking once
+        // the spell checker is available.
 
     typedef std::map<std::string, std::vector<SourceRange> > Errors;
     Errors d_errors;
@@ -107,11 +95,6 @@ struct report : Report<data>
     AspellSpeller *spell_checker;
 };
 
-void report::operator()(SourceRange range)
-{
-    d.append(a, range);
-}
-
 void report::operator()()
 {
     static const char default_dictionary[] =
@@ -203,9 +186,16 @@ void report::operator()()
             spell_checker, good_words[i].data(), good_words[i].size());
     }
 
-    for (const auto& file_comment : d.d_comments) {
+    // Visit the files in name order.
+    CommentIndex&                      index = a.comment_index();
+    std::multimap<std::string, FileID> file_comments;
+    for (FileID fid : index.files()) {
+        file_comments.insert(
+            std::make_pair(m.getFilename(m.getLocForStartOfFile(fid)), fid));
+    }
+    for (const auto& file_comment : file_comments) {
         if (a.is_component(file_comment.first)) {
-            for (const auto& comment : file_comment.second) {
+            for (const auto& comment : index.blocks(file_comment.second)) {
                 check_spelling(comment);
             }
         }
@@ -368,10 +358,18 @@ void report::check_spelling(SourceRange comment)
 internal::DynTypedMatcher parameter_matcher()
     // Return an AST matcher which looks for named parameters.
 {
-    return decl(forEachDescendant(parmVarDecl(matchesName(".")).bind("parm")));
+    return parmVarDecl(matchesName(".")).bind("parm");
 }
 
 void report::match_parameter(const BoundNodes &nodes)
+{
+    const ParmVarDecl *parm = nodes.getNodeAs<ParmVarDecl>("parm");
+    if (a.is_component(parm)) {
+        d.d_parms.push_back(parm);
+    }
+}
+
+void report::check_parameter(const ParmVarDecl *parm)
 {
     static std::set<llvm::StringRef> ok{
         "argc", // main argument
@@ -392,40 +390,36 @@ void report::match_parameter(const BoundNodes &nodes)
         "tmp",  // temporary
     };
 
-    const ParmVarDecl *parm = nodes.getNodeAs<ParmVarDecl>("parm");
-    if (a.is_component(parm)) {
-        llvm::StringRef name = parm->getName();
-        static llvm::Regex words("[[:digit:]_]*([[:alpha:]][[:lower:]]*)");
-        llvm::SmallVector<llvm::StringRef, 7> matches;
-        size_t pos = 0;
-        while (words.match(name.substr(pos), &matches)) {
-            pos = name.find(matches[1], pos);
-            std::string word = matches[1].lower();
-            if (!ok.count(word) &&
-                !aspell_speller_check(
-                    spell_checker, word.data(), word.size())) {
-                llvm::SmallVector<llvm::StringRef, 100> var_abbrs;
-                llvm::StringRef(a.config()->value("variable_abbreviations",
-                                                  parm->getLocation()))
-                    .split(var_abbrs, " ", -1, false);
-                std::set<llvm::StringRef> vars{
-                    var_abbrs.begin(), var_abbrs.end()};
-                if (!vars.count(word)) {
-                    d.d_bad_parms[word].insert(Location(
-                        m, parm->getLocation().getLocWithOffset(pos)));
-                }
+    llvm::StringRef name = parm->getName();
+    static llvm::Regex words("[[:digit:]_]*([[:alpha:]][[:lower:]]*)");
+    llvm::SmallVector<llvm::StringRef, 7> matches;
+    size_t pos = 0;
+    while (words.match(name.substr(pos), &matches)) {
+        pos = name.find(matches[1], pos);
+        std::string word = matches[1].lower();
+        if (!ok.count(word) &&
+            !aspell_speller_check(
+                spell_checker, word.data(), word.size())) {
+            llvm::SmallVector<llvm::StringRef, 100> var_abbrs;
+            llvm::StringRef(a.config()->value("variable_abbreviations",
+                                              parm->getLocation()))
+                .split(var_abbrs, " ", -1, false);
+            std::set<llvm::StringRef> vars{
+                var_abbrs.begin(), var_abbrs.end()};
+            if (!vars.count(word)) {
+                d.d_bad_parms[word].insert(Location(
+                    m, parm->getLocation().getLocWithOffset(pos)));
             }
-            pos += word.size();
         }
+        pos += word.size();
     }
 }
 
 void report::check_parameters()
 {
-    MatchFinder mf;
-    OnMatch<report, &report::match_parameter> m1(this);
-    mf.addDynamicMatcher(parameter_matcher(), &m1);
-    mf.match(*a.context()->getTranslationUnitDecl(), *a.context());
+    for (const ParmVarDecl *parm : d.d_parms) {
+        check_parameter(parm);
+    }
     size_t limit =
         std::strtoul(a.config()->value("spelled_ok_count").c_str(), 0, 10);
     for (const auto& p : d.d_bad_parms) {
@@ -442,8 +436,13 @@ void report::check_parameters()
 void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
     // Hook up the callback functions.
 {
+    analyser.add_matcher(check_name,
+                         parameter_matcher(),
+                         [&analyser](const BoundNodes &nodes) {
+                             report(analyser).match_parameter(nodes);
+                         });
+    analyser.comment_index();
     analyser.onTranslationUnitDone += report(analyser);
-    observer.onComment             += report(analyser);
 }
 
 }  // close anonymous namespace
@@ -55,8 +55,8 @@ struct report : Report<data>
                     SrcMgr::CharacteristicKind    type,
                     FileID                        prev);
 
-    // TranslationUnitDone callback
-    void operator()();
+    // Matched 'std::swap' call callback
+    void match_swap(const BoundNodes &nodes);
 };
 
 void report::operator()(SourceLocation                now,
@@ -71,30 +71,30 @@ void report::operator()(SourceLocation                now,
     }
 }
 
-void report::operator()()
+void report::match_swap(const BoundNodes &nodes)
 {
-    MatchFinder mf;
-    OnMatch<> m1([&](const BoundNodes &nodes) {
-        a.report(nodes.getNodeAs<CallExpr>("c"), check_name, "SU01",
-                 "Prefer 'using %0::swap; swap(...);'")
-            << (d.d_bsl ? "bsl" : "std");
-    });
-    mf.addDynamicMatcher(
-        decl(forEachDescendant(callExpr(
-            callee(namedDecl(hasName("std::swap"))),
-            callee(stmt(expr(ignoringImpCasts(declRefExpr(
-                qualifier(specifiesNamespace(anything()))
-            ))))),
-            unless(hasAnyArgument(hasType(qualType(builtinType()))))
-        ).bind("c"))), &m1);
-    mf.match(*a.context()->getTranslationUnitDecl(), *a.context());
+    a.report(nodes.getNodeAs<CallExpr>("c"), check_name, "SU01",
+             "Prefer 'using %0::swap; swap(...);'")
+        << (d.d_bsl ? "bsl" : "std");
 }
 
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
     // Hook up the callback functions.
 {
-    observer.onPPFileChanged       += report(analyser);
-    analyser.onTranslationUnitDone += report(analyser);
+    observer.onPPFileChanged += report(analyser);
+    analyser.add_matcher(
+        check_name,
+        callExpr(
+            callee(namedDecl(hasName("std::swap"))),
+            callee(stmt(expr(ignoringImpCasts(declRefExpr(
+                qualifier(specifiesNamespace(anything()))
+            ))))),
+            unless(hasAnyArgument(hasType(qualType(builtinType()))))
+        ).bind("c"),
+        [&analyser](const BoundNodes &nodes) {
+            report(analyser).match_swap(nodes);
+        },
+        Analyser::e_Instantiations);
 }
 
 }  // close anonymous namespace
@@ -3,9 +3,9 @@
 #include <llvm/ADT/StringExtras.h>
 #include <clang/AST/Decl.h>
 #include <csabase_analyser.h>
+#include <csabase_commentindex.h>
 #include <csabase_debug.h>
 #include <csabase_registercheck.h>
-#include <csabase_report.h>
 #include <csabase_util.h>
 #include <cctype>
 #include <string>
@@ -100,22 +100,25 @@ void Word::set(llvm::StringRef s, size_t position)
     is_punct         = s.size() == 1 && !std::isalpha(s[0] & 0xFF);
 }
 
-struct data
+struct report
+    // Callback object for inspecting comments.
 {
-    std::vector<SourceRange> comments;
-};
+    Analyser& d_analyser;                   // Analyser object.
 
-struct report : Report<data>
-{
-    INHERIT_REPORT_CTOR(report, Report, data);
+    report(Analyser& analyser);
+        // Create a 'report' object, accessing the specified 'analyser'.
 
     void operator()();
-    void operator()(SourceRange range);
 
     void that_which(SourceRange range);
     void split(std::vector<Word> *words, llvm::StringRef comment);
 };
 
+report::report(Analyser& analyser)
+: d_analyser(analyser)
+{
+}
+
 void report::split(std::vector<Word> *words, llvm::StringRef comment)
 {
     words->clear();
@@ -189,7 +192,7 @@ void report::split(std::vector<Word> *words, llvm::StringRef comment)
 
 void report::that_which(SourceRange range)
 {
-    llvm::StringRef c = a.get_source(range);
+    llvm::StringRef c = d_analyser.get_source(range);
     std::vector<Word> w;
     split(&w, c);
 
@@ -206,9 +209,9 @@ void report::that_which(SourceRange range)
             !w[i - 1].is_that &&
             !w[i - 1].is_preposition &&
             !w[i + 1].is_of) {
-            a.report(range.getBegin().getLocWithOffset(w[i].offset),
-                     check_name, "TW01",
-                     "Possibly prefer 'that' over 'which'");
+            d_analyser.report(range.getBegin().getLocWithOffset(w[i].offset),
+                              check_name, "TW01",
+                              "Possibly prefer 'that' over 'which'");
         }
 #if 0  // We haven't found a good ", that" rule yet.
         size_t np = 0;
@@ -229,38 +232,30 @@ void report::that_which(SourceRange range)
                 }
             }
             if (prev_comma == i || np || nd & 1) {
-                a.report(range.getBegin().getLocWithOffset(w[i].offset),
-                         check_name, "TW02",
-                         "Possibly incorrect comma before 'that'");
+                d_analyser.report(
+                    range.getBegin().getLocWithOffset(w[i].offset),
+                    check_name, "TW02",
+                    "Possibly incorrect comma before 'that'");
             }
         }
 #endif
     }
 }
 
-void report::operator()(SourceRange range)
-{
-    if (a.is_component(range.getBegin())) {
-        if (d.comments.size() && areConsecutive(m, d.comments.back(), range)) {
-            d.comments.back().setEnd(range.getEnd());
-        } else {
-            d.comments.push_back(range);
-        }
-    }
-}
-
 void report::operator()()
 {
-    for (const auto& r : d.comments) {
-        that_which(r);
+    for (const auto& r : d_analyser.comment_index().blocks()) {
+        if (d_analyser.is_component(r.getBegin())) {
+            that_which(r);
+        }
     }
 }
 
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
     // Hook up the callback functions.
 {
+    analyser.comment_index();
     analyser.onTranslationUnitDone += report(analyser);
-    observer.onComment             += report(analyser);
 }
 
 }  // close anonymous namespace
@@ -56,9 +56,6 @@ struct report
     report(Analyser& analyser);
         // Initialize an object of this type.
 
-    void operator()();
-        // Callback for the end of the translation unit.
-
     void match_unnamed_temporary(const BoundNodes &nodes);
         // Callback when unnamed temporaries are found.
 };
@@ -72,12 +69,11 @@ internal::DynTypedMatcher unnamed_temporary_matcher()
     // Return an AST matcher which looks for expression statements which
     // construct temporary objects.
 {
-    return decl(forEachDescendant(
-        cleanups(
-            hasParent(stmt(unless(expr()))),
-            anyOf(has(cxxFunctionalCastExpr()),
-                  has(cxxBindTemporaryExpr(has(cxxTemporaryObjectExpr())))))
-            .bind("ut")));
+    return cleanups(
+        hasParent(stmt(unless(expr()))),
+        anyOf(has(cxxFunctionalCastExpr()),
+              has(cxxBindTemporaryExpr(has(cxxTemporaryObjectExpr())))))
+        .bind("ut");
 }
 
 void report::match_unnamed_temporary(const BoundNodes &nodes)
@@ -103,19 +99,15 @@ void report::match_unnamed_temporary(const BoundNodes &nodes)
                       "Unnamed object will be immediately destroyed");
 }
 
-void report::operator()()
-{
-    MatchFinder mf;
-    OnMatch<report, &report::match_unnamed_temporary> m1(this);
-    mf.addDynamicMatcher(unnamed_temporary_matcher(), &m1);
-    mf.match(*d_analyser.context()->getTranslationUnitDecl(),
-             *d_analyser.context());
-}
-
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
     // Hook up the callback functions.
 {
-    analyser.onTranslationUnitDone += report(analyser);
+    analyser.add_matcher(check_name,
+                         unnamed_temporary_matcher(),
+                         [&analyser](const BoundNodes &nodes) {
+                             report(analyser).match_unnamed_temporary(nodes);
+                         },
+                         Analyser::e_Instantiations);
 }
 
 }  // close anonymous namespace
@@ -55,9 +55,6 @@ struct report
         // Complain about the specified template 'parms' that use 'typename'
         // instead of 'class'.
 
-    void operator()();
-        // Callback invoked at end of translation unit.
-
     Analyser& d_analyser;
 };
 
@@ -66,15 +63,6 @@ report::report(Analyser& analyser)
 {
 }
 
-internal::DynTypedMatcher has_template_parameters_matcher()
-    // Return an AST matcher which looks for things that might have template
-    // parameters.  We could be more restrictive than just accepting any 'decl'
-    // but that would just push the same work we do in the callback elsewhere.
-{
-    return decl(eachOf(forEachDescendant(decl().bind("decl")),
-                       forEachDescendant(lambdaExpr().bind("lambda"))));
-}
-
 void report::match_has_template_parameters(const BoundNodes& nodes)
 {
     if (TemplateDecl const* decl = nodes.getNodeAs<TemplateDecl>("decl")) {
@@ -124,15 +112,6 @@ void report::match_has_template_parameters(const BoundNodes& nodes)
     }
 }
 
-void report::operator()()
-{
-    MatchFinder mf;
-    OnMatch<report, &report::match_has_template_parameters> m1(this);
-    mf.addDynamicMatcher(has_template_parameters_matcher(), &m1);
-    mf.match(*d_analyser.context()->getTranslationUnitDecl(),
-             *d_analyser.context());
-}
-
 static llvm::Regex all_upper("^[[:upper:]](_?[[:upper:][:digit:]]+)*\r*$");
 
 void report::checkTemplateParameters(TemplateParameterList const* parms)
@@ -171,8 +150,15 @@ void report::checkTemplateParameters(TemplateParameterList const* parms)
 }
 
 void subscribe(Analyser& analyser, Visitor&, PPObserver&)
+    // Look for things that might have template parameters.  We could be more
+    // restrictive than just accepting any 'decl' but that would just push the
+    // same work we do in the callback elsewhere.
 {
-    analyser.onTranslationUnitDone += report(analyser);
+    auto callback = [&analyser](const BoundNodes& nodes) {
+        report(analyser).match_has_template_parameters(nodes);
+    };
+    analyser.add_matcher(check_name, decl().bind("decl"), callback);
+    analyser.add_matcher(check_name, lambdaExpr().bind("lambda"), callback);
 }
 
 }
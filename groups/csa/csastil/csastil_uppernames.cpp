@@ -55,9 +55,6 @@ struct report :  Report<data>
     void match_has_name(const BoundNodes& nodes);
         // Find named declarations.
 
-    void operator()();
-        // Callback invoked at end of translation unit.
-
     void operator()(SourceLocation,
                     SourceRange,
                     PPCallbacks::ConditionValueKind,
@@ -71,14 +68,11 @@ struct report :  Report<data>
         // Callback for #else/#endif.
 };
 
-internal::DynTypedMatcher has_name_matcher()
-    // Return an AST matcher which looks for named declarations.
-{
-    return decl(forEachDescendant(namedDecl().bind("decl")));
-}
-
 void report::match_has_name(const BoundNodes& nodes)
 {
+    if (d_analyser.is_test_driver()) {
+        return;                                                       // RETURN
+    }
     NamedDecl const* decl = nodes.getNodeAs<NamedDecl>("decl");
     if (!d_data.d_decls.insert(decl).second) {
         return;                                                       // RETURN
@@ -134,17 +128,6 @@ void report::match_has_name(const BoundNodes& nodes)
     }
 }
 
-void report::operator()()
-{
-    if (!d_analyser.is_test_driver()) {
-        MatchFinder mf;
-        OnMatch<report, &report::match_has_name> m1(this);
-        mf.addDynamicMatcher(has_name_matcher(), &m1);
-        mf.match(*d_analyser.context()->getTranslationUnitDecl(),
-                 *d_analyser.context());
-    }
-}
-
 // Ifndef
 void report::operator()(SourceLocation         loc,
                         const Token&           macro,
@@ -179,7 +162,11 @@ void report::operator()(SourceLocation                  loc,
 
 void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
 {
-    analyser.onTranslationUnitDone += report(analyser);
+    analyser.add_matcher(check_name,
+                         namedDecl().bind("decl"),
+                         [&analyser](const BoundNodes& nodes) {
+                             report(analyser).match_has_name(nodes);
+                         });
 
     observer.onPPIfndef += report(analyser, observer.e_Ifndef);
     observer.onPPElif   += report(analyser, observer.e_Elif);
@@ -104,7 +104,9 @@ static void component_prefix(Analyser& analyser, Decl const *decl)
 
 // ----------------------------------------------------------------------------
 
-static RegisterCheck check(check_name, &component_prefix);
+static RegisterCheck check(check_name,
+                           &component_prefix,
+                           CheckRegistry::e_Diagnosable);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
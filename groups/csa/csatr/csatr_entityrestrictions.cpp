@@ -109,10 +109,18 @@ static void typedef_declaration(Analyser& analyser, TypedefDecl const* decl)
 
 // -----------------------------------------------------------------------------
 
-static RegisterCheck c0(check_name, &enum_declaration);
-static RegisterCheck c1(check_name, &var_declaration);
-static RegisterCheck c2(check_name, &function_declaration);
-static RegisterCheck c3(check_name, &typedef_declaration);
+static RegisterCheck c0(check_name,
+                        &enum_declaration,
+                        CheckRegistry::e_Diagnosable);
+static RegisterCheck c1(check_name,
+                        &var_declaration,
+                        CheckRegistry::e_Diagnosable);
+static RegisterCheck c2(check_name,
+                        &function_declaration,
+                        CheckRegistry::e_Diagnosable);
+static RegisterCheck c3(check_name,
+                        &typedef_declaration,
+                        CheckRegistry::e_Diagnosable);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
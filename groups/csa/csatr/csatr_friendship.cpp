@@ -51,7 +51,7 @@ struct report : Report<data>
     const Decl *other(const Decl *frend, const Decl *decl);
     bool is_good_friend(const FriendDecl *frend, const NamedDecl *def);
     void local_friendship_only(FriendDecl const* decl);
-    void operator()();
+    void match_friend(const BoundNodes &nodes);
 };
 
 std::string report::context(const Decl *decl)
@@ -209,35 +209,37 @@ void report::local_friendship_only(FriendDecl const* frend)
     }
 }
 
-void report::operator()()
+void report::match_friend(const BoundNodes &nodes)
 {
-    MatchFinder mf;
-    OnMatch<> m1([&](const BoundNodes &nodes) {
-        local_friendship_only(nodes.getNodeAs<FriendDecl>("friend"));
-    });
-    mf.addDynamicMatcher(
-        decl(forEachDescendant(cxxRecordDecl(
-            unless(classTemplateSpecializationDecl(anything())),
-            forEach(friendDecl(anything()).bind("friend"))
-        ))), &m1);
-    mf.addDynamicMatcher(
-        decl(forEachDescendant(cxxRecordDecl(
-            isExplicitTemplateSpecialization(),
-            forEach(friendDecl(anything()).bind("friend"))
-        ))), &m1);
-    mf.addDynamicMatcher(
-        decl(forEachDescendant(classTemplateDecl(
-            forEach(friendDecl(anything()).bind("friend"))
-        ))), &m1);
-    mf.match(*a.context()->getTranslationUnitDecl(), *a.context());
+    local_friendship_only(nodes.getNodeAs<FriendDecl>("friend"));
 }
 
 void subscribe(Analyser& analyser, Visitor& visitor, PPObserver& observer)
     // Hook up the callback functions.
 {
-    analyser.onTranslationUnitDone += report(analyser);
-}
-
+    auto callback = [&analyser](const BoundNodes &nodes) {
+        report(analyser).match_friend(nodes);
+    };
+    analyser.add_matcher(
+        check_name,
+        cxxRecordDecl(
+            unless(classTemplateSpecializationDecl(anything())),
+            forEach(friendDecl(anything()).bind("friend"))
+        ),
+        callback);
+    analyser.add_matcher(
+        check_name,
+        cxxRecordDecl(
+            isExplicitTemplateSpecialization(),
+            forEach(friendDecl(anything()).bind("friend"))
+        ),
+        callback);
+    analyser.add_matcher(
+        check_name,
+        classTemplateDecl(
+            forEach(friendDecl(anything()).bind("friend"))
+        ),
+        callback);
 }
 
 // ----------------------------------------------------------------------------
@@ -67,7 +67,9 @@ global_function_only_in_source(Analyser& analyser, FunctionDecl const* decl)
 
 // ----------------------------------------------------------------------------
 
-static RegisterCheck check(check_name, &global_function_only_in_source);
+static RegisterCheck check(check_name,
+                           &global_function_only_in_source,
+                           CheckRegistry::e_Diagnosable);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
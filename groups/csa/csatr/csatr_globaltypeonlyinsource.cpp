@@ -80,7 +80,9 @@ global_type_only_in_source(Analyser& analyser, TypeDecl const* decl)
 
 // ----------------------------------------------------------------------------
 
-static RegisterCheck check(check_name, &global_type_only_in_source);
+static RegisterCheck check(check_name,
+                           &global_type_only_in_source,
+                           CheckRegistry::e_Diagnosable);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
@@ -146,7 +146,9 @@ void subscribe(Analyser& analyser, Visitor&, PPObserver& observer)
 
 // ----------------------------------------------------------------------------
 
-static RegisterCheck register_observer(check_name, &subscribe);
+static RegisterCheck register_observer(check_name,
+                                       &subscribe,
+                                       CheckRegistry::e_Preprocessor);
 
 // ----------------------------------------------------------------------------
 // Copyright (C) 2014 Bloomberg Finance L.P.
@@ -12,7 +12,6 @@
 #include <llvm/ADT/StringExtras.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Support/Path.h>
-#include <llvm/Support/Regex.h>
 
 #include <clang/AST/RecursiveASTVisitor.h>
 #include <clang/Frontend/CompilerInstance.h>
@@ -78,6 +77,11 @@ struct data
                        llvm::StringRef /* new  */,
                        hash            /* hash */> d_replacements;
         // Mapping of names to their replacements.
+
+    std::unordered_set<const IdentifierInfo *> d_replaced_names;
+        // The last components of the names in 'd_replacements', so that
+        // references to other names can be passed over without spelling out
+        // their qualified names.
 };
 
 // Callback object invoked upon completion.
@@ -101,6 +105,22 @@ struct report : public RecursiveASTVisitor<report>, Report<data>
         // Return whether the specified 'macro' looks like an include guard
         // (starts with "INCLUDE_" or "INCLUDED_").
 
+    bool is_guarded_include(llvm::StringRef src,
+                            llvm::StringRef guard,
+                            llvm::StringRef file);
+        // Return whether the specified 'src', which starts with the 'ifndef'
+        // of the specified 'guard', consists of that line, a line including
+        // the specified 'file', optionally a line defining 'guard', and the
+        // '#endif'.
+
+    void add_replacement(llvm::StringRef from, llvm::StringRef to);
+        // Arrange for the name specified by 'from' to be replaced by the
+        // specified 'to'.
+
+    bool may_be_replaced(const NamedDecl *decl);
+        // Return whether the qualified name of the specified 'decl' may be
+        // one that is replaced.
+
     void operator()();
         // Callback for end of compilation unit.
 
@@ -185,6 +205,74 @@ bool report::is_guard(llvm::StringRef macro)
            macro.startswith("INCLUDE_");
 }
 
+bool report::is_guarded_include(llvm::StringRef src,
+                                llvm::StringRef guard,
+                                llvm::StringRef file)
+{
+    // Remove the specified 'prefix' from the front of 'line', and return
+    // whether it was there.
+    auto skip = [](llvm::StringRef& line, llvm::StringRef prefix) {
+        if (!line.startswith(prefix)) {
+            return false;                                             // RETURN
+        }
+        line = line.drop_front(prefix.size());
+        return true;
+    };
+    auto lines = src.split('\n');
+    llvm::StringRef line = lines.first;
+    if (!skip(line, "ifndef") || !skip(line = line.ltrim(" "), guard)) {
+        return false;                                                 // RETURN
+    }
+
+    lines = lines.second.split('\n');
+    line = lines.first.ltrim(" ");
+    if (!skip(line, "#") || !skip(line = line.ltrim(" "), "include")) {
+        return false;                                                 // RETURN
+    }
+    line = line.ltrim(" ");
+    if (!skip(line, "<") && !skip(line, "\"")) {
+        return false;                                                 // RETURN
+    }
+    if (!skip(line, file) || (!skip(line, ">") && !skip(line, "\""))) {
+        return false;                                                 // RETURN
+    }
+
+    lines = lines.second.split('\n');
+    line = lines.first.ltrim(" ");
+    if (skip(line, "#") && skip(line = line.ltrim(" "), "define")) {
+        if (!skip(line = line.ltrim(" "), guard)) {
+            return false;                                             // RETURN
+        }
+        lines = lines.second.split('\n');
+        line = lines.first.ltrim(" ");
+    }
+    else {
+        line = lines.first.ltrim(" ");
+    }
+    return line.startswith("#endif");
+}
+
+void report::add_replacement(llvm::StringRef from, llvm::StringRef to)
+{
+    d.d_replacements[from] = to;
+    llvm::StringRef last = from;
+    size_t colons = last.rfind("::");
+    if (colons != last.npos) {
+        last = last.drop_front(colons + 2);
+    }
+    if (!last.empty()) {
+        d.d_replaced_names.insert(p.getIdentifierInfo(last));
+    }
+}
+
+bool report::may_be_replaced(const NamedDecl *decl)
+{
+    // Names that are not identifiers, such as those of operators, are always
+    // spelled out.
+    return !decl->getDeclName().isIdentifier() ||
+           d.d_replaced_names.count(decl->getIdentifier());
+}
+
 void report::operator()()
 {
     auto tu = a.context()->getTranslationUnitDecl();
@@ -246,16 +334,21 @@ void report::operator()(SourceLocation loc,
         reason == PPCallbacks::EnterFile &&
         kind == SrcMgr::C_User &&
         prev.isInvalid()) {
-        // First time through.  Configure refactor data.
+        // First time through.  Configure refactor data.  Each option is
+        // "file(...)" or "name(...)", with no parentheses inside.
         llvm::StringRef cfg = a.config()->value("refactor");
-        SmallVector<llvm::StringRef, 5> rs;
-        llvm::Regex rre("^(file|name)[(][^()]+(,[^()]+)*[)]");
-        while (rre.match(cfg, &rs)) {
-            llvm::StringRef r = rs[0].trim();
+        for (;;) {
+            size_t close = cfg.find_first_of("()", 5);
+            if ((!cfg.startswith("file(") && !cfg.startswith("name(")) ||
+                close == cfg.npos ||
+                close == 5 ||
+                cfg[close] != ')') {
+                break;
+            }
+            llvm::StringRef r = cfg.substr(0, close + 1);
             llvm::StringRef o = r;
-            cfg = cfg.drop_front(rs[0].size()).trim();
+            cfg = cfg.drop_front(close + 1).trim();
             bool bad = true;
-            r = r.trim();
             if (r.startswith("file")) {
                 r = r.drop_front(5).drop_back(1).trim();
                 SmallVector<llvm::StringRef, 5> fs;
@@ -271,7 +364,7 @@ void report::operator()(SourceLocation loc,
                 r.split(ns, ",", -1, false);
                 if (ns.size() == 2) {
                     bad = false;
-                    d.d_replacements[ns[0].trim()] = ns[1].trim();
+                    add_replacement(ns[0].trim(), ns[1].trim());
                 }
             }
             if (bad) {
@@ -325,12 +418,7 @@ void report::operator()(SourceLocation loc, SourceLocation ifloc)
         llvm::StringRef src = a.get_source(SourceRange(ifloc, loc));
         std::string guard = d.d_ifs[ifloc];
         std::string file = file_for_guard(guard);
-        std::string match = "^ifndef *" + guard + ".*$\r*\n"
-                            "^ *# *include *[<\"]" + file + "[\">].*$\r*\n"
-                            "(^ *# *define *" + guard + ".*$\r*\n)?"
-                            "^ *#endif";
-        llvm::Regex re(match, llvm::Regex::Newline);
-        if (re.match(src)) {
+        if (is_guarded_include(src, guard, file)) {
             d.d_includes[file].emplace_back(SourceRange(ifloc, loc));
         }
     }
@@ -341,15 +429,18 @@ void report::operator()(Token const& token,
                         SourceRange,
                         MacroArgs const *)
 {
-    std::string name = p.getSpelling(token);
-    replace(SourceRange(token.getLocation(), token.getLastLoc()), name);
+    if (d.d_replaced_names.count(token.getIdentifierInfo())) {
+        std::string name = p.getSpelling(token);
+        replace(SourceRange(token.getLocation(), token.getLastLoc()), name);
+    }
 }
 
 bool report::TraverseDeclRefExpr(DeclRefExpr *arg)
 {
     Guard guard(this, __FUNCTION__, arg);
 
-    if (replace(arg->getSourceRange(),
+    if (may_be_replaced(arg->getDecl()) &&
+        replace(arg->getSourceRange(),
                 arg->getDecl()->getQualifiedNameAsString())) {
         // Skip calling TraverseNestedNameSpecifierLoc(arg->getQualifierLoc());
         // Skip calling TraverseDeclarationNameInfo(arg->getNameInfo());
@@ -64,6 +64,14 @@ my $ovr = -1;
 my $m32;
 my $m64;
 my $diff = "";
+my $batch;
+my $jobs;
+my $stamp;
+my $tc;
+my $apply;
+my $ring;
+my $bodies;
+my $pponly;
 
 my $command = join " \\\n ", $0, map { join '" "', split(/ /, $_, -1) } @ARGV;
 
@@ -71,6 +79,7 @@ sub usage()
 {
     print "
 usage: $0 [options] [additional compiler options] file.cpp ...
+       $0 [options] [additional compiler options] --batch=list [file.cpp ...]
     -I{directory}
     -D{macro}
     -w                       # disable normal compiler warnings
@@ -86,10 +95,18 @@ usage: $0 [options] [additional compiler options] file.cpp ...
     --[no]ovr                # whether to define BSL_OVERRIDES_STD
     --rewrite-dir=dir
     --rewrite-file=file
+    --apply-rewrites         # apply the rewrite file to the rewrite dir
+    --batch=file             # list of files, or compile_commands.json
+    --jobs=n, -j n           # number of batch threads (0 = one per CPU)
+    --stamp=file             # skip unchanged batch files recorded in file
+    --text-cache=dir         # reuse text-only check results cached in dir
     --diagnose={main,component,nogen,all}
+    --parse-all-bodies       # parse function bodies in undiagnosed files
+    --pp-only                # only preprocess; run only lexical checks
     --std=type
     --tag=string
     --debug
+    --debug-ring=n           # keep the last n debug messages, shown at the end
     --verbose
     --help
 
@@ -109,6 +126,7 @@ GetOptions(
     'config=s'                     => \$config,
     'cl=s'                         => \@cl,
     'debug'                        => \$debug,
+    'debug-ring=i'                 => \$ring,
     'help|?'                       => \$help,
     'cc=s'                         => \$dummy,
     'diff=s'                       => \$diff,
@@ -120,6 +138,13 @@ GetOptions(
     'nsa!'                         => \$dummy,
     'rewrite|rewrite-dir|rd=s'     => \$rwd,
     'rewrite-file|rf=s'            => \$rwf,
+    'apply-rewrites'               => \$apply,
+    'batch=s'                      => \$batch,
+    'jobs|j=i'                     => \$jobs,
+    'stamp=s'                      => \$stamp,
+    'text-cache=s'                 => \$tc,
+    'parse-all-bodies'             => \$bodies,
+    'pp-only'                      => \$pponly,
     'w'                            => \$warnoff,
     "I=s"                          => \@incs,
     "D=s"                          => \@defs,
@@ -138,19 +163,31 @@ GetOptions(
     "m64"                          => \$m64,
     "pipe|pthread|MMD|g|c|S"       => \$dummy,
     "O|MF|o|march|mtune=s"         => \@dummy,
-) and !$help and $#ARGV >= 0 or usage();
+) and !$help and ($#ARGV >= 0 or $batch or $apply) or usage();
 
 sub xclang(@) { return map { ( "-Xclang", $_ ) } @_; }
 sub plugin(@) { return xclang( "-plugin-arg-bde_verify", @_ ); }
 
 my @config = plugin("config=$config")      if $config ne "";
 my @debug  = plugin("debug-on")            if $debug;
+push @debug, plugin("debug-ring=$ring")    if $ring;
 my @tlo    = plugin("diagnose=$diagnose");
 my @rwd    = plugin("rewrite-dir=$rwd")    if $rwd;
 print "No such directory $rwd\n" if $rwd and ! -d $rwd;
 my @rwf    = plugin("rewrite-file=$rwf")   if $rwf;
+if ($apply) {
+    die "--apply-rewrites needs --rewrite-file and --rewrite-dir\n"
+        unless $rwf and $rwd;
+    exec $exe, "--apply-rewrites=$rwf", $rwd;
+}
 my @tag    = plugin("tool=$tag")           if $tag;
 my @diff   = plugin("diff=$diff")          if $diff;
+my @tc     = plugin("text-cache=$tc")      if $tc;
+my @bodies = plugin("parse-all-bodies")   if $bodies;
+my @pponly = plugin("pp-only")            if $pponly;
+my @batch  = ("--batch=$batch")           if $batch;
+push(@batch, "--jobs=$jobs")              if defined $jobs;
+push(@batch, "--stamp=$stamp")            if $stamp;
 my %uf     = (
              );
 @lflags = map { "-f$_" } grep { not exists $uf{$_} } @lflags;
@@ -188,7 +225,17 @@ if ($ovr == 0) {
     push(@defs, "-UBSL_OVERRIDES_STD");
 }
 
-for (@ARGV) {
+my @files = @ARGV;
+if ($batch and $batch !~ m{\.json$}) {
+    if (open my $fh, "<", $batch) {
+        push(@files, grep { /\S/ and !/^\s*#/ }
+                     map { s/^\s+|\s+$//gr } <$fh>);
+        close $fh;
+    } elsif ($batch ne "-") {
+        warn "Cannot find batch list $batch\n";
+    }
+}
+for (@files) {
     if (! -f) {
         warn "Cannot find file $_\n";
     } elsif (m{^(.*)[/\\].*$}) {
@@ -295,11 +342,15 @@ my @command = (
     @rwf,
     @tag,
     @diff,
+    @tc,
+    @bodies,
+    @pponly,
     @cl,
     @defs,
     @incs,
     @lflags,
     @wflags,
+    @batch,
     @ARGV,
 );
 